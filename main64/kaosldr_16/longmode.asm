@@ -176,7 +176,7 @@ SwitchToLongMode:
     WRMSR
  
     MOV     EBX, CR0                            ; Activate long mode -
-    OR      EBX, 0x80000001                     ; - by enabling paging and protection simultaneously.
+    OR      EBX, 0x80010001                     ; - by enabling paging and protection simultaneously (and write protection for read-only pages).
     MOV     CR0, EBX                    
  
     LGDT    [GDT.Pointer]                       ; Load GDT.Pointer defined below.
@@ -41,6 +41,44 @@ void outl(unsigned short Port, unsigned int Value)
     asm volatile ("outl %1, %0" : : "dN" (Port), "a" (Value));
 }
 
+// Reads the given Model Specific Register
+unsigned long rdmsr(unsigned int Msr)
+{
+    unsigned int low;
+    unsigned int high;
+    asm volatile ("rdmsr" : "=a" (low), "=d" (high) : "c" (Msr));
+
+    return ((unsigned long)high << 32) | low;
+}
+
+// Writes the given value to the specified Model Specific Register
+void wrmsr(unsigned int Msr, unsigned long Value)
+{
+    asm volatile ("wrmsr" : : "c" (Msr), "a" ((unsigned int)Value), "d" ((unsigned int)(Value >> 32)));
+}
+
+// Reads the Time Stamp Counter
+unsigned long rdtsc()
+{
+    unsigned int low;
+    unsigned int high;
+    asm volatile ("rdtsc" : "=a" (low), "=d" (high));
+
+    return ((unsigned long)high << 32) | low;
+}
+
+// Executes the CPUID instruction for the given leaf
+void cpuid(unsigned int Leaf, unsigned int *EAX, unsigned int *EBX, unsigned int *ECX, unsigned int *EDX)
+{
+    asm volatile ("cpuid" : "=a" (*EAX), "=b" (*EBX), "=c" (*ECX), "=d" (*EDX) : "a" (Leaf), "c" (0));
+}
+
+// Executes the CPUID instruction for the given leaf and sub-leaf
+void cpuidex(unsigned int Leaf, unsigned int SubLeaf, unsigned int *EAX, unsigned int *EBX, unsigned int *ECX, unsigned int *EDX)
+{
+    asm volatile ("cpuid" : "=a" (*EAX), "=b" (*EBX), "=c" (*ECX), "=d" (*EDX) : "a" (Leaf), "c" (SubLeaf));
+}
+
 // A simple memset implementation
 void *memset(void *s, int c, long n)
 {
@@ -51,6 +51,21 @@ void outw(unsigned short Port, unsigned short Value);
 // Writes a single int (32 bytes) to the specified port
 void outl(unsigned short Port, unsigned int Value);
 
+// Reads the given Model Specific Register
+unsigned long rdmsr(unsigned int Msr);
+
+// Writes the given value to the specified Model Specific Register
+void wrmsr(unsigned int Msr, unsigned long Value);
+
+// Reads the Time Stamp Counter
+unsigned long rdtsc();
+
+// Executes the CPUID instruction for the given leaf
+void cpuid(unsigned int Leaf, unsigned int *EAX, unsigned int *EBX, unsigned int *ECX, unsigned int *EDX);
+
+// Executes the CPUID instruction for the given leaf and sub-leaf
+void cpuidex(unsigned int Leaf, unsigned int SubLeaf, unsigned int *EAX, unsigned int *EBX, unsigned int *ECX, unsigned int *EDX);
+
 // A simple memset implementation
 void *memset(void *s, int c, long n);
 
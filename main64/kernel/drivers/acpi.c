@@ -0,0 +1,151 @@
+#include "acpi.h"
+#include "../common.h"
+#include "../memory/virtual-memory.h"
+
+// Returns the Local APIC IDs of all usable processors from the MADT.
+// The return value is the number of IDs, or 0 if the MADT wasn't found.
+int AcpiGetLocalApicIds(unsigned int *ApicIds, int MaxEntries)
+{
+    AcpiRsdp *rsdp = FindRsdp();
+    AcpiMadt *madt;
+    unsigned long entry;
+    unsigned long end;
+    int count = 0;
+
+    if (rsdp == 0x0)
+        return 0;
+
+    madt = (AcpiMadt *)FindAcpiTable(rsdp, ACPI_MADT_SIGNATURE);
+
+    if (madt == 0x0)
+        return 0;
+
+    // Iterate over the variable length entries of the MADT
+    entry = (unsigned long)madt + sizeof(AcpiMadt);
+    end = (unsigned long)madt + madt->Header.Length;
+
+    while ((entry < end) && (count < MaxEntries))
+    {
+        AcpiMadtEntry *header = (AcpiMadtEntry *)entry;
+
+        if (header->Length == 0)
+            break;
+
+        if (header->Type == ACPI_MADT_LOCAL_APIC)
+        {
+            AcpiMadtLocalApic *localApic = (AcpiMadtLocalApic *)entry;
+
+            // Disabled processors (that are not online capable) can't be started
+            if (localApic->Flags & (ACPI_MADT_PROCESSOR_ENABLED | ACPI_MADT_ONLINE_CAPABLE))
+                ApicIds[count++] = localApic->ApicId;
+        }
+
+        entry += header->Length;
+    }
+
+    return count;
+}
+
+// Finds the Root System Description Pointer in the BIOS areas
+static AcpiRsdp *FindRsdp()
+{
+    // The RSDP is stored in the first 1 KB of the Extended BIOS Data Area (EBDA), or in the BIOS area below 1 MB
+    unsigned long ebda = (unsigned long)(*(unsigned short *)(ACPI_LOW_MEMORY_VIRTUAL + ACPI_EBDA_POINTER)) << 4;
+    AcpiRsdp *rsdp = 0x0;
+
+    if (ebda != 0)
+        rsdp = ScanForRsdp(ebda, ebda + 1024);
+
+    if (rsdp == 0x0)
+        rsdp = ScanForRsdp(ACPI_BIOS_AREA_START, ACPI_BIOS_AREA_END);
+
+    return rsdp;
+}
+
+// Searches the Root System Description Pointer in the given physical memory range.
+// The RSDP is always aligned at a 16 byte boundary.
+static AcpiRsdp *ScanForRsdp(unsigned long Start, unsigned long End)
+{
+    unsigned long address;
+    int i;
+
+    for (address = Start; address < End; address += 16)
+    {
+        AcpiRsdp *rsdp = (AcpiRsdp *)(ACPI_LOW_MEMORY_VIRTUAL + address);
+
+        for (i = 0; i < 8; i++)
+        {
+            if (rsdp->Signature[i] != ACPI_RSDP_SIGNATURE[i])
+                break;
+        }
+
+        if ((i == 8) && AcpiChecksumValid(rsdp, sizeof(AcpiRsdp)))
+            return rsdp;
+    }
+
+    return 0x0;
+}
+
+// Finds the ACPI table with the given signature through the RSDT
+static AcpiTableHeader *FindAcpiTable(AcpiRsdp *Rsdp, char *Signature)
+{
+    AcpiTableHeader *rsdt = MapAcpiTable(Rsdp->RsdtAddress);
+    int entries;
+    int i, j;
+
+    if (!AcpiChecksumValid(rsdt, rsdt->Length))
+        return 0x0;
+
+    // The RSDT contains the 32 bit physical addresses of all other ACPI tables
+    entries = (rsdt->Length - sizeof(AcpiTableHeader)) / 4;
+
+    for (i = 0; i < entries; i++)
+    {
+        unsigned int physicalAddress = ((unsigned int *)((unsigned long)rsdt + sizeof(AcpiTableHeader)))[i];
+        AcpiTableHeader *table = MapAcpiTable(physicalAddress);
+
+        for (j = 0; j < 4; j++)
+        {
+            if (table->Signature[j] != Signature[j])
+                break;
+        }
+
+        if ((j == 4) && AcpiChecksumValid(table, table->Length))
+            return table;
+    }
+
+    return 0x0;
+}
+
+// Maps the ACPI table at the given physical address into the Higher Half, and returns its virtual address.
+// The ACPI tables are located below 4 GB, therefore every table has a fixed virtual address in the ACPI window.
+static AcpiTableHeader *MapAcpiTable(unsigned long PhysicalAddress)
+{
+    AcpiTableHeader *table = (AcpiTableHeader *)(ACPI_TABLES_VIRTUAL + PhysicalAddress);
+    unsigned long page = PhysicalAddress & ~(SMALL_PAGE_SIZE - 1);
+    unsigned long end;
+
+    // Map the page with the table header, so that we know the length of the table
+    MapVirtualAddressToPhysicalAddress(ACPI_TABLES_VIRTUAL + page, page);
+
+    // Map the remaining pages of the table
+    end = PhysicalAddress + table->Length;
+
+    for (page += SMALL_PAGE_SIZE; page < end; page += SMALL_PAGE_SIZE)
+        MapVirtualAddressToPhysicalAddress(ACPI_TABLES_VIRTUAL + page, page);
+
+    return table;
+}
+
+// Returns 1 if the bytes of the given structure sum up to 0
+static int AcpiChecksumValid(void *Structure, unsigned long Length)
+{
+    unsigned char *bytes = (unsigned char *)Structure;
+    unsigned char sum = 0;
+    unsigned long i;
+
+    for (i = 0; i < Length; i++)
+        sum += bytes[i];
+
+    return sum == 0;
+}
@@ -0,0 +1,92 @@
+#ifndef ACPI_H
+#define ACPI_H
+
+// The BIOS areas in which the Root System Description Pointer (RSDP) is searched
+#define ACPI_EBDA_POINTER               0x40E
+#define ACPI_BIOS_AREA_START            0xE0000
+#define ACPI_BIOS_AREA_END              0x100000
+
+// The first 2 MB of physical memory are mapped into the Higher Half at this virtual address
+#define ACPI_LOW_MEMORY_VIRTUAL         0xFFFF800000000000
+
+// The ACPI tables are mapped into this 4 GB window of the Higher Half (virtual address = window + physical address)
+#define ACPI_TABLES_VIRTUAL             0xFFFF800100000000
+
+// The various ACPI signatures
+#define ACPI_RSDP_SIGNATURE             "RSD PTR "
+#define ACPI_MADT_SIGNATURE             "APIC"
+
+// The MADT entry type of a Processor Local APIC, and its flags
+#define ACPI_MADT_LOCAL_APIC            0
+#define ACPI_MADT_PROCESSOR_ENABLED     0x1
+#define ACPI_MADT_ONLINE_CAPABLE        0x2
+
+// Represents the Root System Description Pointer
+typedef struct AcpiRsdp
+{
+    char Signature[8];
+    unsigned char Checksum;
+    char OemId[6];
+    unsigned char Revision;
+    unsigned int RsdtAddress;
+} __attribute__ ((packed)) AcpiRsdp;
+
+// Represents the header of each ACPI table
+typedef struct AcpiTableHeader
+{
+    char Signature[4];
+    unsigned int Length;
+    unsigned char Revision;
+    unsigned char Checksum;
+    char OemId[6];
+    char OemTableId[8];
+    unsigned int OemRevision;
+    unsigned int CreatorId;
+    unsigned int CreatorRevision;
+} __attribute__ ((packed)) AcpiTableHeader;
+
+// Represents the Multiple APIC Description Table (MADT).
+// The variable length entries are following directly after this structure.
+typedef struct AcpiMadt
+{
+    AcpiTableHeader Header;
+    unsigned int LocalApicAddress;
+    unsigned int Flags;
+} __attribute__ ((packed)) AcpiMadt;
+
+// Represents the header of a MADT entry
+typedef struct AcpiMadtEntry
+{
+    unsigned char Type;
+    unsigned char Length;
+} __attribute__ ((packed)) AcpiMadtEntry;
+
+// Represents the MADT entry of a Processor Local APIC
+typedef struct AcpiMadtLocalApic
+{
+    AcpiMadtEntry Header;
+    unsigned char ProcessorId;
+    unsigned char ApicId;
+    unsigned int Flags;
+} __attribute__ ((packed)) AcpiMadtLocalApic;
+
+// Returns the Local APIC IDs of all usable processors from the MADT.
+// The return value is the number of IDs, or 0 if the MADT wasn't found.
+int AcpiGetLocalApicIds(unsigned int *ApicIds, int MaxEntries);
+
+// Finds the Root System Description Pointer in the BIOS areas
+static AcpiRsdp *FindRsdp();
+
+// Searches the Root System Description Pointer in the given physical memory range
+static AcpiRsdp *ScanForRsdp(unsigned long Start, unsigned long End);
+
+// Finds the ACPI table with the given signature through the RSDT
+static AcpiTableHeader *FindAcpiTable(AcpiRsdp *Rsdp, char *Signature);
+
+// Maps the ACPI table at the given physical address into the Higher Half, and returns its virtual address
+static AcpiTableHeader *MapAcpiTable(unsigned long PhysicalAddress);
+
+// Returns 1 if the bytes of the given structure sum up to 0
+static int AcpiChecksumValid(void *Structure, unsigned long Length);
+
+#endif
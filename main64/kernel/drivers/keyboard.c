@@ -1,5 +1,6 @@
 #include "../common.h"
 #include "../isr/irq.h"
+#include "../multitasking/workqueue.h"
 #include "screen.h"
 #include "keyboard.h"
 
@@ -147,95 +148,105 @@ static void DiscardLastKey()
     lastReceivedScanCode = INVALID_SCANCODE;
 }
 
-// Keyboard callback function
+// Keyboard callback function.
+// It only reads the scan code from the keyboard controller, the processing is deferred to the Work Queue.
 static void KeyboardCallback(int Number)
 {
     // Check if the keyboard controller output buffer is full
     if (ReadStatus() & KYBRD_CTRL_STATS_MASK_OUT_BUF)
     {
         // Read the scan code
-        int code = ReadBuffer();
+        unsigned long code = ReadBuffer();
+
+        // Process the scan code in a Worker Task
+        QueueWork(ProcessScanCode, (void *)code);
+    }
+}
+
+// Processes a scan code that was received from the keyboard (executed by a Worker Task)
+static void ProcessScanCode(void *Context)
+{
+    int code = (int)(unsigned long)Context;
+
+    // Check if the current scan code is a break code
+    if (code & 0x80)
+    {
+        // A break code is received from the keyboard when the key is released.
+        // In a break code the 8th bit is set, therefore we test above against 0x80 (10000000b)
+        
+        // Convert the break code into the make code by clearing the 8th bit
+        code -= 0x80;
         
-        // Check if the current scan code is a break code
-        if (code & 0x80)
+        // Get the key from the scan code table
+        int key = ScanCodes_LowerCase_QWERTZ[code];
+        
+        switch (key)
         {
-            // A break code is received from the keyboard when the key is released.
-            // In a break code the 8th bit is set, therefore we test above against 0x80 (10000000b)
-            
-            // Convert the break code into the make code by clearing the 8th bit
-            code -= 0x80;
-            
-            // Get the key from the scan code table
-            int key = ScanCodes_LowerCase_QWERTZ[code];
-            
-            switch (key)
+            case KEY_LCTRL:
+            {
+                leftCtrl = 0;
+                lastReceivedScanCode = 0;
+                break;
+            }
+            case KEY_LSHIFT:
+            {
+                // The left shift key is released
+                shiftKey = 0;
+                lastReceivedScanCode = 0;
+                break;
+            }
+            case KEY_RSHIFT:
             {
-                case KEY_LCTRL:
-                {
-                    leftCtrl = 0;
-                    lastReceivedScanCode = 0;
-                    break;
-                }
-                case KEY_LSHIFT:
-                {
-                    // The left shift key is released
-                    shiftKey = 0;
-                    lastReceivedScanCode = 0;
-                    break;
-                }
-                case KEY_RSHIFT:
-                {
-                    // The right shift key is released
-                    lastReceivedScanCode = 0;
-                    shiftKey = 0;
-                    break;
-                }
+                // The right shift key is released
+                lastReceivedScanCode = 0;
+                shiftKey = 0;
+                break;
             }
         }
-        else
+    }
+    else
+    {
+        // Get the key from the scan code table
+        int key = ScanCodes_LowerCase_QWERTZ[code];
+        
+        switch (key)
         {
-            // Get the key from the scan code table
-            int key = ScanCodes_LowerCase_QWERTZ[code];
-            
-            switch (key)
+            case KEY_LCTRL:
+            {
+                leftCtrl = 1;
+                lastReceivedScanCode = 0;
+                break;
+            }
+            case KEY_CAPSLOCK:
+            {
+                // The caps lock key is pressed
+                // We just toggle the flag
+                if (capsLock == 1)
+                    capsLock = 0;
+                else
+                    capsLock = 1;
+                
+                break;
+            }
+            case KEY_LSHIFT:
+            {
+                // The left shift key is pressed
+                shiftKey = 1;
+                lastReceivedScanCode = 0;
+                break;
+            }
+            case KEY_RSHIFT:
+            {
+                // The right shift key is pressed
+                lastReceivedScanCode = 0;
+                shiftKey = 1;
+                break;
+            }
+            default:
             {
-                case KEY_LCTRL:
-                {
-                    leftCtrl = 1;
-                    lastReceivedScanCode = 0;
-                    break;
-                }
-                case KEY_CAPSLOCK:
-                {
-                    // The caps lock key is pressed
-                    // We just toggle the flag
-                    if (capsLock == 1)
-                        capsLock = 0;
-                    else
-                        capsLock = 1;
-                    
-                    break;
-                }
-                case KEY_LSHIFT:
-                {
-                    // The left shift key is pressed
-                    shiftKey = 1;
-                    lastReceivedScanCode = 0;
-                    break;
-                }
-                case KEY_RSHIFT:
-                {
-                    // The right shift key is pressed
-                    lastReceivedScanCode = 0;
-                    shiftKey = 1;
-                    break;
-                }
-                default:
-                {
-                    // We only buffer the Scan Code from the keyboard, if it is a printable character
-                    lastReceivedScanCode = code;
-                    break;
-                }
+                // We only buffer the Scan Code from the keyboard, if it is a printable character
+                lastReceivedScanCode = code;
+                break;
             }
         }
     }
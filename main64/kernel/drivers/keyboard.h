@@ -415,6 +415,9 @@ static void DiscardLastKey();
 // Keyboard callback function
 static void KeyboardCallback(int Number);
 
+// Processes a scan code that was received from the keyboard (executed by a Worker Task)
+static void ProcessScanCode(void *Context);
+
 // Reads the keyboard status
 static unsigned char ReadStatus();
 
@@ -1,23 +1,166 @@
 #include "../common.h"
-#include "../isr/irq.h"
-#include "../date.h"
-#include "../kernel.h"
+#include "../isr/apic.h"
+#include "../isr/pic.h"
 #include "timer.h"
-#include "screen.h"
-
-// Initializes the hardware timer
-void InitTimer(int Hertz)
-{
-    int divisor = 1193180 / Hertz;
-    
-    // Send the command byte
-    outb(0x43, 0x36);
-    
-    // Divisor has to be sent byte-wise, so split here into upper/lower bytes
-    unsigned char l = (unsigned char)(divisor & 0xFF);
-    unsigned char h = (unsigned char)((divisor >> 8));
-    
-    // Send the frequency divisor
-    outb(0x40, l);
-    outb(0x40, h);
-}
\ No newline at end of file
+
+// The frequency of the Time Stamp Counter in Hertz
+unsigned long tscFrequency = 0;
+
+// The frequency of the Local APIC Timer (after the divider) in Hertz
+unsigned long apicTimerFrequency = 0;
+
+// The Time Stamp Counter value when the timer was initialized
+unsigned long tscBoot = 0;
+
+// This flag stores if the Local APIC Timer runs in the TSC-Deadline mode
+int tscDeadlineMode = 0;
+
+// Initializes the hardware timer.
+// The TSC and the Local APIC Timer are calibrated against the PIT, and afterwards the Local APIC Timer is
+// used in the One-Shot mode (or the TSC-Deadline mode, if supported). Timer interrupts are only raised when
+// they are explicitly programmed through "ProgramTimerInterrupt()" - there is no periodic timer tick anymore.
+void InitTimer()
+{
+    unsigned int eax, ebx, ecx, edx;
+
+    // The PIT doesn't raise any interrupts anymore, it is only used for the calibration
+    MaskIrq(I86_PIC_IRQ_TIMER);
+
+    // Let the Local APIC Timer count down from its maximum value
+    ApicWrite(APIC_REGISTER_TIMER_DIVIDE, APIC_TIMER_DIVIDE_BY_16);
+    ApicWrite(APIC_REGISTER_LVT_TIMER, APIC_LVT_MASKED | APIC_TIMER_VECTOR);
+    ApicWrite(APIC_REGISTER_TIMER_INITIAL, 0xFFFFFFFF);
+    unsigned long tscStart = rdtsc();
+
+    // Wait for the calibration period
+    WaitForPit(PIT_FREQUENCY / 1000 * TIMER_CALIBRATION_MILLISECONDS);
+
+    // Measure how far the TSC and the Local APIC Timer have moved forward
+    unsigned long tscEnd = rdtsc();
+    unsigned int apicTicks = 0xFFFFFFFF - ApicRead(APIC_REGISTER_TIMER_CURRENT);
+    ApicWrite(APIC_REGISTER_TIMER_INITIAL, 0);
+
+    tscFrequency = (tscEnd - tscStart) * (1000 / TIMER_CALIBRATION_MILLISECONDS);
+    apicTimerFrequency = (unsigned long)apicTicks * (1000 / TIMER_CALIBRATION_MILLISECONDS);
+    tscBoot = tscEnd;
+
+    // Check if the Local APIC Timer supports the TSC-Deadline mode
+    cpuid(1, &eax, &ebx, &ecx, &edx);
+    tscDeadlineMode = (ecx & CPUID_FEATURE_TSC_DEADLINE) != 0;
+
+    InitTimerMode();
+}
+
+// Puts the Local APIC Timer of the current processor into the One-Shot mode (or the TSC-Deadline mode).
+// The Application Processors reuse the calibration of the Bootstrap Processor.
+void InitTimerMode()
+{
+    ApicWrite(APIC_REGISTER_TIMER_DIVIDE, APIC_TIMER_DIVIDE_BY_16);
+
+    if (tscDeadlineMode)
+    {
+        ApicWrite(APIC_REGISTER_LVT_TIMER, APIC_LVT_TIMER_TSC_DEADLINE | APIC_TIMER_VECTOR);
+
+        // The write to the LVT must be serialized before the first write to the IA32_TSC_DEADLINE MSR
+        asm volatile("mfence" ::: "memory");
+    }
+    else
+    {
+        ApicWrite(APIC_REGISTER_LVT_TIMER, APIC_LVT_TIMER_ONESHOT | APIC_TIMER_VECTOR);
+    }
+}
+
+// Programs the Local APIC Timer to raise a single interrupt after the given number of nanoseconds
+void ProgramTimerInterrupt(unsigned long Nanoseconds)
+{
+    if (tscDeadlineMode)
+    {
+        // The interrupt is raised as soon as the TSC reaches the deadline
+        wrmsr(IA32_TSC_DEADLINE_MSR, rdtsc() + NanosecondsToTsc(Nanoseconds));
+    }
+    else
+    {
+        // Calculate the number of Local APIC Timer ticks
+        unsigned long ticks = (Nanoseconds / NANOSECONDS_PER_SECOND) * apicTimerFrequency +
+            (Nanoseconds % NANOSECONDS_PER_SECOND) * apicTimerFrequency / NANOSECONDS_PER_SECOND;
+
+        // An initial count of 0 would stop the timer, and the counter register is only 32 bits wide.
+        // When the timer fires too early, the next interrupt is just programmed again.
+        if (ticks == 0)
+            ticks = 1;
+        else if (ticks > 0xFFFFFFFF)
+            ticks = 0xFFFFFFFF;
+
+        ApicWrite(APIC_REGISTER_TIMER_INITIAL, (unsigned int)ticks);
+    }
+}
+
+// Stops the Local APIC Timer, so that no further timer interrupt is raised
+void StopTimerInterrupt()
+{
+    if (tscDeadlineMode)
+        wrmsr(IA32_TSC_DEADLINE_MSR, 0);
+    else
+        ApicWrite(APIC_REGISTER_TIMER_INITIAL, 0);
+}
+
+// Returns the number of nanoseconds since the timer was initialized
+unsigned long GetMonotonicTime()
+{
+    return TscToNanoseconds(rdtsc() - tscBoot);
+}
+
+// Busy waits the given number of nanoseconds by polling the Time Stamp Counter
+void BusyWait(unsigned long Nanoseconds)
+{
+    unsigned long end = rdtsc() + NanosecondsToTsc(Nanoseconds);
+
+    while (rdtsc() < end)
+        asm volatile("pause");
+}
+
+// Returns the frequency of the Time Stamp Counter in Hertz
+unsigned long GetTscFrequency()
+{
+    return tscFrequency;
+}
+
+// Returns the Time Stamp Counter value when the timer was initialized (the start of the Monotonic Clock)
+unsigned long GetTscBoot()
+{
+    return tscBoot;
+}
+
+// Converts a number of TSC ticks to nanoseconds
+unsigned long TscToNanoseconds(unsigned long Ticks)
+{
+    // The calculation is split into whole seconds and the remainder, so that the multiplication doesn't overflow
+    return (Ticks / tscFrequency) * NANOSECONDS_PER_SECOND + (Ticks % tscFrequency) * NANOSECONDS_PER_SECOND / tscFrequency;
+}
+
+// Converts a number of nanoseconds to TSC ticks
+unsigned long NanosecondsToTsc(unsigned long Nanoseconds)
+{
+    // The calculation is split into whole seconds and the remainder, so that the multiplication doesn't overflow
+    return (Nanoseconds / NANOSECONDS_PER_SECOND) * tscFrequency + (Nanoseconds % NANOSECONDS_PER_SECOND) * tscFrequency / NANOSECONDS_PER_SECOND;
+}
+
+// Busy waits the given number of PIT ticks by using the PIT channel 2
+static void WaitForPit(unsigned short Ticks)
+{
+    // Enable the gate of the PIT channel 2, and disconnect the speaker
+    outb(0x61, (inb(0x61) & 0xFD) | 0x01);
+
+    // Channel 2, Access Mode lobyte/hibyte, Mode 0 (Interrupt on Terminal Count)
+    outb(0x43, 0xB0);
+    outb(0x42, (unsigned char)(Ticks & 0xFF));
+    outb(0x42, (unsigned char)(Ticks >> 8));
+
+    // Restart the countdown by toggling the gate
+    unsigned char value = inb(0x61) & 0xFE;
+    outb(0x61, value);
+    outb(0x61, value | 0x01);
+
+    // Wait until the output of the PIT channel 2 goes high
+    while (!(inb(0x61) & 0x20)) {}
+}
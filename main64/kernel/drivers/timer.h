@@ -1,7 +1,49 @@
 #ifndef TIMER_H
 #define TIMER_H
 
+// The frequency of the Programmable Interval Timer (PIT)
+#define PIT_FREQUENCY                   1193182
+
+// The duration of the calibration of the TSC and the Local APIC Timer against the PIT
+#define TIMER_CALIBRATION_MILLISECONDS  10
+
+#define NANOSECONDS_PER_SECOND          1000000000
+#define NANOSECONDS_PER_MILLISECOND     1000000
+
+// CPUID.01H:ECX - the Local APIC Timer supports the TSC-Deadline mode
+#define CPUID_FEATURE_TSC_DEADLINE      (1 << 24)
+
 // Initializes the hardware timer
-void InitTimer(int Hertz);
+void InitTimer();
+
+// Puts the Local APIC Timer of the current processor into the One-Shot mode (or the TSC-Deadline mode)
+void InitTimerMode();
+
+// Programs the Local APIC Timer to raise a single interrupt after the given number of nanoseconds
+void ProgramTimerInterrupt(unsigned long Nanoseconds);
+
+// Stops the Local APIC Timer, so that no further timer interrupt is raised
+void StopTimerInterrupt();
+
+// Returns the number of nanoseconds since the timer was initialized
+unsigned long GetMonotonicTime();
+
+// Busy waits the given number of nanoseconds by polling the Time Stamp Counter
+void BusyWait(unsigned long Nanoseconds);
+
+// Returns the frequency of the Time Stamp Counter in Hertz
+unsigned long GetTscFrequency();
+
+// Returns the Time Stamp Counter value when the timer was initialized (the start of the Monotonic Clock)
+unsigned long GetTscBoot();
+
+// Converts a number of TSC ticks to nanoseconds
+unsigned long TscToNanoseconds(unsigned long Ticks);
+
+// Converts a number of nanoseconds to TSC ticks
+unsigned long NanosecondsToTsc(unsigned long Nanoseconds);
+
+// Busy waits the given number of PIT ticks by using the PIT channel 2
+static void WaitForPit(unsigned short Ticks);
 
-#endif
\ No newline at end of file
+#endif
@@ -1,9 +1,15 @@
 #include "ata.h"
 #include "../common.h"
+#include "../multitasking/semaphore.h"
+
+// Serializes the PIO transfers, because the ATA controller can only execute one command at a time.
+// A PIO transfer takes a long time, therefore a waiting Task is blocked instead of spinning.
+Mutex ataMutex = MUTEX_INITIALIZER("Ata");
 
 // Reads a given number of disk sectors (512 bytes) from the starting LBA address into the target memory address.
 void ReadSectors(unsigned char *TargetAddress, unsigned int LBA, unsigned char SectorCount)
 {
+    AcquireMutex(&ataMutex);
     WaitForBSYFlag();
 
     outb(0x1F2, SectorCount);
@@ -31,11 +37,14 @@ void ReadSectors(unsigned char *TargetAddress, unsigned int LBA, unsigned char S
         
         TargetAddress += 512;
     }
+
+    ReleaseMutex(&ataMutex);
 }
 
 // Writes a given number of disk sectors (512 bytes) to the starting LBA address of the disk from the source memory address.
 void WriteSectors(unsigned int *SourceAddress, unsigned int LBA, unsigned char SectorCount)
 {
+    AcquireMutex(&ataMutex);
     WaitForBSYFlag();
 
     outb(0x1F2, SectorCount);
@@ -57,6 +66,8 @@ void WriteSectors(unsigned int *SourceAddress, unsigned int LBA, unsigned char S
 
         SourceAddress += 256;
     }
+
+    ReleaseMutex(&ataMutex);
 }
 
 // Waits until the BSY flag is cleared.
@@ -5,6 +5,9 @@
 #include "../memory/heap.h"
 #include "../drivers/screen.h"
 #include "../multitasking/multitasking.h"
+#include "../multitasking/smp.h"
+#include "../multitasking/spinlock.h"
+#include "../multitasking/semaphore.h"
 
 // The addresses where the Root Directory and the FAT tables are stored.
 // The memory regions will be allocated on the Heap.
@@ -16,6 +19,11 @@ unsigned char *EXECUTABLE_BASE_ADDRESS_PTR = (unsigned char *)0x0000700000000000
 
 // Stores the File Descriptors for all opened files
 List *FileDescriptorList = 0x0;
+Spinlock fileDescriptorListLock = SPINLOCK_INITIALIZER("FileDescriptors");
+
+// Protects the cached Root Directory and the FAT tables.
+// Tasks that are only reading files are accessing them in parallel.
+RwSemaphore rootDirectoryLock = RW_SEMAPHORE_INITIALIZER("RootDirectory");
 
 // Initializes the FAT12 system
 void InitFAT12()
@@ -37,6 +45,10 @@ unsigned long OpenFile(unsigned char *FileName, unsigned char *Extension, char *
     strcpy(fullFileName, FileName);
     strcat(fullFileName, Extension);
 
+    // The file is maybe created or truncated, when it isn't opened in the "read" mode
+    int exclusive = strcmp(FileMode, "r") != 0;
+    LockRootDirectory(exclusive);
+
     // Find the Root Directory Entry for the given program name
     RootDirectoryEntry *entry = FindRootDirectoryEntry(fullFileName);
 
@@ -49,6 +61,8 @@ unsigned long OpenFile(unsigned char *FileName, unsigned char *Extension, char *
     else if ((entry == 0x0) && (strcmp(FileMode, "r") == 0))
     {
         // If the requested file was not found in the "write" mode, we return a NULL value for the file handle
+        UnlockRootDirectory(exclusive);
+
         return 0;
     }
     else if ((entry == 0x0) && (strcmp(FileMode, "a") == 0))
@@ -60,10 +74,15 @@ unsigned long OpenFile(unsigned char *FileName, unsigned char *Extension, char *
     {
         // If the requested file exists in the "write" mode, its content must be truncated.
         // Therefore, we delete and recreate the file
-        DeleteFile(FileName, Extension);
+        RemoveFile(FileName, Extension);
         CreateFile(FileName, Extension);
     }
 
+    // The Root Directory Entry has changed, when the file was created
+    entry = FindRootDirectoryEntry(fullFileName);
+    unsigned long fileSize = entry != 0x0 ? entry->FileSize : 0;
+    UnlockRootDirectory(exclusive);
+
     // The PID of the current running task is concatenated to the file name
     // to make it unique across multiple running tasks.
     // Otherwise we would have a hash collision if the same file is opened across
@@ -79,10 +98,14 @@ unsigned long OpenFile(unsigned char *FileName, unsigned char *Extension, char *
     FileDescriptor *descriptor = (FileDescriptor *)malloc(sizeof(FileDescriptor));
     strcpy(descriptor->FileName, FileName);
     strcpy(descriptor->Extension, Extension);
-    descriptor->FileSize = entry->FileSize;
+    descriptor->FileSize = fileSize;
     descriptor->CurrentFileOffset = 0;
     strcpy((char *)&descriptor->FileMode, FileMode);
+    descriptor->ReferenceCount = 1;
+
+    unsigned long flags = AcquireSpinlockIrqSave(&fileDescriptorListLock);
     AddEntryToList(FileDescriptorList, descriptor, hashValue);
+    ReleaseSpinlockIrqRestore(&fileDescriptorListLock, flags);
 
     // If the requested file exists in the "append" mode, we set the FileOffset to the end of the file
     if (strcmp(FileMode, "a") == 0)
@@ -95,16 +118,33 @@ unsigned long OpenFile(unsigned char *FileName, unsigned char *Extension, char *
 // Reads the requested data from a file into the provided buffer
 unsigned long ReadFile(unsigned long FileHandle, unsigned char *Buffer, unsigned long Length)
 {
-    // Find the file from which we want to read
-    ListEntry *entry = GetEntryFromList(FileDescriptorList, FileHandle);
-    FileDescriptor *descriptor = (FileDescriptor *)entry->Payload;
+    IoVector vector = { Buffer, Length };
 
-    // Zero-Initialize the target buffer
-    memset(Buffer, 0x0, Length);
+    return ReadFileVector(FileHandle, &vector, 1);
+}
 
-    // The requested data can't be longer than a physical disk sector
-    if (Length > BYTES_PER_SECTOR)
-        return 0;
+// Reads the requested data from a file into several buffers, and returns the length of the read data.
+// The buffers are filled one after another, until the end of the file is reached. The Root Directory is locked
+// and the file is searched only once for all buffers.
+unsigned long ReadFileVector(unsigned long FileHandle, IoVector *Vectors, int Count)
+{
+    FileDescriptor *descriptor;
+    unsigned long totalLength = 0;
+    unsigned long length;
+    int i;
+
+    for (i = 0; i < Count; i++)
+    {
+        // The requested data can't be longer than a physical disk sector
+        if (Vectors[i].Length > BYTES_PER_SECTOR)
+            return 0;
+
+        // Zero-Initialize the target buffer
+        memset(Vectors[i].Buffer, 0x0, Vectors[i].Length);
+    }
+
+    // Find the file from which we want to read
+    descriptor = AcquireFileDescriptor(FileHandle);
 
     if (descriptor != 0x0)
     {
@@ -113,219 +153,305 @@ unsigned long ReadFile(unsigned long FileHandle, unsigned char *Buffer, unsigned
         strcpy(fullFileName, descriptor->FileName);
         strcat(fullFileName, descriptor->Extension);
 
+        // Other Tasks can read files in parallel
+        AcquireReadSemaphore(&rootDirectoryLock);
+
         // Find the Root Directory Entry for the given program name
         RootDirectoryEntry *entry = FindRootDirectoryEntry(fullFileName);
 
         if (entry != 0x0)
         {
-            // Allocate a file buffer
-            unsigned char *file_buffer = (unsigned char *)malloc(BYTES_PER_SECTOR);
-            
-            // Calculate from the current file position the cluster and the offset within that cluster
-            unsigned long cluster = descriptor->CurrentFileOffset / BYTES_PER_SECTOR;
-            unsigned long offsetWithinCluster = descriptor->CurrentFileOffset - (cluster * BYTES_PER_SECTOR);
-            unsigned short fatSector = entry->FirstCluster;
-    
-            // Loop until we reach the cluster that we want to read
-            for (int i = 0; i < cluster; i++)
+            for (i = 0; i < Count; i++)
             {
-                // Read the next Cluster from the FAT table
-                fatSector = FATRead(fatSector);
+                length = ReadFileData(descriptor, entry, Vectors[i].Buffer, Vectors[i].Length);
+                totalLength += length;
+
+                // The end of the file was reached
+                if (length < Vectors[i].Length)
+                    break;
             }
+        }
 
-            // Calculate the following disk sector
-            unsigned short fatSectorFollowing = FATRead(fatSector);
+        ReleaseReadSemaphore(&rootDirectoryLock);
+        ReleaseFileDescriptor(descriptor);
+    }
 
-            // Check for the EndOfFile condition
-            if (descriptor->CurrentFileOffset + Length > descriptor->FileSize)
-                Length = descriptor->FileSize - descriptor->CurrentFileOffset;
+    // Return the length of the read data
+    return totalLength;
+}
 
-            // Read the specific sector from disk
-            ReadSectors((unsigned char *)file_buffer, fatSector + DATA_AREA_BEGINNING, 1);
+// Reads the requested data (at most one disk sector) at the current file position into the provided buffer.
+// The caller must hold the Root Directory lock.
+static unsigned long ReadFileData(FileDescriptor *Descriptor, RootDirectoryEntry *Entry, unsigned char *Buffer, unsigned long Length)
+{
+    // Allocate a file buffer, which can hold the 2 disk sectors across which the requested data can be stored
+    unsigned char *file_buffer = (unsigned char *)malloc(2 * BYTES_PER_SECTOR);
+    
+    // Calculate from the current file position the cluster and the offset within that cluster
+    unsigned long cluster = Descriptor->CurrentFileOffset / BYTES_PER_SECTOR;
+    unsigned long offsetWithinCluster = Descriptor->CurrentFileOffset - (cluster * BYTES_PER_SECTOR);
+    unsigned short fatSector = Entry->FirstCluster;
 
-            // We also read the following sector, when the requested data is stored across 2 disk sectors
-            if (offsetWithinCluster + Length > BYTES_PER_SECTOR)
-                ReadSectors((unsigned char *)file_buffer + BYTES_PER_SECTOR, fatSectorFollowing + DATA_AREA_BEGINNING, 1);
+    // Loop until we reach the cluster that we want to read
+    for (int i = 0; i < cluster; i++)
+    {
+        // Read the next Cluster from the FAT table
+        fatSector = FATRead(fatSector);
+    }
 
-            // Copy the requested data into the destination buffer
-            memcpy(Buffer, file_buffer + offsetWithinCluster, Length);
-           
-            // Set the current file position within the FileDescriptor
-            descriptor->CurrentFileOffset += Length;
+    // Calculate the following disk sector
+    unsigned short fatSectorFollowing = FATRead(fatSector);
 
-            // Release the file buffer
-            free(file_buffer);
+    // Check for the EndOfFile condition
+    if (Descriptor->CurrentFileOffset + Length > Descriptor->FileSize)
+        Length = Descriptor->FileSize - Descriptor->CurrentFileOffset;
 
-            // Return the length of the read data
-            return Length;
-        }
-    }
+    // Read the specific sector from disk
+    ReadSectors((unsigned char *)file_buffer, fatSector + DATA_AREA_BEGINNING, 1);
+
+    // We also read the following sector, when the requested data is stored across 2 disk sectors
+    if (offsetWithinCluster + Length > BYTES_PER_SECTOR)
+        ReadSectors((unsigned char *)file_buffer + BYTES_PER_SECTOR, fatSectorFollowing + DATA_AREA_BEGINNING, 1);
+
+    // Copy the requested data into the destination buffer
+    memcpy(Buffer, file_buffer + offsetWithinCluster, Length);
+   
+    // Set the current file position within the FileDescriptor
+    Descriptor->CurrentFileOffset += Length;
+
+    // Release the file buffer
+    free(file_buffer);
+
+    // Return the length of the read data
+    return Length;
 }
 
 // Writes the requested data from the provided buffer into a file
 unsigned long WriteFile(unsigned long FileHandle, unsigned char *Buffer, unsigned long Length)
 {
-    // Find the file from which we want to read
-    ListEntry *entry = GetEntryFromList(FileDescriptorList, FileHandle);
-    FileDescriptor *descriptor = (FileDescriptor *)entry->Payload;
+    IoVector vector = { Buffer, Length };
+
+    return WriteFileVector(FileHandle, &vector, 1);
+}
+
+// Writes the requested data from several buffers into a file, and returns the length of the written data.
+// The Root Directory and the FAT tables are only written back once to the disk for all buffers.
+unsigned long WriteFileVector(unsigned long FileHandle, IoVector *Vectors, int Count)
+{
+    FileDescriptor *descriptor;
+    unsigned long totalLength = 0;
+    int i;
+
+    // The data of each buffer can't be longer than a physical disk sector
+    for (i = 0; i < Count; i++)
+    {
+        if (Vectors[i].Length > BYTES_PER_SECTOR)
+            return 0;
+    }
+
+    // Find the file into which we want to write
+    descriptor = AcquireFileDescriptor(FileHandle);
+
+    if (descriptor == 0x0)
+        return 0;
 
     // Check if the file was opened in the "write" or "append" mode
     if (strcmp(descriptor->FileMode, "r") == 0)
+    {
+        ReleaseFileDescriptor(descriptor);
         return 0;
+    }
 
-    // The data can't be longer than a physical disk sector
-    if (Length > BYTES_PER_SECTOR)
-        return 0;
+    // Construct the full file name
+    char fullFileName[11];
+    strcpy(fullFileName, descriptor->FileName);
+    strcat(fullFileName, descriptor->Extension);
 
-    if (descriptor != 0x0)
+    // The Root Directory and the FAT tables are changed exclusively
+    AcquireWriteSemaphore(&rootDirectoryLock);
+
+    // Find the Root Directory Entry for the given program name
+    RootDirectoryEntry *entry = FindRootDirectoryEntry(fullFileName);
+
+    if (entry != 0x0)
     {
-        // Construct the full file name
-        char fullFileName[11];
-        strcpy(fullFileName, descriptor->FileName);
-        strcat(fullFileName, descriptor->Extension);
+        for (i = 0; i < Count; i++)
+            totalLength += WriteFileData(descriptor, entry, Vectors[i].Buffer, Vectors[i].Length);
 
-        // Find the Root Directory Entry for the given program name
-        RootDirectoryEntry *entry = FindRootDirectoryEntry(fullFileName);
+        // Set the last Access and Write Date
+        SetLastAccessDate(entry);
 
-        if (entry != 0x0)
-        {
-            // Allocate a file buffer
-            unsigned char *file_buffer = (unsigned char *)malloc(BYTES_PER_SECTOR);
+        // Write the RootDirectory and the FAT tables back to disk
+        WriteRootDirectoryAndFAT();
+    }
 
-            // Calculate from the current file position the cluster and the offset within that cluster
-            unsigned long cluster = descriptor->CurrentFileOffset / BYTES_PER_SECTOR;
-            unsigned long offsetWithinCluster = descriptor->CurrentFileOffset - (cluster * BYTES_PER_SECTOR);
-            unsigned short currentFatSector = entry->FirstCluster;
+    ReleaseWriteSemaphore(&rootDirectoryLock);
+    ReleaseFileDescriptor(descriptor);
 
-            // Loop until we reach the cluster that we want to write to.
-            // If necessary, new clusters will be created and added for the file.
-            for (int i = 0; i < cluster; i++)
-            {
-                // Read the next Cluster from the FAT table
-                unsigned short nextFatSector = FATRead(currentFatSector);
-
-                // The next cluster is the last one in the chain
-                if (nextFatSector >= EOF)
-                {
-                    // Allocate a new cluster for the file
-                    unsigned short newFatSector = AllocateNewClusterToFile(currentFatSector);
-
-                    // Set the current sector
-                    currentFatSector = newFatSector;
-                }
-                else
-                {
-                    // Set the current sector
-                    currentFatSector = nextFatSector;
-                }
-            }
+    // Return the length of the written data
+    return totalLength;
+}
 
-            // When the data is stored across the last boundary of the current sector, we have allocate
-            // an additional cluster to the file
-            if ((offsetWithinCluster + Length >= BYTES_PER_SECTOR) && (descriptor->FileSize < descriptor->CurrentFileOffset + Length))
-            {
-                // Allocate a new cluster for the file
-                AllocateNewClusterToFile(currentFatSector);
-            }
+// Writes the requested data (at most one disk sector) from the provided buffer at the current file position.
+// The caller must hold the Root Directory lock exclusively, and writes the Root Directory and the FAT tables back to disk.
+static unsigned long WriteFileData(FileDescriptor *Descriptor, RootDirectoryEntry *Entry, unsigned char *Buffer, unsigned long Length)
+{
+    // Allocate a file buffer, which can hold the 2 disk sectors across which the data can be stored
+    unsigned char *file_buffer = (unsigned char *)malloc(2 * BYTES_PER_SECTOR);
 
-            // Calculate the following disk sector
-            unsigned short fatSectorFollowing = FATRead(currentFatSector);
+    // Calculate from the current file position the cluster and the offset within that cluster
+    unsigned long cluster = Descriptor->CurrentFileOffset / BYTES_PER_SECTOR;
+    unsigned long offsetWithinCluster = Descriptor->CurrentFileOffset - (cluster * BYTES_PER_SECTOR);
+    unsigned short currentFatSector = Entry->FirstCluster;
 
-            // Read the specific sector from disk
-            ReadSectors((unsigned char *)file_buffer, currentFatSector + DATA_AREA_BEGINNING, 1);
-            
-            // Read the following logical sector, when the data is stored across 2 disk sectors
-            if (offsetWithinCluster + Length >= BYTES_PER_SECTOR)
-            {
-                ReadSectors((unsigned char *)(file_buffer + BYTES_PER_SECTOR), fatSectorFollowing + DATA_AREA_BEGINNING, 1);
-            }
+    // Loop until we reach the cluster that we want to write to.
+    // If necessary, new clusters will be created and added for the file.
+    for (int i = 0; i < cluster; i++)
+    {
+        // Read the next Cluster from the FAT table
+        unsigned short nextFatSector = FATRead(currentFatSector);
 
-            // Copy the requested data into the destination disk sector
-            memcpy(file_buffer + offsetWithinCluster, Buffer, Length);
-            
-            // Write the specific sector to disk
-            WriteSectors((unsigned int *)file_buffer, currentFatSector + DATA_AREA_BEGINNING, 1);
-            
-            // Write the following logical sector, when the data is stored across 2 disk sectors
-            if (offsetWithinCluster + Length >= BYTES_PER_SECTOR)
-            {
-                WriteSectors((unsigned int *)(file_buffer + BYTES_PER_SECTOR), fatSectorFollowing + DATA_AREA_BEGINNING, 1);
-            }
+        // The next cluster is the last one in the chain
+        if (nextFatSector >= EOF)
+        {
+            // Allocate a new cluster for the file
+            unsigned short newFatSector = AllocateNewClusterToFile(currentFatSector);
 
-            // Release the file buffer
-            free(file_buffer);
+            // Set the current sector
+            currentFatSector = newFatSector;
+        }
+        else
+        {
+            // Set the current sector
+            currentFatSector = nextFatSector;
+        }
+    }
 
-            // Set the last Access and Write Date
-            SetLastAccessDate(entry);
+    // When the data is stored across the last boundary of the current sector, we have allocate
+    // an additional cluster to the file
+    if ((offsetWithinCluster + Length >= BYTES_PER_SECTOR) && (Descriptor->FileSize < Descriptor->CurrentFileOffset + Length))
+    {
+        // Allocate a new cluster for the file
+        AllocateNewClusterToFile(currentFatSector);
+    }
 
-            // Set the current file position within the FileDescriptor
-            descriptor->CurrentFileOffset += Length;
+    // Calculate the following disk sector
+    unsigned short fatSectorFollowing = FATRead(currentFatSector);
 
-            // Check if the file size has changed
-            if (descriptor->CurrentFileOffset > entry->FileSize)
-            {
-                // Change the data in the RootDirectory
-                entry->FileSize = descriptor->CurrentFileOffset;
-                descriptor->FileSize = descriptor->CurrentFileOffset;
-            }
+    // Read the specific sector from disk
+    ReadSectors((unsigned char *)file_buffer, currentFatSector + DATA_AREA_BEGINNING, 1);
+    
+    // Read the following logical sector, when the data is stored across 2 disk sectors
+    if (offsetWithinCluster + Length >= BYTES_PER_SECTOR)
+    {
+        ReadSectors((unsigned char *)(file_buffer + BYTES_PER_SECTOR), fatSectorFollowing + DATA_AREA_BEGINNING, 1);
+    }
+
+    // Copy the requested data into the destination disk sector
+    memcpy(file_buffer + offsetWithinCluster, Buffer, Length);
+    
+    // Write the specific sector to disk
+    WriteSectors((unsigned int *)file_buffer, currentFatSector + DATA_AREA_BEGINNING, 1);
+    
+    // Write the following logical sector, when the data is stored across 2 disk sectors
+    if (offsetWithinCluster + Length >= BYTES_PER_SECTOR)
+    {
+        WriteSectors((unsigned int *)(file_buffer + BYTES_PER_SECTOR), fatSectorFollowing + DATA_AREA_BEGINNING, 1);
+    }
 
-            // Write the RootDirectory and the FAT tables back to disk
-            WriteRootDirectoryAndFAT();
+    // Release the file buffer
+    free(file_buffer);
 
-            // Return the length of the written data
-            return Length;
-        }
+    // Set the current file position within the FileDescriptor
+    Descriptor->CurrentFileOffset += Length;
+
+    // Check if the file size has changed
+    if (Descriptor->CurrentFileOffset > Entry->FileSize)
+    {
+        // Change the data in the RootDirectory
+        Entry->FileSize = Descriptor->CurrentFileOffset;
+        Descriptor->FileSize = Descriptor->CurrentFileOffset;
     }
+
+    // Return the length of the written data
+    return Length;
 }
 
 // Seeks to the specific position in the file
 int SeekFile(unsigned long FileHandle, unsigned long NewFileOffset)
 {
     // Find the file from which we want to read
-    ListEntry *entry = GetEntryFromList(FileDescriptorList, FileHandle);
-    FileDescriptor *descriptor = (FileDescriptor *)entry->Payload;
+    FileDescriptor *descriptor = AcquireFileDescriptor(FileHandle);
 
     if (descriptor != 0x0)
     {
         descriptor->CurrentFileOffset = NewFileOffset;
+        ReleaseFileDescriptor(descriptor);
         return 0;
     }
     else
         return -1;
 }
 
-// Returns a flag if the file offset within the FileDescriptor has reached the end of file
+// Returns a flag if the file offset within the FileDescriptor has reached the end of file (-1 for an unknown file handle)
 int EndOfFile(unsigned long FileHandle)
 {
     // Find the file from which we want to check the EndOfFile condition
-    ListEntry *entry = GetEntryFromList(FileDescriptorList, FileHandle);
-    FileDescriptor *descriptor = (FileDescriptor *)entry->Payload;
+    FileDescriptor *descriptor = AcquireFileDescriptor(FileHandle);
+    int endOfFile;
 
-    if (descriptor->CurrentFileOffset == descriptor->FileSize)
-        return 1;
-    else
-        return 0;
+    if (descriptor == 0x0)
+        return -1;
+
+    endOfFile = descriptor->CurrentFileOffset == descriptor->FileSize;
+    ReleaseFileDescriptor(descriptor);
+
+    return endOfFile;
 }
 
 // Closes a file in the FAT12 file system
 int CloseFile(unsigned long FileHandle)
 {
+    unsigned long flags = AcquireSpinlockIrqSave(&fileDescriptorListLock);
+
     // Find the file which needs to be closed
     ListEntry *entry = GetEntryFromList(FileDescriptorList, FileHandle);
 
     if (entry != 0x0)
     {
-        // Close the file by removing it from the list
+        FileDescriptor *descriptor = (FileDescriptor *)entry->Payload;
+
+        // Close the file by removing it from the list.
+        // The FileDescriptor is released, when the file operations of other Tasks have finished with it.
         RemoveEntryFromList(FileDescriptorList, entry);
+        ReleaseSpinlockIrqRestore(&fileDescriptorListLock, flags);
+        ReleaseFileDescriptor(descriptor);
 
         return 0;
     }
     else
+    {
+        ReleaseSpinlockIrqRestore(&fileDescriptorListLock, flags);
+
         return -1;
+    }
 }
 
 // Deletes an existing file in the FAT12 file system
 int DeleteFile(unsigned char *FileName, unsigned char *Extension)
+{
+    int result;
+
+    AcquireWriteSemaphore(&rootDirectoryLock);
+    result = RemoveFile(FileName, Extension);
+    ReleaseWriteSemaphore(&rootDirectoryLock);
+
+    return result;
+}
+
+// Removes an existing file from the Root Directory and the FAT tables.
+// The caller must hold the Root Directory lock for writing.
+static int RemoveFile(unsigned char *FileName, unsigned char *Extension)
 {
     // Construct the full file name
     char fullFileName[11];
@@ -352,19 +478,37 @@ int DeleteFile(unsigned char *FileName, unsigned char *Extension)
         return -1;
 }
 
+// Returns 1 if the given file (8.3 name without the dot) exists in the Root Directory
+int FileExists(unsigned char *FileName)
+{
+    int exists;
+
+    AcquireReadSemaphore(&rootDirectoryLock);
+    exists = FindRootDirectoryEntry(FileName) != 0x0;
+    ReleaseReadSemaphore(&rootDirectoryLock);
+
+    return exists;
+}
+
 // Load the given program into memory
 int LoadProgram(unsigned char *Filename)
 {
+    AcquireReadSemaphore(&rootDirectoryLock);
+
     // Find the Root Directory Entry for the given program name
     RootDirectoryEntry *entry = FindRootDirectoryEntry(Filename);
 
     if (entry != 0)
     {
         LoadProgramIntoMemory(entry);
+        ReleaseReadSemaphore(&rootDirectoryLock);
+
         return 1;
     }
     else
     {
+        ReleaseReadSemaphore(&rootDirectoryLock);
+
         return 0;
     }
 }
@@ -375,10 +519,16 @@ void PrintRootDirectory()
     char str[32] = "";
     int fileCount = 0;
     int fileSize = 0;
+    unsigned long flags;
     int i;
 
     RootDirectoryEntry *entry = (RootDirectoryEntry *)ROOT_DIRECTORY_BUFFER;
 
+    AcquireReadSemaphore(&rootDirectoryLock);
+
+    // The console is shared by all processors, and its output is serialized through the Kernel Lock
+    flags = AcquireKernelLock();
+
     for (i = 0; i < ROOT_DIRECTORY_ENTRIES; i++)
     {
         if (entry->FileName[0] != 0x00)
@@ -433,9 +583,13 @@ void PrintRootDirectory()
     printf(str);
     printf(" bytes");
     printf("\n");
+
+    ReleaseKernelLock(flags);
+    ReleaseReadSemaphore(&rootDirectoryLock);
 }
 
-// Finds a given Root Directory Entry by its Filename
+// Finds a given Root Directory Entry by its Filename.
+// The caller must hold the Root Directory lock.
 RootDirectoryEntry* FindRootDirectoryEntry(unsigned char *FileName)
 {
     RootDirectoryEntry *entry = (RootDirectoryEntry *)ROOT_DIRECTORY_BUFFER;
@@ -457,6 +611,50 @@ RootDirectoryEntry* FindRootDirectoryEntry(unsigned char *FileName)
     return 0;
 }
 
+// Returns the FileDescriptor of the given file handle with an additional reference, or 0 if the file isn't opened.
+// The reference is taken under the lock of the list, so a concurrent "CloseFile" can't release the FileDescriptor.
+static FileDescriptor *AcquireFileDescriptor(unsigned long FileHandle)
+{
+    FileDescriptor *descriptor = 0x0;
+    unsigned long flags = AcquireSpinlockIrqSave(&fileDescriptorListLock);
+    ListEntry *entry = GetEntryFromList(FileDescriptorList, FileHandle);
+
+    if (entry != 0x0)
+    {
+        descriptor = (FileDescriptor *)entry->Payload;
+        __atomic_add_fetch(&descriptor->ReferenceCount, 1, __ATOMIC_RELAXED);
+    }
+
+    ReleaseSpinlockIrqRestore(&fileDescriptorListLock, flags);
+
+    return descriptor;
+}
+
+// Releases a reference of the given FileDescriptor, and frees it with the last reference
+static void ReleaseFileDescriptor(FileDescriptor *Descriptor)
+{
+    if (__atomic_sub_fetch(&Descriptor->ReferenceCount, 1, __ATOMIC_ACQ_REL) == 0)
+        free(Descriptor);
+}
+
+// Acquires the Root Directory lock for reading, or exclusively for writing
+static void LockRootDirectory(int Exclusive)
+{
+    if (Exclusive)
+        AcquireWriteSemaphore(&rootDirectoryLock);
+    else
+        AcquireReadSemaphore(&rootDirectoryLock);
+}
+
+// Releases the Root Directory lock that was acquired by "LockRootDirectory"
+static void UnlockRootDirectory(int Exclusive)
+{
+    if (Exclusive)
+        ReleaseWriteSemaphore(&rootDirectoryLock);
+    else
+        ReleaseReadSemaphore(&rootDirectoryLock);
+}
+
 // Prints out the FileDescriptorList entries
 void PrintFileDescriptorList()
 {
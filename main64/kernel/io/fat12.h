@@ -48,9 +48,21 @@ struct FileDescriptor
     unsigned long FileSize;
     unsigned long CurrentFileOffset;
     char FileMode[2];
+
+    // The list of the opened files and every running file operation are holding a reference,
+    // so that a concurrent "CloseFile" doesn't release the FileDescriptor while it's still used
+    volatile int ReferenceCount;
 };
 typedef struct FileDescriptor FileDescriptor;
 
+// Describes a buffer of a vectored read or write operation.
+// The same structure is defined in the file "libc.h".
+typedef struct IoVector
+{
+    unsigned char *Buffer;
+    unsigned long Length;
+} IoVector;
+
 // Initializes the FAT12 system
 void InitFAT12();
 
@@ -60,13 +72,19 @@ unsigned long OpenFile(unsigned char *FileName, unsigned char *Extension, char *
 // Reads the requested data from a file into the provided buffer
 unsigned long ReadFile(unsigned long FileHandle, unsigned char *Buffer, unsigned long Length);
 
+// Reads the requested data from a file into several buffers, and returns the length of the read data
+unsigned long ReadFileVector(unsigned long FileHandle, IoVector *Vectors, int Count);
+
 // Writes the requested data from the provided buffer into a file
 unsigned long WriteFile(unsigned long FileHandle, unsigned char *Buffer, unsigned long Length);
 
+// Writes the requested data from several buffers into a file, and returns the length of the written data
+unsigned long WriteFileVector(unsigned long FileHandle, IoVector *Vectors, int Count);
+
 // Seeks to the specific position in the file
 int SeekFile(unsigned long FileHandle, unsigned long NewFileOffset);
 
-// Returns a flag if the file offset within the FileDescriptor has reached the end of file
+// Returns a flag if the file offset within the FileDescriptor has reached the end of file (-1 for an unknown file handle)
 int EndOfFile(unsigned long FileHandle);
 
 // Closes a file in the FAT12 file system
@@ -75,13 +93,17 @@ int CloseFile(unsigned long FileHandle);
 // Deletes an existing file in the FAT12 file system
 int DeleteFile(unsigned char *FileName, unsigned char *Extension);
 
+// Returns 1 if the given file (8.3 name without the dot) exists in the Root Directory
+int FileExists(unsigned char *FileName);
+
 // Load the given program into memory
 int LoadProgram(unsigned char *Filename);
 
 // Prints the Root Directory
 void PrintRootDirectory();
 
-// Finds a given Root Directory Entry by its Filename
+// Finds a given Root Directory Entry by its Filename.
+// The caller must hold the Root Directory lock.
 RootDirectoryEntry* FindRootDirectoryEntry(unsigned char *Filename);
 
 // Prints out the FileDescriptorList entries
@@ -129,4 +151,25 @@ static void LoadProgramIntoMemory(RootDirectoryEntry *Entry);
 // Calculates a Hash Value for the given file name
 static unsigned long HashFileName(unsigned char *FileName);
 
+// Returns the FileDescriptor of the given file handle with an additional reference, or 0 if the file isn't opened
+static FileDescriptor *AcquireFileDescriptor(unsigned long FileHandle);
+
+// Releases a reference of the given FileDescriptor, and frees it with the last reference
+static void ReleaseFileDescriptor(FileDescriptor *Descriptor);
+
+// Removes an existing file from the Root Directory and the FAT tables
+static int RemoveFile(unsigned char *FileName, unsigned char *Extension);
+
+// Reads the requested data (at most one disk sector) at the current file position into the provided buffer
+static unsigned long ReadFileData(FileDescriptor *Descriptor, RootDirectoryEntry *Entry, unsigned char *Buffer, unsigned long Length);
+
+// Writes the requested data (at most one disk sector) from the provided buffer at the current file position
+static unsigned long WriteFileData(FileDescriptor *Descriptor, RootDirectoryEntry *Entry, unsigned char *Buffer, unsigned long Length);
+
+// Acquires the Root Directory lock for reading, or exclusively for writing
+static void LockRootDirectory(int Exclusive);
+
+// Releases the Root Directory lock that was acquired by "LockRootDirectory"
+static void UnlockRootDirectory(int Exclusive);
+
 #endif
\ No newline at end of file
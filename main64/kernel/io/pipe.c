@@ -0,0 +1,401 @@
+#include "pipe.h"
+#include "../common.h"
+#include "../memory/heap.h"
+#include "../multitasking/thread.h"
+
+// All pipes of the system.
+// The pipes are statically allocated, because their locks are registered for the lock statistics on their first use.
+Pipe pipes[MAX_PIPES] =
+{
+    [0 ... MAX_PIPES - 1] = { .WaitQueue = WAIT_QUEUE_INITIALIZER("Pipe") }
+};
+
+// Protects the pipe handles of all processes
+Spinlock pipeHandleLock = SPINLOCK_INITIALIZER("PipeHandles");
+
+// Creates a new pipe for the process of the given ThreadGroup, and returns the handles of its read end and its write end.
+// The process owns both handles, so only the process can use them, and they are closed together with the ThreadGroup.
+// It returns 0 if no pipe is available anymore, or if the process has already the maximum number of pipe handles.
+int CreatePipe(ThreadGroup *Group, unsigned long *ReadHandle, unsigned long *WriteHandle)
+{
+    unsigned char *buffer;
+    unsigned long flags;
+    int i;
+
+    if (Group == 0x0)
+        return 0;
+
+    // The ring buffer is allocated before a pipe is locked, because the interrupts are disabled while the lock is held
+    buffer = (unsigned char *)malloc(PIPE_BUFFER_SIZE);
+
+    if (buffer == 0x0)
+        return 0;
+
+    for (i = 0; i < MAX_PIPES; i++)
+    {
+        flags = AcquireSpinlockIrqSave(&pipes[i].WaitQueue.Lock);
+
+        if (pipes[i].InUse == 0)
+        {
+            pipes[i].InUse = 1;
+            pipes[i].Buffer = buffer;
+            pipes[i].ReadPosition = 0;
+            pipes[i].WritePosition = 0;
+            pipes[i].Readers = 1;
+            pipes[i].Writers = 1;
+
+            *ReadHandle = GetPipeHandle(i, 0);
+            *WriteHandle = GetPipeHandle(i, 1);
+
+            ReleaseSpinlockIrqRestore(&pipes[i].WaitQueue.Lock, flags);
+
+            // The new pipe is released again, when the process can't own its handles
+            if (!AddOwnedPipeHandle(Group, *ReadHandle))
+            {
+                ClosePipeHandle(*ReadHandle);
+                ClosePipeHandle(*WriteHandle);
+                return 0;
+            }
+
+            if (!AddOwnedPipeHandle(Group, *WriteHandle))
+            {
+                CloseOwnedPipeHandle(Group, *ReadHandle);
+                ClosePipeHandle(*WriteHandle);
+                return 0;
+            }
+
+            return 1;
+        }
+
+        ReleaseSpinlockIrqRestore(&pipes[i].WaitQueue.Lock, flags);
+    }
+
+    free(buffer);
+    return 0;
+}
+
+// Returns 1 if the given handle is a pipe handle
+int IsPipeHandle(unsigned long Handle)
+{
+    return (Handle & 0xC000000000000000) == PIPE_HANDLE;
+}
+
+// Returns 1 if the given pipe handle belongs to the process of the given ThreadGroup.
+// The process owns the handles that it has created, and the handles of its standard input and output.
+int IsPipeHandleOwned(ThreadGroup *Group, unsigned long Handle)
+{
+    unsigned long flags;
+    int owned = 0;
+    int i;
+
+    if ((Group == 0x0) || !IsPipeHandle(Handle))
+        return 0;
+
+    if ((Handle == Group->StandardInput) || (Handle == Group->StandardOutput))
+        return 1;
+
+    flags = AcquireSpinlockIrqSave(&pipeHandleLock);
+
+    for (i = 0; (i < MAX_PIPE_HANDLES) && (owned == 0); i++)
+        owned = Group->Pipes[i] == Handle;
+
+    ReleaseSpinlockIrqRestore(&pipeHandleLock, flags);
+    return owned;
+}
+
+// Closes a pipe handle of the process of the given ThreadGroup. It returns 0 if the process doesn't own the handle.
+// The handles of the standard input and output are only closed together with the ThreadGroup.
+int CloseOwnedPipeHandle(ThreadGroup *Group, unsigned long Handle)
+{
+    unsigned long flags;
+    int i;
+
+    if ((Group == 0x0) || !IsPipeHandle(Handle))
+        return 0;
+
+    flags = AcquireSpinlockIrqSave(&pipeHandleLock);
+
+    for (i = 0; i < MAX_PIPE_HANDLES; i++)
+    {
+        if (Group->Pipes[i] == Handle)
+        {
+            Group->Pipes[i] = 0;
+            break;
+        }
+    }
+
+    ReleaseSpinlockIrqRestore(&pipeHandleLock, flags);
+
+    if (i == MAX_PIPE_HANDLES)
+        return 0;
+
+    return ClosePipeHandle(Handle);
+}
+
+// Closes all pipe handles of a terminated process.
+// The peers of the process are getting the end of the file, or the failure of a broken pipe.
+void ReleasePipeHandles(ThreadGroup *Group)
+{
+    unsigned long handles[MAX_PIPE_HANDLES];
+    unsigned long flags = AcquireSpinlockIrqSave(&pipeHandleLock);
+    int i;
+
+    // The handles are closed after the lock, because closing them wakes up the waiting readers and writers
+    for (i = 0; i < MAX_PIPE_HANDLES; i++)
+    {
+        handles[i] = Group->Pipes[i];
+        Group->Pipes[i] = 0;
+    }
+
+    ReleaseSpinlockIrqRestore(&pipeHandleLock, flags);
+
+    for (i = 0; i < MAX_PIPE_HANDLES; i++)
+    {
+        if (handles[i] != 0)
+            ClosePipeHandle(handles[i]);
+    }
+}
+
+// Opens an additional handle to the same pipe end (like for the standard input of a new process).
+// Both handles are the same value, but every handle must be closed on its own.
+// It returns 0 if the handle is invalid.
+int DuplicatePipeHandle(unsigned long Handle)
+{
+    unsigned long flags;
+    Pipe *pipe = LockPipe(Handle, &flags);
+
+    if (pipe == 0x0)
+        return 0;
+
+    if (Handle & PIPE_HANDLE_WRITE)
+        pipe->Writers++;
+    else
+        pipe->Readers++;
+
+    ReleaseSpinlockIrqRestore(&pipe->WaitQueue.Lock, flags);
+    return 1;
+}
+
+// Closes a pipe handle. It returns 0 if the handle is invalid.
+// The waiting readers are getting the end of the file when the last write end is closed, and the waiting writers
+// are failing when the last read end is closed. The pipe is released together with its last handle.
+int ClosePipeHandle(unsigned long Handle)
+{
+    unsigned char *buffer = 0x0;
+    unsigned long flags;
+    int *references;
+    Pipe *pipe = LockPipe(Handle, &flags);
+
+    if (pipe == 0x0)
+        return 0;
+
+    references = (Handle & PIPE_HANDLE_WRITE) ? &pipe->Writers : &pipe->Readers;
+
+    if (*references == 0)
+    {
+        ReleaseSpinlockIrqRestore(&pipe->WaitQueue.Lock, flags);
+        return 0;
+    }
+
+    (*references)--;
+    WakeUpAllWaiters(&pipe->WaitQueue);
+
+    if ((pipe->Readers == 0) && (pipe->Writers == 0))
+    {
+        // The ring buffer is released after the lock, and the old handles are invalidated through the new generation
+        buffer = pipe->Buffer;
+        pipe->Buffer = 0x0;
+        pipe->InUse = 0;
+        pipe->Generation++;
+    }
+
+    ReleaseSpinlockIrqRestore(&pipe->WaitQueue.Lock, flags);
+
+    if (buffer != 0x0)
+        free(buffer);
+
+    return 1;
+}
+
+// Reads the available data from a pipe into several buffers, and returns the length of the read data.
+// It blocks until data is available, and it returns 0 when all write ends are closed (the end of the file).
+// The buffers must be Kernel Mode buffers, because the data is copied while the lock of the pipe is held.
+unsigned long ReadPipe(unsigned long Handle, IoVector *Vectors, int Count)
+{
+    WaitQueueEntry entry;
+    unsigned long flags;
+    unsigned long length = 0;
+    unsigned long available;
+    unsigned long chunk;
+    Pipe *pipe;
+    int i;
+
+    if (Handle & PIPE_HANDLE_WRITE)
+        return 0;
+
+    pipe = LockPipe(Handle, &flags);
+
+    if (pipe == 0x0)
+        return 0;
+
+    // Wait until a writer has written some data, or until all write ends are closed.
+    // The pipe can be released by another thread of the process, which closes the same read end concurrently.
+    while (IsPipeOpen(pipe, Handle) && (pipe->ReadPosition == pipe->WritePosition) && (pipe->Writers > 0))
+        SleepOnWaitQueueWithKey(&pipe->WaitQueue, &entry, PIPE_WAIT_READER);
+
+    if (IsPipeOpen(pipe, Handle))
+    {
+        available = pipe->WritePosition - pipe->ReadPosition;
+
+        // Fill the buffers one after another with the available data, without waiting for more data
+        for (i = 0; (i < Count) && (available > 0); i++)
+        {
+            chunk = Vectors[i].Length < available ? Vectors[i].Length : available;
+            CopyFromRingBuffer(pipe, Vectors[i].Buffer, chunk);
+            available -= chunk;
+            length += chunk;
+        }
+
+        // The waiting writers can continue with the free space
+        if (length > 0)
+            WakeUpWaitersWithKey(&pipe->WaitQueue, PIPE_WAIT_WRITER, PIPE_WAKE_ALL);
+    }
+
+    ReleaseSpinlockIrqRestore(&pipe->WaitQueue.Lock, flags);
+    return length;
+}
+
+// Writes the data from several buffers into a pipe, and returns the length of the written data.
+// It blocks while the pipe is full, and it returns 0 when all read ends are closed.
+// The buffers must be Kernel Mode buffers, because the data is copied while the lock of the pipe is held.
+unsigned long WritePipe(unsigned long Handle, IoVector *Vectors, int Count)
+{
+    WaitQueueEntry entry;
+    unsigned long flags;
+    unsigned long length = 0;
+    unsigned long offset;
+    unsigned long space;
+    unsigned long chunk;
+    int broken = 0;
+    Pipe *pipe;
+    int i;
+
+    if ((Handle & PIPE_HANDLE_WRITE) == 0)
+        return 0;
+
+    pipe = LockPipe(Handle, &flags);
+
+    if (pipe == 0x0)
+        return 0;
+
+    for (i = 0; (i < Count) && (broken == 0); i++)
+    {
+        offset = 0;
+
+        while ((offset < Vectors[i].Length) && (broken == 0))
+        {
+            // Wait until a reader has made some space, or until all read ends are closed
+            while (IsPipeOpen(pipe, Handle) && (pipe->WritePosition - pipe->ReadPosition == PIPE_BUFFER_SIZE) && (pipe->Readers > 0))
+                SleepOnWaitQueueWithKey(&pipe->WaitQueue, &entry, PIPE_WAIT_WRITER);
+
+            if (!IsPipeOpen(pipe, Handle) || (pipe->Readers == 0))
+            {
+                broken = 1;
+                break;
+            }
+
+            // Write as much data as fits into the ring buffer, and let the waiting readers already consume it
+            space = PIPE_BUFFER_SIZE - (pipe->WritePosition - pipe->ReadPosition);
+            chunk = Vectors[i].Length - offset < space ? Vectors[i].Length - offset : space;
+            CopyToRingBuffer(pipe, Vectors[i].Buffer + offset, chunk);
+            offset += chunk;
+            length += chunk;
+
+            WakeUpWaitersWithKey(&pipe->WaitQueue, PIPE_WAIT_READER, PIPE_WAKE_ALL);
+        }
+    }
+
+    ReleaseSpinlockIrqRestore(&pipe->WaitQueue.Lock, flags);
+    return length;
+}
+
+// Adds the given pipe handle to the handles of the process of the given ThreadGroup.
+// It returns 0 if the process has already the maximum number of pipe handles.
+static int AddOwnedPipeHandle(ThreadGroup *Group, unsigned long Handle)
+{
+    unsigned long flags = AcquireSpinlockIrqSave(&pipeHandleLock);
+    int i;
+
+    for (i = 0; i < MAX_PIPE_HANDLES; i++)
+    {
+        if (Group->Pipes[i] == 0)
+        {
+            Group->Pipes[i] = Handle;
+            break;
+        }
+    }
+
+    ReleaseSpinlockIrqRestore(&pipeHandleLock, flags);
+    return i < MAX_PIPE_HANDLES;
+}
+
+// Returns the pipe of the given handle with its acquired lock, or 0x0 if the handle is invalid
+static Pipe *LockPipe(unsigned long Handle, unsigned long *Flags)
+{
+    int index = (Handle >> 1) & 0x7F;
+    Pipe *pipe;
+
+    if (!IsPipeHandle(Handle) || (index >= MAX_PIPES))
+        return 0x0;
+
+    pipe = &pipes[index];
+    *Flags = AcquireSpinlockIrqSave(&pipe->WaitQueue.Lock);
+
+    if (!IsPipeOpen(pipe, Handle))
+    {
+        ReleaseSpinlockIrqRestore(&pipe->WaitQueue.Lock, *Flags);
+        return 0x0;
+    }
+
+    return pipe;
+}
+
+// Returns 1 if the given pipe is still used by the generation of the given handle.
+// The caller must hold the lock of the pipe.
+static int IsPipeOpen(Pipe *Pipe, unsigned long Handle)
+{
+    return (Pipe->InUse == 1) && (Pipe->Generation == (unsigned int)(Handle >> 8));
+}
+
+// Returns the handle of the given pipe end.
+// The caller must hold the lock of the pipe.
+static unsigned long GetPipeHandle(int Index, int Write)
+{
+    return PIPE_HANDLE | ((unsigned long)pipes[Index].Generation << 8) | (Index << 1) | (Write ? PIPE_HANDLE_WRITE : 0);
+}
+
+// Copies the given length of data out of the ring buffer, which must be available.
+// The caller must hold the lock of the pipe.
+static void CopyFromRingBuffer(Pipe *Pipe, unsigned char *Buffer, unsigned long Length)
+{
+    unsigned long offset = Pipe->ReadPosition & PIPE_BUFFER_MASK;
+    unsigned long first = PIPE_BUFFER_SIZE - offset < Length ? PIPE_BUFFER_SIZE - offset : Length;
+
+    // The data can wrap around at the end of the ring buffer
+    memcpy(Buffer, Pipe->Buffer + offset, first);
+    memcpy(Buffer + first, Pipe->Buffer, Length - first);
+    Pipe->ReadPosition += Length;
+}
+
+// Copies the given length of data into the ring buffer, which must have enough free space.
+// The caller must hold the lock of the pipe.
+static void CopyToRingBuffer(Pipe *Pipe, unsigned char *Buffer, unsigned long Length)
+{
+    unsigned long offset = Pipe->WritePosition & PIPE_BUFFER_MASK;
+    unsigned long first = PIPE_BUFFER_SIZE - offset < Length ? PIPE_BUFFER_SIZE - offset : Length;
+
+    // The data can wrap around at the end of the ring buffer
+    memcpy(Pipe->Buffer + offset, Buffer, first);
+    memcpy(Pipe->Buffer, Buffer + first, Length - first);
+    Pipe->WritePosition += Length;
+}
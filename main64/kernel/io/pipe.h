@@ -0,0 +1,103 @@
+#ifndef PIPE_H
+#define PIPE_H
+
+#include "fat12.h"
+#include "../multitasking/waitqueue.h"
+
+// The maximum number of pipes in the system
+#define MAX_PIPES               16
+
+// The maximum number of pipe handles, that a process can create with the SysCall "SYSCALL_PIPE"
+#define MAX_PIPE_HANDLES        8
+
+// The size of the ring buffer of a pipe (must be a power of 2)
+#define PIPE_BUFFER_SIZE        4096
+#define PIPE_BUFFER_MASK        (PIPE_BUFFER_SIZE - 1)
+
+// The handles of the pipe ends are using the bit 62, so they never collide with the 32 bit hash values of the
+// FAT12 file handles, and with the console handle (bit 63).
+// The bits 8 - 39 are containing the generation of the pipe, the bits 1 - 7 its index, and the bit 0 the pipe end.
+#define PIPE_HANDLE             0x4000000000000000
+#define PIPE_HANDLE_WRITE       0x1
+
+// The keys of the Tasks that are waiting on the Wait Queue of a pipe
+#define PIPE_WAIT_READER        0x1
+#define PIPE_WAIT_WRITER        0x2
+
+// Wakes up all waiting readers or writers of a pipe
+#define PIPE_WAKE_ALL           0x7FFFFFFF
+
+struct ThreadGroup;
+
+// Represents an anonymous pipe, which is a ring buffer between the Tasks that are holding its read and write ends
+typedef struct Pipe
+{
+    // The readers and writers of the pipe are waiting here.
+    // The lock of the Wait Queue also protects the state of the pipe.
+    WaitQueue WaitQueue;
+
+    // The ring buffer, and the free running positions of the next byte to read and to write
+    unsigned char *Buffer;
+    unsigned long ReadPosition;
+    unsigned long WritePosition;
+
+    // The number of open handles to the read end and the write end.
+    // The pipe is released, when both ends are closed.
+    int Readers;
+    int Writers;
+
+    // 1 if the pipe is used, and the generation that invalidates the handles of a released pipe
+    int InUse;
+    unsigned int Generation;
+} Pipe;
+
+// Creates a new pipe for the process of the given ThreadGroup, and returns the handles of its read end and its write end.
+// It returns 0 if no pipe is available anymore, or if the process has already the maximum number of pipe handles.
+int CreatePipe(struct ThreadGroup *Group, unsigned long *ReadHandle, unsigned long *WriteHandle);
+
+// Returns 1 if the given handle is a pipe handle
+int IsPipeHandle(unsigned long Handle);
+
+// Returns 1 if the given pipe handle belongs to the process of the given ThreadGroup
+int IsPipeHandleOwned(struct ThreadGroup *Group, unsigned long Handle);
+
+// Closes a pipe handle of the process of the given ThreadGroup. It returns 0 if the process doesn't own the handle.
+int CloseOwnedPipeHandle(struct ThreadGroup *Group, unsigned long Handle);
+
+// Closes all pipe handles of a terminated process
+void ReleasePipeHandles(struct ThreadGroup *Group);
+
+// Opens an additional handle to the same pipe end (like for the standard input of a new process).
+// It returns 0 if the handle is invalid.
+int DuplicatePipeHandle(unsigned long Handle);
+
+// Closes a pipe handle. It returns 0 if the handle is invalid.
+int ClosePipeHandle(unsigned long Handle);
+
+// Reads the available data from a pipe into several buffers, and returns the length of the read data.
+// It blocks until data is available, and it returns 0 when all write ends are closed (the end of the file).
+unsigned long ReadPipe(unsigned long Handle, IoVector *Vectors, int Count);
+
+// Writes the data from several buffers into a pipe, and returns the length of the written data.
+// It blocks while the pipe is full, and it returns 0 when all read ends are closed.
+unsigned long WritePipe(unsigned long Handle, IoVector *Vectors, int Count);
+
+// Adds the given pipe handle to the handles of the process of the given ThreadGroup
+static int AddOwnedPipeHandle(struct ThreadGroup *Group, unsigned long Handle);
+
+// Returns the pipe of the given handle with its acquired lock, or 0x0 if the handle is invalid
+static Pipe *LockPipe(unsigned long Handle, unsigned long *Flags);
+
+// Returns 1 if the given pipe is still used by the generation of the given handle
+static int IsPipeOpen(Pipe *Pipe, unsigned long Handle);
+
+// Returns the handle of the given pipe end
+static unsigned long GetPipeHandle(int Index, int Write);
+
+// Copies the given length of data out of the ring buffer
+static void CopyFromRingBuffer(Pipe *Pipe, unsigned char *Buffer, unsigned long Length);
+
+// Copies the given length of data into the ring buffer
+static void CopyToRingBuffer(Pipe *Pipe, unsigned char *Buffer, unsigned long Length);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include "apic.h"
+#include "idt.h"
+#include "../common.h"
+#include "../memory/virtual-memory.h"
+
+// Initializes the Local APIC of the Bootstrap Processor
+void InitApic()
+{
+    // Retrieve the physical base address of the Local APIC, and map its register page uncached into the higher half.
+    // All processors use the same physical base address, therefore the mapping is shared by all of them.
+    unsigned long apicBase = rdmsr(IA32_APIC_BASE_MSR) & 0xFFFFFFFFFFFFF000;
+    MapMemoryMappedIO(APIC_BASE_VIRTUAL, apicBase);
+
+    // Install the handler for spurious interrupts
+    IdtSetGate(APIC_SPURIOUS_VECTOR, (unsigned long)ApicSpuriousInterrupt, IDT_INTERRUPT_GATE);
+
+    EnableLocalApic();
+}
+
+// Software-enables the Local APIC of the current processor.
+// It is called by every Application Processor during its startup.
+void EnableLocalApic()
+{
+    // Accept all interrupt priorities
+    ApicWrite(APIC_REGISTER_TPR, 0);
+
+    // Software-enable the Local APIC
+    ApicWrite(APIC_REGISTER_SVR, APIC_SVR_ENABLE | APIC_SPURIOUS_VECTOR);
+
+    // The Local APIC Timer stays masked until it gets programmed for the first time
+    ApicWrite(APIC_REGISTER_LVT_TIMER, APIC_LVT_MASKED | APIC_TIMER_VECTOR);
+}
+
+// Reads the given Local APIC register
+unsigned int ApicRead(unsigned int Register)
+{
+    return *(volatile unsigned int *)(APIC_BASE_VIRTUAL + Register);
+}
+
+// Writes the given value to the specified Local APIC register
+void ApicWrite(unsigned int Register, unsigned int Value)
+{
+    *(volatile unsigned int *)(APIC_BASE_VIRTUAL + Register) = Value;
+}
+
+// Signals the Local APIC that the current interrupt was handled
+void ApicSendEndOfInterrupt()
+{
+    ApicWrite(APIC_REGISTER_EOI, 0);
+}
+
+// Returns the ID of the Local APIC of the current processor
+unsigned int ApicGetId()
+{
+    return ApicRead(APIC_REGISTER_ID) >> 24;
+}
+
+// Sends an Inter-Processor Interrupt to the processor with the given Local APIC ID
+void ApicSendIpi(unsigned int ApicId, unsigned int Command)
+{
+    // The Interrupt Command Register must not be written by an Interrupt Handler in the meantime
+    unsigned long flags = SaveFlagsAndDisableInterrupts();
+
+    // Writing the low part of the Interrupt Command Register sends the Inter-Processor Interrupt
+    ApicWrite(APIC_REGISTER_ICR_HIGH, ApicId << 24);
+    ApicWrite(APIC_REGISTER_ICR_LOW, Command);
+
+    // Wait until the Local APIC has delivered the Inter-Processor Interrupt
+    while (ApicRead(APIC_REGISTER_ICR_LOW) & APIC_ICR_DELIVERY_PENDING) {}
+
+    RestoreFlags(flags);
+}
@@ -0,0 +1,69 @@
+#ifndef APIC_H
+#define APIC_H
+
+// The Model Specific Register that stores the physical base address of the Local APIC
+#define IA32_APIC_BASE_MSR              0x1B
+
+// The Model Specific Register that is used in the TSC-Deadline mode of the Local APIC Timer
+#define IA32_TSC_DEADLINE_MSR           0x6E0
+
+// Virtual address where the register page of the Local APIC is mapped to
+#define APIC_BASE_VIRTUAL               0xFFFF8000FEE00000
+
+// The various Local APIC registers (offsets from the base address)
+#define APIC_REGISTER_ID                0x020
+#define APIC_REGISTER_VERSION           0x030
+#define APIC_REGISTER_TPR               0x080
+#define APIC_REGISTER_EOI               0x0B0
+#define APIC_REGISTER_SVR               0x0F0
+#define APIC_REGISTER_ICR_LOW           0x300
+#define APIC_REGISTER_ICR_HIGH          0x310
+#define APIC_REGISTER_LVT_TIMER         0x320
+#define APIC_REGISTER_TIMER_INITIAL     0x380
+#define APIC_REGISTER_TIMER_CURRENT     0x390
+#define APIC_REGISTER_TIMER_DIVIDE      0x3E0
+
+// The various Local APIC flags
+#define APIC_SVR_ENABLE                 0x100
+#define APIC_LVT_MASKED                 0x10000
+#define APIC_LVT_TIMER_ONESHOT          0x00000
+#define APIC_LVT_TIMER_TSC_DEADLINE     0x40000
+#define APIC_TIMER_DIVIDE_BY_16         0x3
+
+// The various flags of the Interrupt Command Register (ICR)
+#define APIC_ICR_FIXED                  0x00000
+#define APIC_ICR_INIT                   0x00500
+#define APIC_ICR_STARTUP                0x00600
+#define APIC_ICR_DELIVERY_PENDING       0x01000
+#define APIC_ICR_LEVEL_ASSERT           0x04000
+#define APIC_ICR_TRIGGER_LEVEL          0x08000
+
+// The Interrupt Vectors used by the Local APIC
+#define APIC_TIMER_VECTOR               48
+#define APIC_SPURIOUS_VECTOR            255
+
+// Initializes the Local APIC of the Bootstrap Processor
+void InitApic();
+
+// Software-enables the Local APIC of the current processor
+void EnableLocalApic();
+
+// Reads the given Local APIC register
+unsigned int ApicRead(unsigned int Register);
+
+// Writes the given value to the specified Local APIC register
+void ApicWrite(unsigned int Register, unsigned int Value);
+
+// Signals the Local APIC that the current interrupt was handled
+void ApicSendEndOfInterrupt();
+
+// Returns the ID of the Local APIC of the current processor
+unsigned int ApicGetId();
+
+// Sends an Inter-Processor Interrupt to the processor with the given Local APIC ID
+void ApicSendIpi(unsigned int ApicId, unsigned int Command);
+
+// The handler for spurious interrupts of the Local APIC (implemented in Assembler)
+extern void ApicSpuriousInterrupt();
+
+#endif
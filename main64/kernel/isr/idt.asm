@@ -5,6 +5,8 @@
 [GLOBAL IdtFlush]
 [GLOBAL DisableInterrupts]
 [GLOBAL EnableInterrupts]
+[GLOBAL SaveFlagsAndDisableInterrupts]
+[GLOBAL RestoreFlags]
 
 ; =======================================================================
 ; The following constants defines the offsets for the various registers
@@ -34,6 +36,17 @@
 %DEFINE StackOffset_GS      8
 %DEFINE StackOffset_CR3     0
 
+; Executes SWAPGS, when the interrupted code (or the code that we return to) executes in User Mode.
+; In Kernel Mode the GS base points to the per-CPU data area of the processor, and in User Mode the per-CPU data
+; area is parked in the MSR IA32_KERNEL_GS_BASE. The parameter is the offset of the saved CS register from RSP.
+; (the same macro is defined in the files "idt.asm", "irq.asm", "syscall.asm" and "contextswitching.asm")
+%MACRO SWAPGS_IF_USERMODE 1
+    TEST    QWORD [RSP + %1], 0x3
+    JZ      %%KernelMode
+    SWAPGS
+%%KernelMode:
+%ENDMACRO
+
 ; Virtual address where the RegisterState structure will be stored
 REGISTERSTATE_OFFSET    EQU 0xFFFF800000063000
 
@@ -54,10 +67,25 @@ EnableInterrupts:
     STI
     RET
 
+; Disables the hardware interrupts, and returns the previous RFLAGS register
+SaveFlagsAndDisableInterrupts:
+    PUSHFQ
+    POP     RAX
+    CLI
+    RET
+
+; Restores the RFLAGS register (and therefore the Interrupt Flag), which was returned by "SaveFlagsAndDisableInterrupts"
+RestoreFlags:
+    ; The first function parameter is provided in the RDI register on the x64 architecture
+    PUSH    RDI
+    POPFQ
+    RET
+
 ; The following macro emits the ISR assembly routine
 %MACRO ISR_NOERRORCODE 1
     [GLOBAL Isr%1]
     Isr%1:
+        SWAPGS_IF_USERMODE 8
         CLI
 
         ; Produce a new Stack Frame
@@ -283,6 +311,7 @@ EnableInterrupts:
         ; Restore the Stack Base Pointer
         POP     RBP
 
+        SWAPGS_IF_USERMODE 8
         STI
         IRETQ
 %ENDMACRO
@@ -291,6 +320,7 @@ EnableInterrupts:
 %MACRO ISR_ERRORCODE 1
     [GLOBAL Isr%1]
     Isr%1:
+        SWAPGS_IF_USERMODE 16
         CLI
 
         ; Produce a new Stack Frame
@@ -489,6 +519,13 @@ EnableInterrupts:
         MOV     RDX, REGISTERSTATE_OFFSET   ; Set the 3rd parameter to the memory location where the structure with the RegisterState is stored
         CALL    IsrHandler
 
+        ; Continue at the fixup address, when the exception was raised by an access to User Mode memory
+        ; (the function "IsrHandler" returns the fixup address, or 0)
+        TEST    RAX, RAX
+        JZ      %%NoFixup
+        MOV     [RSP + 200], RAX
+%%NoFixup:
+
         ; Restore the *original* general purpose register values from the Stack
         POP     RAX     ; CR3
         POP     RAX     ; SS
@@ -521,6 +558,7 @@ EnableInterrupts:
         ADD     RSP, 8
 
         ; Return from the ISR routine...
+        SWAPGS_IF_USERMODE 8
         STI
         IRETQ
 %ENDMACRO
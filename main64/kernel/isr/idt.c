@@ -1,10 +1,15 @@
 #include "idt.h"
 #include "irq.h"
+#include "apic.h"
 #include "../common.h"
 #include "../multitasking/multitasking.h"
+#include "../multitasking/smp.h"
+#include "../multitasking/fpu.h"
 #include "../syscalls/syscall.h"
+#include "../syscalls/usercopy.h"
 #include "../drivers/screen.h"
 #include "../memory/virtual-memory.h"
+#include "../drivers/timer.h"
 
 // The 256 possible Interrupt Gates are stored from 0xFFFF800000060000 to 0xFFFF800000060FFF (4096 Bytes long - each Entry is 16 Bytes)
 IdtEntry *idtEntries = (IdtEntry *)IDT_START_OFFSET;
@@ -19,39 +24,41 @@ void InitIdt()
     idtPointer.Base = (unsigned long)idtEntries;
     memset(idtEntries, 0, sizeof(IdtEntry) * IDT_ENTRIES);
 
-    // Setup the 32 Exception handlers - as described in Volume 3A: 6.15
-    IdtSetGate(EXCEPTION_DIVIDE, (unsigned long)Isr0, IDT_TRAP_GATE);                       // Divide Error Exception
-    IdtSetGate(EXCEPTION_DEBUG, (unsigned long)Isr1, IDT_TRAP_GATE);                        // Debug Exception
-    IdtSetGate(EXCEPTION_NON_MASKABLE_INTERRUPT, (unsigned long)Isr2, IDT_TRAP_GATE);       // Non-Maskable Interrupt
-    IdtSetGate(EXCEPTION_BREAKPOINT, (unsigned long)Isr3, IDT_TRAP_GATE);                   // Breakpoint Exception
-    IdtSetGate(EXCEPTION_OVERFLOW, (unsigned long)Isr4, IDT_TRAP_GATE);                     // Overflow Exception
-    IdtSetGate(EXCEPTION_BOUND_RANGE, (unsigned long)Isr5, IDT_TRAP_GATE);                  // Bound Range Exceeded Exception
-    IdtSetGate(EXCEPTION_INVALID_OPCODE, (unsigned long)Isr6, IDT_TRAP_GATE);               // Invalid Opcode Exception
-    IdtSetGate(EXCEPTION_DEVICE_NOT_AVAILABLE, (unsigned long)Isr7, IDT_TRAP_GATE);         // Device Not Available Exception
+    // Setup the 32 Exception handlers - as described in Volume 3A: 6.15.
+    // All of them are Interrupt Gates, because an interrupt between the entry of the handler and its SWAPGS
+    // instruction would find the GS base of User Mode.
+    IdtSetGate(EXCEPTION_DIVIDE, (unsigned long)Isr0, IDT_INTERRUPT_GATE);                  // Divide Error Exception
+    IdtSetGate(EXCEPTION_DEBUG, (unsigned long)Isr1, IDT_INTERRUPT_GATE);                   // Debug Exception
+    IdtSetGate(EXCEPTION_NON_MASKABLE_INTERRUPT, (unsigned long)Isr2, IDT_INTERRUPT_GATE);  // Non-Maskable Interrupt
+    IdtSetGate(EXCEPTION_BREAKPOINT, (unsigned long)Isr3, IDT_INTERRUPT_GATE);              // Breakpoint Exception
+    IdtSetGate(EXCEPTION_OVERFLOW, (unsigned long)Isr4, IDT_INTERRUPT_GATE);                // Overflow Exception
+    IdtSetGate(EXCEPTION_BOUND_RANGE, (unsigned long)Isr5, IDT_INTERRUPT_GATE);             // Bound Range Exceeded Exception
+    IdtSetGate(EXCEPTION_INVALID_OPCODE, (unsigned long)Isr6, IDT_INTERRUPT_GATE);          // Invalid Opcode Exception
+    IdtSetGate(EXCEPTION_DEVICE_NOT_AVAILABLE, (unsigned long)Isr7, IDT_INTERRUPT_GATE);    // Device Not Available Exception
     IdtSetGate(EXCEPTION_DOUBLE_FAULT, (unsigned long)Isr8, IDT_INTERRUPT_GATE);            // Double Fault Exception
-    IdtSetGate(EXCEPTION_COPROCESSOR_SEGMENT_OVERRUN, (unsigned long)Isr9, IDT_TRAP_GATE);  // Coprocessor Segment Overrun
+    IdtSetGate(EXCEPTION_COPROCESSOR_SEGMENT_OVERRUN, (unsigned long)Isr9, IDT_INTERRUPT_GATE); // Coprocessor Segment Overrun
     IdtSetGate(EXCEPTION_INVALID_TSS, (unsigned long)Isr10, IDT_INTERRUPT_GATE);            // Invalid TSS Exception
     IdtSetGate(EXCEPTION_SEGMENT_NOT_PRESENT, (unsigned long)Isr11, IDT_INTERRUPT_GATE);    // Segment Not Present
     IdtSetGate(EXCEPTION_STACK_FAULT, (unsigned long)Isr12, IDT_INTERRUPT_GATE);            // Stack Fault Exception
     IdtSetGate(EXCEPTION_GENERAL_PROTECTION, (unsigned long)Isr13, IDT_INTERRUPT_GATE);     // General Protection Exception
     IdtSetGate(EXCEPTION_PAGE_FAULT, (unsigned long)Isr14, IDT_INTERRUPT_GATE);             // Page Fault Exception
-    IdtSetGate(EXCEPTION_UNASSGIGNED, (unsigned long)Isr15, IDT_TRAP_GATE);                 // Unassigned
-    IdtSetGate(EXCEPTION_X87_FPU, (unsigned long)Isr16, IDT_TRAP_GATE);                     // x87 FPU Floating Point Error
-    IdtSetGate(EXCEPTION_ALIGNMENT_CHECK, (unsigned long)Isr17, IDT_TRAP_GATE);             // Alignment Check Exception
-    IdtSetGate(EXCEPTION_MACHINE_CHECK, (unsigned long)Isr18, IDT_TRAP_GATE);               // Machine Check Exception
-    IdtSetGate(EXCEPTION_SIMD_FLOATING_POINT, (unsigned long)Isr19, IDT_TRAP_GATE);         // SIMD Floating Point Exception
-    IdtSetGate(EXCEPTION_VIRTUALIZATION, (unsigned long)Isr20, IDT_TRAP_GATE);              // Virtualization Exception
-    IdtSetGate(EXCEPTION_CONTROL_PROTECTION, (unsigned long)Isr21, IDT_TRAP_GATE);          // Control Protection Exception
-    IdtSetGate(EXCEPTION_RESERVED_22, (unsigned long)Isr22, IDT_TRAP_GATE);                 // Reserved
-    IdtSetGate(EXCEPTION_RESERVED_23, (unsigned long)Isr23, IDT_TRAP_GATE);                 // Reserved
-    IdtSetGate(EXCEPTION_RESERVED_24, (unsigned long)Isr24, IDT_TRAP_GATE);                 // Reserved
-    IdtSetGate(EXCEPTION_RESERVED_25, (unsigned long)Isr25, IDT_TRAP_GATE);                 // Reserved
-    IdtSetGate(EXCEPTION_RESERVED_26, (unsigned long)Isr26, IDT_TRAP_GATE);                 // Reserved
-    IdtSetGate(EXCEPTION_RESERVED_27, (unsigned long)Isr27, IDT_TRAP_GATE);                 // Reserved
-    IdtSetGate(EXCEPTION_RESERVED_28, (unsigned long)Isr28, IDT_TRAP_GATE);                 // Reserved
-    IdtSetGate(EXCEPTION_RESERVED_29, (unsigned long)Isr29, IDT_TRAP_GATE);                 // Reserved
-    IdtSetGate(EXCEPTION_RESERVED_30, (unsigned long)Isr30, IDT_TRAP_GATE);                 // Reserved
-    IdtSetGate(EXCEPTION_RESERVED_31, (unsigned long)Isr31, IDT_TRAP_GATE);                 // Reserved
+    IdtSetGate(EXCEPTION_UNASSGIGNED, (unsigned long)Isr15, IDT_INTERRUPT_GATE);            // Unassigned
+    IdtSetGate(EXCEPTION_X87_FPU, (unsigned long)Isr16, IDT_INTERRUPT_GATE);                // x87 FPU Floating Point Error
+    IdtSetGate(EXCEPTION_ALIGNMENT_CHECK, (unsigned long)Isr17, IDT_INTERRUPT_GATE);        // Alignment Check Exception
+    IdtSetGate(EXCEPTION_MACHINE_CHECK, (unsigned long)Isr18, IDT_INTERRUPT_GATE);          // Machine Check Exception
+    IdtSetGate(EXCEPTION_SIMD_FLOATING_POINT, (unsigned long)Isr19, IDT_INTERRUPT_GATE);    // SIMD Floating Point Exception
+    IdtSetGate(EXCEPTION_VIRTUALIZATION, (unsigned long)Isr20, IDT_INTERRUPT_GATE);         // Virtualization Exception
+    IdtSetGate(EXCEPTION_CONTROL_PROTECTION, (unsigned long)Isr21, IDT_INTERRUPT_GATE);     // Control Protection Exception
+    IdtSetGate(EXCEPTION_RESERVED_22, (unsigned long)Isr22, IDT_INTERRUPT_GATE);            // Reserved
+    IdtSetGate(EXCEPTION_RESERVED_23, (unsigned long)Isr23, IDT_INTERRUPT_GATE);            // Reserved
+    IdtSetGate(EXCEPTION_RESERVED_24, (unsigned long)Isr24, IDT_INTERRUPT_GATE);            // Reserved
+    IdtSetGate(EXCEPTION_RESERVED_25, (unsigned long)Isr25, IDT_INTERRUPT_GATE);            // Reserved
+    IdtSetGate(EXCEPTION_RESERVED_26, (unsigned long)Isr26, IDT_INTERRUPT_GATE);            // Reserved
+    IdtSetGate(EXCEPTION_RESERVED_27, (unsigned long)Isr27, IDT_INTERRUPT_GATE);            // Reserved
+    IdtSetGate(EXCEPTION_RESERVED_28, (unsigned long)Isr28, IDT_INTERRUPT_GATE);            // Reserved
+    IdtSetGate(EXCEPTION_RESERVED_29, (unsigned long)Isr29, IDT_INTERRUPT_GATE);            // Reserved
+    IdtSetGate(EXCEPTION_RESERVED_30, (unsigned long)Isr30, IDT_INTERRUPT_GATE);            // Reserved
+    IdtSetGate(EXCEPTION_RESERVED_31, (unsigned long)Isr31, IDT_INTERRUPT_GATE);            // Reserved
 
     // Setup the 16 IRQ handlers
     IdtSetGate(32, (unsigned long)Irq0,  IDT_INTERRUPT_GATE);   // Timer
@@ -96,13 +103,44 @@ void IdtSetGate(unsigned char Entry, unsigned long BaseAddress, unsigned char Ty
 }
 
 // Our generic ISR handler, which is called from the assembly code.
-void IsrHandler(int InterruptNumber, unsigned long cr2, RegisterState *Registers)
+// It returns the address where the execution continues, when the exception was raised by an access to User Mode
+// memory that can't be resolved (otherwise 0).
+unsigned long IsrHandler(int InterruptNumber, unsigned long cr2, RegisterState *Registers)
 {
+    unsigned long fixup = SearchExceptionFixup(Registers->RIP);
+
     if (InterruptNumber == EXCEPTION_PAGE_FAULT)
     {
+        Task *task = GetTaskState();
+
+        // A copy routine has accessed Kernel Mode memory (or a read-only page) through a User Mode pointer, so it just stops the copy
+        if ((fixup != 0) && (!IsUserModeAddressRange(cr2, 1) || (Registers->ErrorCode & PAGE_FAULT_PROTECTION_VIOLATION)))
+            return fixup;
+
+        // A write to a read-only page can't be resolved by mapping a new Page Frame
+        if (Registers->ErrorCode & PAGE_FAULT_PROTECTION_VIOLATION)
+        {
+            DisplayException(InterruptNumber, Registers);
+            while (1 == 1) {}
+        }
+
+        // Record the Page Fault for the current Task
+        if (task != 0x0)
+            task->PageFaults++;
+
         // Handle the Page Fault
         HandlePageFault(cr2);
     }
+    else if (InterruptNumber == EXCEPTION_DEVICE_NOT_AVAILABLE)
+    {
+        // The current Task has used the FPU for the first time since it was switched in
+        HandleDeviceNotAvailable();
+    }
+    else if ((InterruptNumber == EXCEPTION_GENERAL_PROTECTION) && (fixup != 0))
+    {
+        // A copy routine has accessed a non-canonical address through a User Mode pointer
+        return fixup;
+    }
     else
     {
         // Every other exception just stops the system
@@ -113,15 +151,33 @@ void IsrHandler(int InterruptNumber, unsigned long cr2, RegisterState *Registers
         // Halt the system
         while (1 == 1) {}
     }
+
+    return 0;
 }
 
-// Installs the IRQ0 interrupt handler that performs the Context Switching between the various tasks
+// Installs the Local APIC Timer interrupt handler that performs the Context Switching between the various tasks
 void InitTimerForContextSwitching()
 {
-    IdtSetGate(32, (unsigned long)Irq0_ContextSwitching, IDT_INTERRUPT_GATE);
+    IdtSetGate(APIC_TIMER_VECTOR, (unsigned long)Irq0_ContextSwitching, IDT_INTERRUPT_GATE);
+
+    // The Context Switching runs on the Scheduler Stack of the processor, because the Kernel Mode Stack of the
+    // interrupted Task can be used by another processor, as soon as the Task is queued again
+    idtEntries[APIC_TIMER_VECTOR].InterruptStackTable = SCHEDULER_IST;
 
     // Loads the IDT table into the processor register (Assembler function)
     IdtFlush((unsigned long)&idtPointer);
+
+    // Raise the first timer interrupt, which programs all further timer interrupts
+    ProgramTimerInterrupt(TIMESLICE_NANOSECONDS);
+
+    // The Application Processors can now execute Tasks
+    ReleaseApplicationProcessors();
+}
+
+// Loads the shared IDT table into the current processor (used by the Application Processors)
+void LoadIdt()
+{
+    IdtFlush((unsigned long)&idtPointer);
 }
 
 // Displays the state of the general purpose registers when the exception has occured.
@@ -47,6 +47,9 @@
 #define EXCEPTION_RESERVED_30                   30
 #define EXCEPTION_RESERVED_31                   31
 
+// The error code of a Page Fault has this bit set, when the page was present (a write to a read-only page)
+#define PAGE_FAULT_PROTECTION_VIOLATION         0x1
+
 // Represents an Interrupt Gate - 128 Bit long
 // As described in Volume 3A: 6.14.1
 struct IdtEntry
@@ -116,14 +119,18 @@ void InitIdt();
 void IdtSetGate(unsigned char Entry, unsigned long BaseAddress, unsigned char Type);
 
 // Our generic ISR handler, which is called from the assembly code.
-void IsrHandler(int InterruptNumber, unsigned long cr2, RegisterState *Registers);
+// It returns the fixup address for an exception that was raised by an access to User Mode memory (otherwise 0).
+unsigned long IsrHandler(int InterruptNumber, unsigned long cr2, RegisterState *Registers);
 
 // Displays the state of the general purpose registers when the exception has occured.
 void DisplayException(int Number, RegisterState *Registers);
 
-// Installs the IRQ0 interrupt handler that performs the Context Switching between the various tasks
+// Installs the Local APIC Timer interrupt handler that performs the Context Switching between the various tasks
 void InitTimerForContextSwitching();
 
+// Loads the shared IDT table into the current processor (used by the Application Processors)
+void LoadIdt();
+
 // Loads the IDT table into the processor register (implemented in Assembler)
 extern void IdtFlush(unsigned long);
 
@@ -133,6 +140,12 @@ extern void DisableInterrupts();
 // Enables the hardware interrupts
 extern void EnableInterrupts();
 
+// Disables the hardware interrupts, and returns the previous RFLAGS register
+extern unsigned long SaveFlagsAndDisableInterrupts();
+
+// Restores the RFLAGS register, which was returned by "SaveFlagsAndDisableInterrupts"
+extern void RestoreFlags(unsigned long Flags);
+
 // The 32 ISR routines (implemented in Assembler)
 extern void Isr0();     // Divide Error Exception
 extern void Isr1();     // Debug Exception
@@ -1,12 +1,30 @@
 [BITS 64]
 [EXTERN IrqHandler]
 [EXTERN MoveToNextTask] 
+[GLOBAL ApicSpuriousInterrupt]
+
+; The offset of the per-CPU interrupt counter in the per-CPU data area (C structure "Cpu")
+PERCPU_INTERRUPT_COUNT  EQU 32
+
+; Executes SWAPGS, when the interrupted code (or the code that we return to) executes in User Mode.
+; In Kernel Mode the GS base points to the per-CPU data area of the processor, and in User Mode the per-CPU data
+; area is parked in the MSR IA32_KERNEL_GS_BASE. The parameter is the offset of the saved CS register from RSP.
+; (the same macro is defined in the files "idt.asm", "irq.asm", "syscall.asm" and "contextswitching.asm")
+%MACRO SWAPGS_IF_USERMODE 1
+    TEST    QWORD [RSP + %1], 0x3
+    JZ      %%KernelMode
+    SWAPGS
+%%KernelMode:
+%ENDMACRO
 
 %MACRO IRQ 2
     GLOBAL Irq%1
     Irq%1:
+        SWAPGS_IF_USERMODE 8
+
         ; Disable interrupts
         CLI
+        INC     QWORD [GS:PERCPU_INTERRUPT_COUNT]
 
         ; Save the General Purpose Registers on the Stack
         PUSH    RDI
@@ -49,6 +67,7 @@
         POP     RDI
 
         ; Enable Interrupts
+        SWAPGS_IF_USERMODE 8
         STI
 
         ; Return
@@ -70,4 +89,9 @@ IRQ 11, 43  ; Reserved
 IRQ 12, 44  ; AT systems: Reserved. PS/2: Auxiliary Device
 IRQ 13, 45  ; FPU
 IRQ 14, 36  ; Hard Disk Controller
-IRQ 15, 47  ; Reserved
\ No newline at end of file
+IRQ 15, 47  ; Reserved
+
+; This function is called when the Local APIC raises a spurious interrupt.
+; A spurious interrupt must not be acknowledged with an End Of Interrupt signal.
+ApicSpuriousInterrupt:
+    IRETQ
\ No newline at end of file
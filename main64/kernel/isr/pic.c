@@ -32,6 +32,13 @@ void InitPic(unsigned char base0, unsigned char base1)
     PicSendData(icw, 1);
 }
 
+// Masks the given IRQ line of the 1st PIC, so that it doesn't raise any interrupts anymore
+void MaskIrq(unsigned char irq)
+{
+    unsigned char mask = PicReadData(0);
+    PicSendData(mask | (1 << irq), 0);
+}
+
 // Sends a command to the PICs
 static void PicSendCommand(unsigned char cmd, unsigned char picNum)
 {
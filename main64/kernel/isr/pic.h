@@ -113,6 +113,9 @@
 // Initializes the PIC, and remaps the IRQs
 void InitPic(unsigned char base0, unsigned char base1);
 
+// Masks the given IRQ line of the 1st PIC, so that it doesn't raise any interrupts anymore
+void MaskIrq(unsigned char irq);
+
 // Sends a command to the PICs
 static void PicSendCommand(unsigned char cmd, unsigned char picNum);
 
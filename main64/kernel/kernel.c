@@ -6,12 +6,18 @@
 #include "memory/heap.h"
 #include "multitasking/multitasking.h"
 #include "multitasking/gdt.h"
+#include "multitasking/workqueue.h"
+#include "multitasking/smp.h"
+#include "multitasking/fpu.h"
 #include "isr/pic.h"
+#include "isr/apic.h"
 #include "isr/idt.h"
 #include "io/fat12.h"
 #include "kernel.h"
 #include "common.h"
 #include "date.h"
+#include "syscalls/syscall.h"
+#include "syscalls/vdso.h"
 
 // The main entry of our Kernel
 void KernelMain(int KernelSize)
@@ -43,6 +49,9 @@ void InitKernel(int KernelSize)
     // Disable the hardware interrupts
     DisableInterrupts();
 
+    // Point the GS base to the per-CPU data area of the Bootstrap Processor, which is used by every interrupt handler
+    InitBootCpu();
+
     // Initialize the physical Memory Manager
     InitPhysicalMemoryManager(KernelSize);
 
@@ -57,11 +66,18 @@ void InitKernel(int KernelSize)
     // Initialize the ISR & IRQ routines
     InitIdt();
 
+    // Initialize the Local APIC
+    InitApic();
+
     // Initialize the keyboard
     InitKeyboard();
 
-    // Initialize the timer to fire every 4ms
-    InitTimer(250);
+    // Calibrate the Local APIC Timer.
+    // It runs in the One-Shot mode, and only fires when the next time slice expires or a timer is due.
+    InitTimer();
+
+    // Initialize the Work Queue, into which the Interrupt Handlers defer their work
+    InitWorkQueue();
     
     // Enable the hardware interrupts again
     EnableInterrupts();
@@ -70,17 +86,37 @@ void InitKernel(int KernelSize)
     // It generates Page Faults, therefore the interrupts must be already re-enabled.
     InitHeap();
 
-    // Initializes the GDT and TSS structures
-    InitGdt();
+    // Initialize the Timer Wheel
+    InitTimerWheel();
+
+    // Initializes the GDT and TSS structures of the Bootstrap Processor
+    InitGdt(0);
+
+    // Enable the SYSCALL/SYSRET instructions of the Bootstrap Processor
+    InitFastSysCalls();
+
+    // Find the Application Processors in the ACPI tables, and create the Idle Task of each processor
+    InitSmp();
+
+    // Enable the FPU and SSE, so that User Mode programs can use them
+    InitFpu();
 
     // Initializes the FAT12 file system
     InitFAT12();
+
+    // Initialize the shared page of the vDSO, which is mapped into every User Mode process
+    InitVdso();
     
     // Create the initial OS tasks
     CreateInitialTasks();
 
-    // Refresh the status line
+    // Refresh the status line, and refresh it every second through the Timer Wheel
     RefreshStatusLine();
+    InitSystemDateTimer();
+
+    // Start the Application Processors.
+    // They are waiting until the Context Switching is installed, and are executing Tasks afterwards.
+    StartApplicationProcessors();
 
     // Register the Context Switching IRQ Handler when the Timer fires
     InitTimerForContextSwitching();
@@ -70,7 +70,9 @@ void RemoveEntryFromList(List *List, ListEntry *Entry)
     {
         // When we remove the first list entry, we just set the new root node to the 2nd list entry
         List->RootEntry = Entry->Next;
-        List->RootEntry->Previous = 0x0;
+
+        if (List->RootEntry != 0x0)
+            List->RootEntry->Previous = 0x0;
     }
     else
     {
@@ -78,7 +80,10 @@ void RemoveEntryFromList(List *List, ListEntry *Entry)
         previousEntry = Entry->Previous;
         nextEntry = Entry->Next;
         previousEntry->Next = nextEntry;
-        nextEntry->Previous = previousEntry;
+
+        // The last list entry has no successor
+        if (nextEntry != 0x0)
+            nextEntry->Previous = previousEntry;
     }
 
     // Decrement the number of List entries
@@ -88,6 +93,31 @@ void RemoveEntryFromList(List *List, ListEntry *Entry)
     free(Entry);
 }
 
+// Moves the first entry of the given Double Linked List to its end.
+// The ListEntry structures are just relinked, therefore no Heap allocation is necessary.
+void RotateList(List *List)
+{
+    ListEntry *head = List->RootEntry;
+    ListEntry *tail = List->RootEntry;
+
+    // Nothing to do, when the List has less than 2 entries
+    if ((head == 0x0) || (head->Next == 0x0))
+        return;
+
+    // Move to the end of the List
+    while (tail->Next)
+        tail = tail->Next;
+
+    // The 2nd list entry becomes the new root node
+    List->RootEntry = head->Next;
+    List->RootEntry->Previous = 0x0;
+
+    // Add the old root node to the end of the List
+    tail->Next = head;
+    head->Previous = tail;
+    head->Next = 0x0;
+}
+
 // This function prints out the content of the Double Linked List
 void PrintList(List *List)
 {
@@ -30,6 +30,9 @@ ListEntry *GetEntryFromList(List *List, unsigned long Key);
 // Removes an entry from the given Double Linked List
 void RemoveEntryFromList(List *List, ListEntry *Node);
 
+// Moves the first entry of the given Double Linked List to its end
+void RotateList(List *List);
+
 // This function prints out the content of the Double Linked List
 void PrintList(List *List);
 
@@ -2,6 +2,7 @@
 #include "../common.h"
 #include "../drivers/screen.h"
 #include "../drivers/keyboard.h"
+#include "../multitasking/spinlock.h"
 
 unsigned long HEAP_START_OFFSET = 0xFFFF800000500000;
 unsigned long HEAP_END_OFFSET =   0xFFFF800000500000;
@@ -10,6 +11,9 @@ unsigned long HEAP_GROWTH =       0x1000;
 
 int isHeapInitialized = 0;
 
+// The Heap is shared by all processors
+Spinlock heapLock = SPINLOCK_INITIALIZER("Heap");
+
 // Initializes the Heap Manager
 int InitHeap()
 {
@@ -64,6 +68,17 @@ void DumpHeap()
 
 // Performs an allocation on the Heap.
 void *malloc(int Size)
+{
+    // The interrupts are disabled while the lock is held, so that the lock holder isn't preempted by the Context Switch
+    unsigned long flags = AcquireSpinlockIrqSave(&heapLock);
+    void *ptr = AllocateFromHeap(Size);
+    ReleaseSpinlockIrqRestore(&heapLock, flags);
+
+    return ptr;
+}
+
+// Performs an allocation on the Heap, while the caller holds the lock of the Heap
+static void *AllocateFromHeap(int Size)
 {
     // Add the size of the Header to the requested size
     Size = Size + HEADER_SIZE;
@@ -99,7 +114,7 @@ void *malloc(int Size)
         // Try to allocate the requested block after the expansion of the Heap.
         // If the Heap is still too small after the current expansion, the next recursive malloc() call will again expand
         // the Heap, until we have reached the necessary Heap size.
-        return malloc(Size - HEADER_SIZE);
+        return AllocateFromHeap(Size - HEADER_SIZE);
     }
 }
 
@@ -108,10 +123,14 @@ void free(void *ptr)
 {
     // Mark the Heap Block as Free
     HeapBlock *block = (HeapBlock *)((unsigned char *)ptr - HEADER_SIZE);
+    unsigned long flags = AcquireSpinlockIrqSave(&heapLock);
+
     block->InUse = 0;
 
     // Merge all free blocks together
     while (Merge() > 1) {}
+
+    ReleaseSpinlockIrqRestore(&heapLock, flags);
 }
 
 // Finds a free block of the requested size on the Heap
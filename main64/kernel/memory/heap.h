@@ -37,6 +37,9 @@ void TestHeapManagerAcrossPageBoundaries(int DebugOutput);
 // Tests the Heap Manager with huge allocation requests.
 void TestHeapManagerWithHugeAllocations(int DebugOutput);
 
+// Performs an allocation on the Heap, while the caller holds the lock of the Heap
+static void *AllocateFromHeap(int Size);
+
 // Finds a free block of the requested size on the Heap
 static HeapBlock *Find(int Size);
 
@@ -4,6 +4,7 @@
 #include "../list.h"
 #include "physical-memory.h"
 #include "heap.h"
+#include "../multitasking/spinlock.h"
 
 // Memory Region Type
 char *MemoryRegionType[] =
@@ -17,6 +18,9 @@ char *MemoryRegionType[] =
 // This list stores the Page Frames that are currently tracked by the Kernel
 List *TrackedPageFrames = 0x0;
 
+// The bitmap masks of the Page Frames are shared by all processors
+Spinlock pageFramesLock = SPINLOCK_INITIALIZER("PageFrames");
+
 // Memory Map 4 GB - VMware Fusion
 // 0x00 0000 0000 - 0x00 0009 F7FF     Size: 0x00 0009 F800         638 KB              Available           653312
 // 0x00 0009 F800 - 0x00 0009 FFFF     Size: 0x00 0000 0800           2 KB              Reserved                    2048
@@ -151,6 +155,16 @@ void InitPhysicalMemoryManager(int KernelSize)
 
 // Allocates the first free Page Frame and returns the Page Frame number.
 unsigned long AllocatePageFrame()
+{
+    unsigned long flags = AcquireSpinlockIrqSave(&pageFramesLock);
+    unsigned long pfn = FindFreePageFrame();
+    ReleaseSpinlockIrqRestore(&pageFramesLock, flags);
+
+    return pfn;
+}
+
+// Allocates the first free Page Frame in the bitmap masks, while the caller holds the lock of the bitmap masks
+static unsigned long FindFreePageFrame()
 {
     BiosInformationBlock *bib = (BiosInformationBlock *)BIB_OFFSET;
     PhysicalMemoryLayout *memLayout = bib->PhysicalMemoryLayout;
@@ -204,30 +218,32 @@ unsigned long AllocatePageFrame()
 }
 
 // Releases a physical Page Frame.
+// The Memory Region of the Page Frame is found through its Page Frame Number, because the allocated Page Frames
+// are not tracked (see "FindFreePageFrame").
 void ReleasePageFrame(unsigned long PageFrameNumber)
 {
     BiosInformationBlock *bib = (BiosInformationBlock *)BIB_OFFSET;
     PhysicalMemoryLayout *memLayout = bib->PhysicalMemoryLayout;
-    ListEntry *entry = GetEntryFromList(TrackedPageFrames, PageFrameNumber);
-    PageFrame *frame = (PageFrame *)entry->Payload;
+    unsigned long flags = AcquireSpinlockIrqSave(&pageFramesLock);
 
-    // Check if the requested Page Frame was found
-    if (frame != 0x0)
+    for (int k = 0; k < memLayout->MemoryRegionCount; k++)
     {
-        // Get a reference to the correct Bitmap Mask
-        PhysicalMemoryRegionDescriptor *descriptor = &memLayout->MemoryRegions[frame->MemoryRegionIndex];
-        unsigned long *bitmapMask = (unsigned long *)descriptor->BitmapMaskStartAddress;
-        PageFrameNumber = PageFrameNumber - (descriptor->PhysicalMemoryStartAddress / PAGE_SIZE);
-
-        // Clear the bit in the Bitmap Mask
-        ClearBit(PageFrameNumber, bitmapMask);
+        PhysicalMemoryRegionDescriptor *descriptor = &memLayout->MemoryRegions[k];
+        unsigned long firstPageFrame = descriptor->PhysicalMemoryStartAddress / PAGE_SIZE;
 
-        // Remove the Page Frame from the Tracked list
-        RemoveEntryFromList(TrackedPageFrames, entry);
+        if ((PageFrameNumber >= firstPageFrame) && (PageFrameNumber < firstPageFrame + descriptor->AvailablePageFrames))
+        {
+            // Clear the bit in the Bitmap Mask
+            ClearBit(PageFrameNumber - firstPageFrame, (unsigned long *)descriptor->BitmapMaskStartAddress);
 
-        // Release the memory of the PageFrame structure on the Heap
-        free(frame);
+            // Increment the number of free Page Frames
+            descriptor->FreePageFrames++;
+            bib->AvailablePageFrames++;
+            break;
+        }
     }
+
+    ReleaseSpinlockIrqRestore(&pageFramesLock, flags);
 }
 
 // This function adds the Page Frame to the TrackedPageFrameList
@@ -74,6 +74,9 @@ void InitPhysicalMemoryManager(int KernelSize);
 // Allocates the first free Page Frame and returns the Page Frame number.
 unsigned long AllocatePageFrame();
 
+// Allocates the first free Page Frame in the bitmap masks, while the caller holds the lock of the bitmap masks
+static unsigned long FindFreePageFrame();
+
 // Releases a physical Page Frame.
 void ReleasePageFrame(unsigned long PageFrameNumber);
 
@@ -0,0 +1,243 @@
+#include "sharedmemory.h"
+#include "physical-memory.h"
+#include "virtual-memory.h"
+#include "../common.h"
+#include "../multitasking/thread.h"
+#include "../multitasking/spinlock.h"
+
+// All Shared Memory Segments of the system
+SharedMemorySegment sharedMemorySegments[MAX_SHARED_MEMORY_SEGMENTS];
+
+// Protects the Shared Memory Segments, and the Shared Memory handles of all processes
+Spinlock sharedMemoryLock = SPINLOCK_INITIALIZER("SharedMemory");
+
+// Opens the Shared Memory Segment with the given name for the process of the given ThreadGroup, and returns its handle.
+// The segment is created with the given size, if it doesn't exist yet - a size of 0 only opens an existing segment.
+// It returns 0 if the segment couldn't be opened, or if the process has already the maximum number of handles.
+int OpenSharedMemory(ThreadGroup *Group, char *Name, unsigned long Size)
+{
+    SharedMemorySegment *segment;
+    unsigned long flags;
+    int pageCount = (Size + SMALL_PAGE_SIZE - 1) / SMALL_PAGE_SIZE;
+    int slot;
+
+    if ((Group == 0x0) || (Size > SHARED_MEMORY_MAX_PAGES * SMALL_PAGE_SIZE))
+        return 0;
+
+    flags = AcquireSpinlockIrqSave(&sharedMemoryLock);
+
+    for (slot = 0; slot < MAX_SHARED_MEMORY_HANDLES; slot++)
+    {
+        if (Group->SharedMemory[slot].Status == SHARED_MEMORY_HANDLE_FREE)
+            break;
+    }
+
+    if (slot == MAX_SHARED_MEMORY_HANDLES)
+    {
+        ReleaseSpinlockIrqRestore(&sharedMemoryLock, flags);
+        return 0;
+    }
+
+    segment = FindSharedMemorySegment(Name);
+
+    if ((segment == 0x0) && (pageCount > 0))
+        segment = CreateSharedMemorySegment(Name, pageCount);
+
+    if (segment == 0x0)
+    {
+        ReleaseSpinlockIrqRestore(&sharedMemoryLock, flags);
+        return 0;
+    }
+
+    segment->ReferenceCount++;
+    Group->SharedMemory[slot].Segment = segment;
+    Group->SharedMemory[slot].Status = SHARED_MEMORY_HANDLE_OPEN;
+
+    ReleaseSpinlockIrqRestore(&sharedMemoryLock, flags);
+
+    // The handle 0 is the error value, therefore the handles are starting at 1
+    return slot + 1;
+}
+
+// Maps the Shared Memory Segment of the given handle into the current address space, and returns its User Mode address.
+// The Page Frames are mapped directly into the User Mode part of the Page Tables (which were cloned by "ClonePML4Table"),
+// so all processes are accessing the same physical memory without any copies.
+// It returns 0 if the handle is invalid.
+unsigned long MapSharedMemory(ThreadGroup *Group, int Handle)
+{
+    SharedMemoryHandle *handle;
+    SharedMemorySegment *segment;
+    unsigned long address = GetSharedMemoryAddress(Handle);
+    unsigned long flags;
+    int i;
+
+    if ((Group == 0x0) || (Handle < 1) || (Handle > MAX_SHARED_MEMORY_HANDLES))
+        return 0;
+
+    flags = AcquireSpinlockIrqSave(&sharedMemoryLock);
+    handle = &Group->SharedMemory[Handle - 1];
+    segment = handle->Segment;
+
+    if (handle->Status == SHARED_MEMORY_HANDLE_OPEN)
+    {
+        for (i = 0; i < segment->PageCount; i++)
+            MapVirtualAddressToPhysicalAddress(address + i * SMALL_PAGE_SIZE, segment->PageFrames[i] * SMALL_PAGE_SIZE);
+
+        // The Page Frames are zero-initialized by the first mapping, while the other processes are still waiting for the lock
+        if (segment->Initialized == 0)
+        {
+            memset((void *)address, 0, segment->PageCount * SMALL_PAGE_SIZE);
+            segment->Initialized = 1;
+        }
+
+        handle->Status = SHARED_MEMORY_HANDLE_MAPPED;
+    }
+    else if (handle->Status != SHARED_MEMORY_HANDLE_MAPPED)
+        address = 0;
+
+    ReleaseSpinlockIrqRestore(&sharedMemoryLock, flags);
+    return address;
+}
+
+// Unmaps the Shared Memory Segment of the given handle from the current address space, and closes the handle.
+// It returns 0 if the handle is invalid.
+//
+// The other threads of the process can still cache the mapping in the TLB of their processors, because the Kernel
+// has no TLB shootdown. Therefore the reference to the segment is only released, when the process has no other
+// threads - otherwise it's released together with the process, so that its Page Frames can't be reused earlier.
+int UnmapSharedMemory(ThreadGroup *Group, int Handle)
+{
+    SharedMemoryHandle *handle;
+    unsigned long address = GetSharedMemoryAddress(Handle);
+    unsigned long flags;
+    int i;
+
+    if ((Group == 0x0) || (Handle < 1) || (Handle > MAX_SHARED_MEMORY_HANDLES))
+        return 0;
+
+    flags = AcquireSpinlockIrqSave(&sharedMemoryLock);
+    handle = &Group->SharedMemory[Handle - 1];
+
+    if ((handle->Status != SHARED_MEMORY_HANDLE_OPEN) && (handle->Status != SHARED_MEMORY_HANDLE_MAPPED))
+    {
+        ReleaseSpinlockIrqRestore(&sharedMemoryLock, flags);
+        return 0;
+    }
+
+    if (handle->Status == SHARED_MEMORY_HANDLE_MAPPED)
+    {
+        for (i = 0; i < handle->Segment->PageCount; i++)
+            UnmapVirtualAddress(address + i * SMALL_PAGE_SIZE);
+    }
+
+    if ((handle->Status == SHARED_MEMORY_HANDLE_MAPPED) && (__atomic_load_n(&Group->ReferenceCount, __ATOMIC_ACQUIRE) > 1))
+    {
+        handle->Status = SHARED_MEMORY_HANDLE_UNMAPPED;
+    }
+    else
+    {
+        ReleaseSharedMemorySegment(handle->Segment);
+        handle->Segment = 0x0;
+        handle->Status = SHARED_MEMORY_HANDLE_FREE;
+    }
+
+    ReleaseSpinlockIrqRestore(&sharedMemoryLock, flags);
+    return 1;
+}
+
+// Releases all Shared Memory handles of a terminated process.
+// The mappings are not removed, because the User Mode address space of the process is not used anymore.
+void ReleaseSharedMemory(ThreadGroup *Group)
+{
+    unsigned long flags = AcquireSpinlockIrqSave(&sharedMemoryLock);
+    int i;
+
+    for (i = 0; i < MAX_SHARED_MEMORY_HANDLES; i++)
+    {
+        if (Group->SharedMemory[i].Status != SHARED_MEMORY_HANDLE_FREE)
+        {
+            ReleaseSharedMemorySegment(Group->SharedMemory[i].Segment);
+            Group->SharedMemory[i].Segment = 0x0;
+            Group->SharedMemory[i].Status = SHARED_MEMORY_HANDLE_FREE;
+        }
+    }
+
+    ReleaseSpinlockIrqRestore(&sharedMemoryLock, flags);
+}
+
+// Returns the Shared Memory Segment with the given name, or 0x0 if it doesn't exist.
+// The caller must hold the Shared Memory lock.
+static SharedMemorySegment *FindSharedMemorySegment(char *Name)
+{
+    int i;
+
+    for (i = 0; i < MAX_SHARED_MEMORY_SEGMENTS; i++)
+    {
+        if ((sharedMemorySegments[i].ReferenceCount > 0) && (strcmp(sharedMemorySegments[i].Name, Name) == 0))
+            return &sharedMemorySegments[i];
+    }
+
+    return 0x0;
+}
+
+// Creates a new Shared Memory Segment with the given name and number of pages, or returns 0x0 if it couldn't be created.
+// The caller must hold the Shared Memory lock, and takes the first reference to the segment.
+static SharedMemorySegment *CreateSharedMemorySegment(char *Name, int PageCount)
+{
+    SharedMemorySegment *segment = 0x0;
+    int i;
+
+    for (i = 0; i < MAX_SHARED_MEMORY_SEGMENTS; i++)
+    {
+        if (sharedMemorySegments[i].ReferenceCount == 0)
+        {
+            segment = &sharedMemorySegments[i];
+            break;
+        }
+    }
+
+    if (segment == 0x0)
+        return 0x0;
+
+    for (i = 0; i < PageCount; i++)
+    {
+        segment->PageFrames[i] = AllocatePageFrame();
+
+        // No physical memory is available anymore
+        if (segment->PageFrames[i] == (unsigned long)-1)
+        {
+            while (--i >= 0)
+                ReleasePageFrame(segment->PageFrames[i]);
+
+            return 0x0;
+        }
+    }
+
+    strcpy(segment->Name, Name);
+    segment->PageCount = PageCount;
+    segment->Initialized = 0;
+
+    return segment;
+}
+
+// Releases a reference to the given Shared Memory Segment.
+// The Page Frames are released together with the last reference.
+// The caller must hold the Shared Memory lock.
+static void ReleaseSharedMemorySegment(SharedMemorySegment *Segment)
+{
+    int i;
+
+    if (--Segment->ReferenceCount > 0)
+        return;
+
+    for (i = 0; i < Segment->PageCount; i++)
+        ReleasePageFrame(Segment->PageFrames[i]);
+
+    Segment->PageCount = 0;
+}
+
+// Returns the User Mode address, at which the given handle maps its Shared Memory Segment
+static unsigned long GetSharedMemoryAddress(int Handle)
+{
+    return SHARED_MEMORY_USERMODE_ADDRESS + (Handle - 1) * SHARED_MEMORY_MAPPING_SIZE;
+}
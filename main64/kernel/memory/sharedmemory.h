@@ -0,0 +1,81 @@
+#ifndef SHAREDMEMORY_H
+#define SHAREDMEMORY_H
+
+// The maximum number of named Shared Memory Segments in the system
+#define MAX_SHARED_MEMORY_SEGMENTS      16
+
+// The size of the name of a Shared Memory Segment (including the terminating zero)
+#define SHARED_MEMORY_NAME_LENGTH       16
+
+// The maximum number of pages of a Shared Memory Segment (256 KB)
+#define SHARED_MEMORY_MAX_PAGES         64
+
+// The maximum number of Shared Memory handles of a process
+#define MAX_SHARED_MEMORY_HANDLES       8
+
+// Every handle of a process has its own mapping area in the User Mode address space, which is large enough for
+// the largest Shared Memory Segment. The same segment can therefore be mapped at different addresses in each process.
+#define SHARED_MEMORY_USERMODE_ADDRESS  0x0000400000000000
+#define SHARED_MEMORY_MAPPING_SIZE      (SHARED_MEMORY_MAX_PAGES * 4096)
+
+// The status of a Shared Memory handle
+#define SHARED_MEMORY_HANDLE_FREE       0x0
+#define SHARED_MEMORY_HANDLE_OPEN       0x1
+#define SHARED_MEMORY_HANDLE_MAPPED     0x2
+#define SHARED_MEMORY_HANDLE_UNMAPPED   0x3
+
+struct ThreadGroup;
+
+// Represents a named Shared Memory Segment.
+// Its Page Frames are mapped into the address spaces of all processes that are sharing it.
+typedef struct SharedMemorySegment
+{
+    char Name[SHARED_MEMORY_NAME_LENGTH];
+
+    // The Page Frames of the segment
+    unsigned long PageFrames[SHARED_MEMORY_MAX_PAGES];
+    int PageCount;
+
+    // The number of process handles to the segment.
+    // The Page Frames are released, and the name can be reused, when the last handle is released.
+    int ReferenceCount;
+
+    // 1 after the first mapping has zero-initialized the Page Frames
+    int Initialized;
+} SharedMemorySegment;
+
+// Represents the handle of a process to a Shared Memory Segment
+typedef struct SharedMemoryHandle
+{
+    SharedMemorySegment *Segment;
+    int Status;
+} SharedMemoryHandle;
+
+// Opens the Shared Memory Segment with the given name for the process of the given ThreadGroup, and returns its handle.
+// The segment is created with the given size, if it doesn't exist yet. It returns 0 if the segment couldn't be opened.
+int OpenSharedMemory(struct ThreadGroup *Group, char *Name, unsigned long Size);
+
+// Maps the Shared Memory Segment of the given handle into the current address space, and returns its User Mode address.
+// It returns 0 if the handle is invalid.
+unsigned long MapSharedMemory(struct ThreadGroup *Group, int Handle);
+
+// Unmaps the Shared Memory Segment of the given handle from the current address space, and closes the handle.
+// It returns 0 if the handle is invalid.
+int UnmapSharedMemory(struct ThreadGroup *Group, int Handle);
+
+// Releases all Shared Memory handles of a terminated process
+void ReleaseSharedMemory(struct ThreadGroup *Group);
+
+// Returns the Shared Memory Segment with the given name, or 0x0 if it doesn't exist
+static SharedMemorySegment *FindSharedMemorySegment(char *Name);
+
+// Creates a new Shared Memory Segment with the given name and number of pages, or returns 0x0 if it couldn't be created
+static SharedMemorySegment *CreateSharedMemorySegment(char *Name, int PageCount);
+
+// Releases a reference to the given Shared Memory Segment
+static void ReleaseSharedMemorySegment(SharedMemorySegment *Segment);
+
+// Returns the User Mode address, at which the given handle maps its Shared Memory Segment
+static unsigned long GetSharedMemoryAddress(int Handle);
+
+#endif
\ No newline at end of file
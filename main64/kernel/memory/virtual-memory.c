@@ -3,6 +3,7 @@
 #include "heap.h"
 #include "../drivers/screen.h"
 #include "../common.h"
+#include "../multitasking/spinlock.h"
 
 // This flag controls if the Page Fault Handler outputs debug information.
 int debugEnabled = 0;
@@ -10,6 +11,12 @@ int debugEnabled = 0;
 // The physical address of the PML4 table
 unsigned long pml4Address = 0x0;
 
+// The Paging Tables of the Kernel are shared by all processors
+Spinlock pageTablesLock = SPINLOCK_INITIALIZER("PageTables");
+
+// Serializes the usage of the temporary virtual page
+Spinlock temporaryPageLock = SPINLOCK_INITIALIZER("TemporaryPage");
+
 // Initializes the necessary data structures for the 4-level x64 paging.
 // The first 2 MB of physical RAM (0x000000 - 0x1FFFFF) are Identity Mapped to 0x000000 - 0x1FFFFF.
 // In addition this memory range is also mapped to the virtual address range 0xFFFF800000000000 - 0xFFFF8000001FFFFF,
@@ -157,6 +164,9 @@ void HandlePageFault(unsigned long VirtualAddress)
     char str[32] = "";
     int color = COLOR_WHITE;
 
+    // Another processor can resolve a Page Fault of the same Paging Tables at the same time
+    unsigned long flags = AcquireSpinlockIrqSave(&pageTablesLock);
+
     if (debugEnabled)
     {
         // Set the screen text color to Green
@@ -227,6 +237,8 @@ void HandlePageFault(unsigned long VirtualAddress)
         printf("\n");
         SetColor(color);
     }
+
+    ReleaseSpinlockIrqRestore(&pageTablesLock, flags);
 }
 
 // Maps a Virtual Memory Address to a Physical Memory Address
@@ -238,6 +250,7 @@ void MapVirtualAddressToPhysicalAddress(unsigned long VirtualAddress, unsigned l
     PageDirectoryTable *pd = (PageDirectoryTable *)PD_TABLE(VirtualAddress);
     PageTable *pt = (PageTable *)PT_TABLE(VirtualAddress);
     int color = COLOR_WHITE;
+    unsigned long flags = AcquireSpinlockIrqSave(&pageTablesLock);
 
     if (debugEnabled)
     {
@@ -303,6 +316,28 @@ void MapVirtualAddressToPhysicalAddress(unsigned long VirtualAddress, unsigned l
         printf("\n");
         SetColor(color);
     }
+
+    // Flush the TLB entry of the Virtual Memory Address, because it could still cache a previous mapping
+    asm volatile("invlpg (%0)" :: "r"(VirtualAddress) : "memory");
+
+    ReleaseSpinlockIrqRestore(&pageTablesLock, flags);
+}
+
+// Removes the write access to the given (mapped) Virtual Memory Address.
+// The Write Protect bit of the CR0 register is set, therefore the page is also read-only for the Kernel.
+void ProtectVirtualAddress(unsigned long VirtualAddress)
+{
+    // Get references to the various Page Tables through the Recursive Page Table Mapping
+    PageTable *pt = (PageTable *)PT_TABLE(VirtualAddress);
+    unsigned long flags = AcquireSpinlockIrqSave(&pageTablesLock);
+
+    if (pt->Entries[PT_INDEX(VirtualAddress)].Present == 1)
+        pt->Entries[PT_INDEX(VirtualAddress)].ReadWrite = 0;
+
+    // Flush the TLB entry of the Virtual Memory Address, because it still caches the write access
+    asm volatile("invlpg (%0)" :: "r"(VirtualAddress) : "memory");
+
+    ReleaseSpinlockIrqRestore(&pageTablesLock, flags);
 }
 
 // Unmaps the given Virtual Memory Address
@@ -310,6 +345,7 @@ void UnmapVirtualAddress(unsigned long VirtualAddress)
 {
     // Get references to the various Page Tables through the Recursive Page Table Mapping
     PageTable *pt = (PageTable *)PT_TABLE(VirtualAddress);
+    unsigned long flags = AcquireSpinlockIrqSave(&pageTablesLock);
 
     if (pt->Entries[PT_INDEX(VirtualAddress)].Present == 1)
     {
@@ -318,7 +354,53 @@ void UnmapVirtualAddress(unsigned long VirtualAddress)
         pt->Entries[PT_INDEX(VirtualAddress)].Present = 0;
         pt->Entries[PT_INDEX(VirtualAddress)].ReadWrite = 0;
         pt->Entries[PT_INDEX(VirtualAddress)].User = 0;
+
+        // Flush the TLB entry of the Virtual Memory Address, because it still caches the removed mapping
+        asm volatile("invlpg (%0)" :: "r"(VirtualAddress) : "memory");
+    }
+
+    ReleaseSpinlockIrqRestore(&pageTablesLock, flags);
+}
+
+// Returns the Physical Memory Address of the given Virtual Memory Address in the current address space, or 0 if it isn't mapped.
+// The Page Tables are only accessed through the Recursive Page Table Mapping when their parent entries are present,
+// so that the lookup itself never raises a Page Fault.
+unsigned long GetPhysicalAddress(unsigned long VirtualAddress)
+{
+    PageMapLevel4Table *pml4 = (PageMapLevel4Table *)PML4_TABLE;
+    PageDirectoryPointerTable *pdp = (PageDirectoryPointerTable *)PDP_TABLE(VirtualAddress);
+    PageDirectoryTable *pd = (PageDirectoryTable *)PD_TABLE(VirtualAddress);
+    PageTable *pt = (PageTable *)PT_TABLE(VirtualAddress);
+    unsigned long physicalAddress = 0;
+    unsigned long flags = AcquireSpinlockIrqSave(&pageTablesLock);
+
+    if ((pml4->Entries[PML4_INDEX(VirtualAddress)].Present == 1) &&
+        (pdp->Entries[PDP_INDEX(VirtualAddress)].Present == 1) &&
+        (pd->Entries[PD_INDEX(VirtualAddress)].Present == 1) &&
+        (pt->Entries[PT_INDEX(VirtualAddress)].Present == 1))
+    {
+        physicalAddress = (pt->Entries[PT_INDEX(VirtualAddress)].Frame * SMALL_PAGE_SIZE) + (VirtualAddress & (SMALL_PAGE_SIZE - 1));
     }
+
+    ReleaseSpinlockIrqRestore(&pageTablesLock, flags);
+
+    return physicalAddress;
+}
+
+// Maps a Memory Mapped I/O page uncached to the given Virtual Memory Address
+void MapMemoryMappedIO(unsigned long VirtualAddress, unsigned long PhysicalAddress)
+{
+    // Install the Virtual Memory Mapping
+    MapVirtualAddressToPhysicalAddress(VirtualAddress, PhysicalAddress);
+
+    // Device registers must never be cached by the CPU, and must not be accessible from User Mode
+    PageTable *pt = (PageTable *)PT_TABLE(VirtualAddress);
+    pt->Entries[PT_INDEX(VirtualAddress)].WriteThrough = 1;
+    pt->Entries[PT_INDEX(VirtualAddress)].CacheDisable = 1;
+    pt->Entries[PT_INDEX(VirtualAddress)].User = 0;
+
+    // Flush the TLB entry of the Virtual Memory Address
+    asm volatile("invlpg (%0)" :: "r"(VirtualAddress) : "memory");
 }
 
 // Clones the PML4 table of the Kernel Mode and returns the physical address of the PML4 table clone
@@ -343,6 +425,9 @@ unsigned long ClonePML4Table()
 {
     // Allocate a new Page Frame for the PML4 table clone
     unsigned long pfn = AllocatePageFrame();
+
+    // The temporary virtual page can only be used by one processor at a time
+    unsigned long flags = AcquireSpinlockIrqSave(&temporaryPageLock);
   
     // Map the newly allocated physical page frame to a temporary virtual memory address
     MapVirtualAddressToPhysicalAddress(TEMPORARY_VIRTUAL_PAGE, pfn * SMALL_PAGE_SIZE);
@@ -358,6 +443,8 @@ unsigned long ClonePML4Table()
     // Release the temporary virtual memory address mapping
     UnmapVirtualAddress(TEMPORARY_VIRTUAL_PAGE);
 
+    ReleaseSpinlockIrqRestore(&temporaryPageLock, flags);
+
     // Return the physical address of the PML4 table clone
     return pfn * SMALL_PAGE_SIZE;
 }
@@ -183,6 +183,15 @@ void MapVirtualAddressToPhysicalAddress(unsigned long VirtualAddress, unsigned l
 // Unmaps the given Virtual Memory Address
 void UnmapVirtualAddress(unsigned long VirtualAddress);
 
+// Removes the write access to the given (mapped) Virtual Memory Address
+void ProtectVirtualAddress(unsigned long VirtualAddress);
+
+// Returns the Physical Memory Address of the given Virtual Memory Address in the current address space, or 0 if it isn't mapped
+unsigned long GetPhysicalAddress(unsigned long VirtualAddress);
+
+// Maps a Memory Mapped I/O page uncached to the given Virtual Memory Address
+void MapMemoryMappedIO(unsigned long VirtualAddress, unsigned long PhysicalAddress);
+
 // Clones the PML4 table of the Kernel Mode and returns the physical address of the PML4 table clone
 unsigned long ClonePML4Table();
 
@@ -1,7 +1,40 @@
 [BITS 64]
 [GLOBAL Irq0_ContextSwitching]
+[GLOBAL SwitchToNextTask]
 [GLOBAL GetTaskState]
 [EXTERN MoveToNextTask]
+[EXTERN GetSchedulerStack]
+
+; Virtual address of the End Of Interrupt register of the Local APIC
+APIC_EOI_REGISTER   EQU 0xFFFF8000FEE000B0
+
+; The Code Segment Selector of the Kernel
+KERNEL_CODE_SEGMENT EQU 0x8
+
+; How a switched out Task is continued (the same constants are defined in the file "multitasking.h")
+TASK_RESUME_IRETQ   EQU 0
+TASK_RESUME_SWITCH  EQU 1
+
+; The size of an IRQ Stack Frame (SS, RSP, RFLAGS, CS, RIP)
+IRQ_STACK_FRAME_SIZE EQU 40
+
+; ===================================================================================
+; The following constants defines the offsets into the per-CPU data area (C structure
+; "Cpu"), which is reached through the GS base of the processor
+; ===================================================================================
+%DEFINE PerCpu_CurrentTask      8
+%DEFINE PerCpu_InterruptCount   32
+
+; Executes SWAPGS, when the interrupted code (or the code that we return to) executes in User Mode.
+; In Kernel Mode the GS base points to the per-CPU data area of the processor, and in User Mode the per-CPU data
+; area is parked in the MSR IA32_KERNEL_GS_BASE. The parameter is the offset of the saved CS register from RSP.
+; (the same macro is defined in the files "idt.asm", "irq.asm", "syscall.asm" and "contextswitching.asm")
+%MACRO SWAPGS_IF_USERMODE 1
+    TEST    QWORD [RSP + %1], 0x3
+    JZ      %%KernelMode
+    SWAPGS
+%%KernelMode:
+%ENDMACRO
 
 ; =======================================================================
 ; The following constants defines the offsets into the C structure "Task"
@@ -40,6 +73,10 @@
 ; Control Registers
 %DEFINE TaskState_CR3       192
 
+; The state of a voluntary Context Switch
+%DEFINE TaskState_SwitchRSP     200
+%DEFINE TaskState_ResumeMode    208
+
 ; ============================================================================
 ; The following constants defines the offsets into the IRQ Stack Frame Layout
 ; IRQ STACK FRAME LAYOUT (based on the current RSP):
@@ -56,18 +93,32 @@
 %DEFINE StackFrame_RSP      24
 %DEFINE StackFrame_SS       32
 
-; This function is called as soon as the Timer Interrupt is raised
+; This function is called as soon as the Local APIC Timer Interrupt is raised.
+; The Local APIC Timer runs in the One-Shot mode, and "MoveToNextTask" programs the next interrupt.
 ; 
-; NOTE: We don't need to disable/enable the interrupts explicitly, because the IRQ0 is an Interrupt Gate,
+; NOTE: We don't need to disable/enable the interrupts explicitly, because the Timer Interrupt is an Interrupt Gate,
 ; where the interrupts are disabled/enabled automatically by the CPU!
 Irq0_ContextSwitching:
+    SWAPGS_IF_USERMODE StackFrame_CS
+    INC     QWORD [GS:PerCpu_InterruptCount]
+
+    ; Send the End Of Interrupt signal to the Local APIC.
+    ; The interrupts stay disabled until the IRETQ instruction, therefore the next timer interrupt can't nest.
+    PUSH    RAX
+    MOV     RAX, APIC_EOI_REGISTER
+    MOV     DWORD [RAX], 0
+    POP     RAX
+
+; Performs the Context Switch to the next Task.
+; The current RSP must point to an IRQ Stack Frame on the Scheduler Stack of the processor.
+ContextSwitch:
     ; Save RDI on the Stack, so that we can store it later in the Task structure
     PUSH    RDI
 
     ; The first initial code execution path (entry point of KERNEL.BIN) that was started by KLDR64.BIN,
-    ; has no Task structure assigned in register R15.
-    ; Therefore we only save the current Task State if we have a Task structure assigned in R15.
-    MOV     RDI, R15
+    ; has no Task structure assigned in the per-CPU data area.
+    ; Therefore we only save the current Task State if we have a current Task.
+    MOV     RDI, [GS:PerCpu_CurrentTask]
     CMP     RDI, 0x0
     JE      NoTaskStateSaveNecessary
     
@@ -136,13 +187,27 @@ NoTaskStateSaveNecessary:
     POP     RAX
 
 Continue:
-    ; Move to the next Task to be executed
+    ; Move to the next Task to be executed.
+    ; The register RDI contains the current Task (or 0x0), which is the 1st parameter of "MoveToNextTask".
     CALL    MoveToNextTask
 
     ; Store the pointer to the current Task in the register RDI.
     ; It was returned in the register RAX from the previous function call.
     MOV     RDI, RAX
-    
+
+    ; Restore the Control Registers.
+    ; Writing to CR3 flushes the TLB, therefore CR3 is only reloaded when the next Task uses another address space.
+    MOV     RAX, [RDI + TaskState_CR3]
+    MOV     RBX, CR3
+    CMP     RAX, RBX
+    JE      NoAddressSpaceSwitchNecessary
+    MOV     CR3, RAX
+
+NoAddressSpaceSwitchNecessary:
+    ; A Task that has given up the CPU through "SwitchToNextTask" continues on its own Kernel Mode Stack
+    CMP     QWORD [RDI + TaskState_ResumeMode], TASK_RESUME_SWITCH
+    JE      ResumeSwitchedTask
+
     ; Restore the general purpose registers of the next Task to be executed
     MOV     RBX, [RDI + TaskState_RBX]
     MOV     RCX, [RDI + TaskState_RCX]
@@ -158,10 +223,6 @@ Continue:
     MOV     R14, [RDI + TaskState_R14]
     MOV     R15, [RDI + TaskState_R15]
 
-    ; Restore the Control Registers
-    MOV     RAX, [RDI + TaskState_CR3]
-    MOV     CR3, RAX
-
     ; IRQ STACK FRAME LAYOUT (based on the current RSP)
     ; ==================================================
     ; Return SS:        +32
@@ -193,24 +254,68 @@ Continue:
     ; Restore the register RAX register of the next Task
     MOV     RAX, [RDI + TaskState_RAX]
 
-    ; Restore the remaining Segment Registers
+    ; Restore the remaining Segment Registers.
+    ; FS and GS are not reloaded, because loading a selector would also overwrite the base address of the segment
+    ; (the GS base points to the per-CPU data area).
     MOV     DS, [RDI + TaskState_DS]
     MOV     ES, [RDI + TaskState_ES]
-    MOV     FS, [RDI + TaskState_FS]
-    MOV     GS, [RDI + TaskState_GS]
-
-    ; Send the reset signal to the master PIC...
-    PUSH    RAX
-    MOV     AL, 0x20
-    OUT     0x20, AL
-    POP     RAX
+    SWAPGS_IF_USERMODE StackFrame_CS
 
     ; Return from the Interrupt Handler
     ; Because we have patched the Stack Frame of the Interrupt Handler, we continue with the execution of 
     ; the next Task - based on the restored register RIP on the Stack...
     IRETQ
 
+; Continues a Task that has given up the CPU through "SwitchToNextTask".
+; Its callee-saved registers and RFLAGS are stored on its Kernel Mode Stack, and it returns from "SwitchToNextTask".
+ResumeSwitchedTask:
+    MOV     QWORD [RDI + TaskState_ResumeMode], TASK_RESUME_IRETQ
+    MOV     RSP, [RDI + TaskState_SwitchRSP]
+
+    POP     R15
+    POP     R14
+    POP     R13
+    POP     R12
+    POP     RBP
+    POP     RBX
+    POPFQ
+    RET
+
+; Gives up the CPU voluntarily, and continues with the next Task.
+; Only the callee-saved registers and RFLAGS are saved on the Kernel Mode Stack of the current Task, because the
+; caller expects the other registers to be clobbered by a function call. The segment registers and the IRQ Stack Frame
+; are not touched, so this path is much cheaper than the Context Switch through an interrupt.
+SwitchToNextTask:
+    PUSHFQ
+    CLI
+    PUSH    RBX
+    PUSH    RBP
+    PUSH    R12
+    PUSH    R13
+    PUSH    R14
+    PUSH    R15
+
+    ; Save the Stack Pointer of the current Task.
+    ; The Task executes in Kernel Mode, and can be in another address space (like during loading a program).
+    MOV     RDI, [GS:PerCpu_CurrentTask]
+    MOV     [RDI + TaskState_SwitchRSP], RSP
+    MOV     QWORD [RDI + TaskState_ResumeMode], TASK_RESUME_SWITCH
+    MOV     QWORD [RDI + TaskState_CS], KERNEL_CODE_SEGMENT
+    MOV     RAX, CR3
+    MOV     [RDI + TaskState_CR3], RAX
+
+    ; Continue on the Scheduler Stack of the processor, because another processor can continue the current Task
+    ; as soon as "MoveToNextTask" has released it. The space of an IRQ Stack Frame is reserved at the top of the
+    ; Scheduler Stack, so that a preempted next Task is continued through IRETQ - like from the Timer Interrupt.
+    CALL    GetSchedulerStack
+    MOV     RSP, RAX
+    SUB     RSP, IRQ_STACK_FRAME_SIZE
+
+    ; The register RDI contains the current Task, which is the 1st parameter of "MoveToNextTask"
+    MOV     RDI, [GS:PerCpu_CurrentTask]
+    JMP     Continue
+
 ; This function returns a pointer to the Task structure of the current executing Task
 GetTaskState:
-    MOV     RAX, R15
+    MOV     RAX, [GS:PerCpu_CurrentTask]
     RET
\ No newline at end of file
@@ -0,0 +1,163 @@
+#include "fpu.h"
+#include "../common.h"
+#include "../memory/heap.h"
+
+// The size of the FPU state of a Task, and the instruction that saves it.
+// Every processor has the same features, so they are set by each processor to the same values.
+int fpuStateSize = FXSAVE_AREA_SIZE;
+int fpuSaveMode = FPU_SAVE_FXSAVE;
+
+// Enables the FPU, SSE and (when available) XSAVE and AVX on the current processor.
+// The TS flag is set, so that the first FPU/SSE instruction of a Task raises a Device Not Available Exception.
+// The Kernel itself is compiled without FPU/SSE instructions, therefore only User Mode Tasks are using the FPU.
+void InitFpu()
+{
+    unsigned int eax, ebx, ecx, edx;
+    unsigned int xsaveFeatures;
+
+    cpuid(1, &eax, &ebx, &ecx, &edx);
+
+    WriteCr0((ReadCr0() & ~CR0_EM) | CR0_MP | CR0_NE | CR0_TS);
+
+    if (ecx & CPUID_FEATURE_XSAVE)
+    {
+        unsigned long xcr0 = XSTATE_X87 | XSTATE_SSE;
+
+        if (ecx & CPUID_FEATURE_AVX)
+            xcr0 |= XSTATE_AVX;
+
+        WriteCr4(ReadCr4() | CR4_OSFXSR | CR4_OSXMMEXCPT | CR4_OSXSAVE);
+        asm volatile("xsetbv" : : "c" (0), "a" ((unsigned int)xcr0), "d" ((unsigned int)(xcr0 >> 32)));
+
+        // EBX returns the size of the XSAVE area for the state components that are enabled in XCR0
+        cpuidex(CPUID_LEAF_XSAVE, 0, &eax, &ebx, &ecx, &edx);
+        fpuStateSize = ebx;
+
+        // XSAVEOPT skips the state components that were not modified since they were restored
+        cpuidex(CPUID_LEAF_XSAVE, 1, &xsaveFeatures, &ebx, &ecx, &edx);
+        fpuSaveMode = (xsaveFeatures & CPUID_XSAVE_XSAVEOPT) ? FPU_SAVE_XSAVEOPT : FPU_SAVE_XSAVE;
+    }
+    else
+    {
+        WriteCr4(ReadCr4() | CR4_OSFXSR | CR4_OSXMMEXCPT);
+        fpuStateSize = FXSAVE_AREA_SIZE;
+        fpuSaveMode = FPU_SAVE_FXSAVE;
+    }
+}
+
+// Handles the Device Not Available Exception (#NM), which is raised by the first FPU/SSE instruction of a Task.
+// The FPU state is only loaded, when the FPU registers of this processor don't hold it already.
+// A Task that never uses the FPU doesn't get a FPU state, and its Context Switches don't touch the FPU.
+void HandleDeviceNotAvailable()
+{
+    Cpu *cpu = GetCurrentCpu();
+    Task *task = GetTaskState();
+    int restore = (cpu->FpuOwner != task) || (task->FpuCpu != cpu->Index);
+
+    asm volatile("clts");
+
+    if (task->FpuState == 0x0)
+    {
+        AllocateFpuState(task);
+        restore = 1;
+    }
+
+    if (restore)
+        RestoreFpuState(task->FpuState);
+
+    cpu->FpuOwner = task;
+    cpu->FpuActive = 1;
+    task->FpuCpu = cpu->Index;
+}
+
+// Saves the FPU state of the given Task (the current one), when it has used the FPU since it was switched in.
+// The state is saved eagerly, because the Task can be continued afterwards by another processor.
+// The FPU registers still hold the state, so the Task doesn't need to load it again, when it continues on this processor.
+void FpuContextSwitchOut(Cpu *Cpu, Task *Task)
+{
+    if (Cpu->FpuActive == 0)
+        return;
+
+    if (Task->Status == TASK_STATUS_TERMINATED)
+        Cpu->FpuOwner = 0x0;
+    else
+        SaveFpuState(Task->FpuState);
+
+    Cpu->FpuActive = 0;
+    WriteCr0(ReadCr0() | CR0_TS);
+}
+
+// Releases the FPU state of a terminated Task
+void ReleaseFpuState(Task *Task)
+{
+    if (Task->FpuStateAllocation != 0x0)
+        free(Task->FpuStateAllocation);
+
+    Task->FpuState = 0x0;
+    Task->FpuStateAllocation = 0x0;
+}
+
+// Allocates the aligned FPU state of the given Task, and initializes it with the default state.
+// The XSAVE header is zeroed, therefore XRSTOR initializes all state components except the MXCSR register.
+static void AllocateFpuState(Task *Task)
+{
+    unsigned char *allocation = (unsigned char *)malloc(fpuStateSize + FPU_STATE_ALIGNMENT);
+    unsigned char *state = (unsigned char *)(((unsigned long)allocation + FPU_STATE_ALIGNMENT - 1) & ~(unsigned long)(FPU_STATE_ALIGNMENT - 1));
+
+    memset(state, 0, fpuStateSize);
+    *(unsigned short *)state = FPU_DEFAULT_CONTROL_WORD;
+    *(unsigned int *)(state + FXSAVE_MXCSR_OFFSET) = FPU_DEFAULT_MXCSR;
+
+    Task->FpuStateAllocation = allocation;
+    Task->FpuState = state;
+}
+
+// Saves the FPU registers into the given state area
+static void SaveFpuState(void *State)
+{
+    if (fpuSaveMode == FPU_SAVE_XSAVEOPT)
+        asm volatile("xsaveopt64 (%0)" : : "r" (State), "a" (0xFFFFFFFF), "d" (0xFFFFFFFF) : "memory");
+    else if (fpuSaveMode == FPU_SAVE_XSAVE)
+        asm volatile("xsave64 (%0)" : : "r" (State), "a" (0xFFFFFFFF), "d" (0xFFFFFFFF) : "memory");
+    else
+        asm volatile("fxsave64 (%0)" : : "r" (State) : "memory");
+}
+
+// Loads the FPU registers from the given state area
+static void RestoreFpuState(void *State)
+{
+    if (fpuSaveMode == FPU_SAVE_FXSAVE)
+        asm volatile("fxrstor64 (%0)" : : "r" (State) : "memory");
+    else
+        asm volatile("xrstor64 (%0)" : : "r" (State), "a" (0xFFFFFFFF), "d" (0xFFFFFFFF) : "memory");
+}
+
+// Reads the CR0 register
+static unsigned long ReadCr0()
+{
+    unsigned long value;
+    asm volatile("mov %%cr0, %0" : "=r" (value));
+
+    return value;
+}
+
+// Writes the CR0 register
+static void WriteCr0(unsigned long Value)
+{
+    asm volatile("mov %0, %%cr0" : : "r" (Value) : "memory");
+}
+
+// Reads the CR4 register
+static unsigned long ReadCr4()
+{
+    unsigned long value;
+    asm volatile("mov %%cr4, %0" : "=r" (value));
+
+    return value;
+}
+
+// Writes the CR4 register
+static void WriteCr4(unsigned long Value)
+{
+    asm volatile("mov %0, %%cr4" : : "r" (Value) : "memory");
+}
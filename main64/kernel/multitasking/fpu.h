@@ -0,0 +1,80 @@
+#ifndef FPU_H
+#define FPU_H
+
+#include "multitasking.h"
+#include "smp.h"
+
+// The bits of the CR0 register that are controlling the FPU
+#define CR0_MP                      (1 << 1)    // Monitor Coprocessor: WAIT/FWAIT also raise #NM when TS is set
+#define CR0_EM                      (1 << 2)    // Emulation: every FPU/SSE instruction raises #NM (or #UD)
+#define CR0_TS                      (1 << 3)    // Task Switched: the next FPU/SSE instruction raises #NM
+#define CR0_NE                      (1 << 5)    // Numeric Error: x87 errors are reported through #MF
+
+// The bits of the CR4 register that are enabling SSE and XSAVE
+#define CR4_OSFXSR                  (1 << 9)
+#define CR4_OSXMMEXCPT              (1 << 10)
+#define CR4_OSXSAVE                 (1 << 18)
+
+// The feature flags in ECX of the CPUID leaf 1
+#define CPUID_FEATURE_XSAVE         (1 << 26)
+#define CPUID_FEATURE_AVX           (1 << 28)
+
+// The XSAVE features in EAX of the CPUID leaf 0xD (sub-leaf 1)
+#define CPUID_XSAVE_XSAVEOPT        (1 << 0)
+
+// The CPUID leaf that describes the XSAVE state components
+#define CPUID_LEAF_XSAVE            0xD
+
+// The state components that are enabled in the XCR0 register
+#define XSTATE_X87                  0x1
+#define XSTATE_SSE                  0x2
+#define XSTATE_AVX                  0x4
+
+// The size of the legacy FXSAVE area, and the alignment of the XSAVE area
+#define FXSAVE_AREA_SIZE            512
+#define FPU_STATE_ALIGNMENT         64
+
+// The initial FPU state of a Task: all x87 and SSE exceptions are masked
+#define FPU_DEFAULT_CONTROL_WORD    0x037F
+#define FPU_DEFAULT_MXCSR           0x1F80
+#define FXSAVE_MXCSR_OFFSET         24
+
+// The instructions that are used to save the FPU state
+#define FPU_SAVE_FXSAVE             0
+#define FPU_SAVE_XSAVE              1
+#define FPU_SAVE_XSAVEOPT           2
+
+// Enables the FPU, SSE and (when available) XSAVE and AVX on the current processor
+void InitFpu();
+
+// Handles the Device Not Available Exception (#NM), which is raised by the first FPU/SSE instruction of a Task
+void HandleDeviceNotAvailable();
+
+// Saves the FPU state of the given Task (the current one), when it has used the FPU since it was switched in
+void FpuContextSwitchOut(Cpu *Cpu, Task *Task);
+
+// Releases the FPU state of a terminated Task
+void ReleaseFpuState(Task *Task);
+
+// Allocates the aligned FPU state of the given Task, and initializes it with the default state
+static void AllocateFpuState(Task *Task);
+
+// Saves the FPU registers into the given state area
+static void SaveFpuState(void *State);
+
+// Loads the FPU registers from the given state area
+static void RestoreFpuState(void *State);
+
+// Reads the CR0 register
+static unsigned long ReadCr0();
+
+// Writes the CR0 register
+static void WriteCr0(unsigned long Value);
+
+// Reads the CR4 register
+static unsigned long ReadCr4();
+
+// Writes the CR4 register
+static void WriteCr4(unsigned long Value);
+
+#endif
@@ -0,0 +1,84 @@
+#include "futex.h"
+#include "../memory/virtual-memory.h"
+#include "../syscalls/usercopy.h"
+
+// The hash table of the futexes.
+// The Tasks that are waiting on futexes with the same hash are sharing a Wait Queue, and every Wait Queue entry
+// remembers the key of its futex, so that a wakeup only reaches the Tasks of the right futex.
+WaitQueue futexWaitQueues[FUTEX_HASH_BUCKETS] =
+{
+    [0 ... FUTEX_HASH_BUCKETS - 1] = WAIT_QUEUE_INITIALIZER("Futex")
+};
+
+// Blocks the current Task, as long as the 32 bit futex word at the given User Mode address contains the expected value.
+// It returns 1 after the Task was woken up, and 0 when the futex word contains another value or the address is invalid.
+// The caller must not hold the Kernel Lock or any Spinlock, because the Task blocks.
+int FutexWait(unsigned int *Address, unsigned int ExpectedValue)
+{
+    unsigned long key = GetFutexKey(Address);
+    WaitQueueEntry entry;
+    WaitQueue *queue;
+    unsigned long flags;
+    unsigned int value;
+
+    if (key == 0)
+        return 0;
+
+    queue = GetFutexWaitQueue(key);
+    flags = AcquireSpinlockIrqSave(&queue->Lock);
+
+    // The futex word is checked under the lock of the hash bucket, which is also taken by "FutexWake".
+    // Therefore a wakeup between the check and the blocking of the Task can't get lost.
+    // The futex word is read through the fixup routine, because another thread can unmap it in the meantime.
+    if ((get_user(&value, Address) != 0) || (value != ExpectedValue))
+    {
+        ReleaseSpinlockIrqRestore(&queue->Lock, flags);
+        return 0;
+    }
+
+    SleepOnWaitQueueWithKey(queue, &entry, key);
+    ReleaseSpinlockIrqRestore(&queue->Lock, flags);
+
+    return 1;
+}
+
+// Wakes up the given number of Tasks that are waiting on the futex word at the given User Mode address.
+// It returns the number of woken up Tasks.
+int FutexWake(unsigned int *Address, int Count)
+{
+    unsigned long key = GetFutexKey(Address);
+    WaitQueue *queue;
+    unsigned long flags;
+    int count;
+
+    if ((key == 0) || (Count <= 0))
+        return 0;
+
+    queue = GetFutexWaitQueue(key);
+    flags = AcquireSpinlockIrqSave(&queue->Lock);
+    count = WakeUpWaitersWithKey(queue, key, Count);
+    ReleaseSpinlockIrqRestore(&queue->Lock, flags);
+
+    return count;
+}
+
+// Returns the key of the futex word at the given User Mode address, or 0 if the address is invalid.
+// The key is the physical address of the futex word, so the threads of a process (and processes that are sharing
+// memory) are finding the same futex. The futex word must be aligned, and its page must be mapped - the caller
+// has just accessed the futex word in User Mode.
+static unsigned long GetFutexKey(unsigned int *Address)
+{
+    unsigned long address = (unsigned long)Address;
+
+    if ((address >= FUTEX_USERMODE_LIMIT) || ((address & (sizeof(unsigned int) - 1)) != 0))
+        return 0;
+
+    return GetPhysicalAddress(address);
+}
+
+// Returns the Wait Queue of the hash bucket of the given futex key
+static WaitQueue *GetFutexWaitQueue(unsigned long Key)
+{
+    // The lower 2 bits of the key are always 0, because the futex words are aligned
+    return &futexWaitQueues[(Key >> 2) & FUTEX_HASH_MASK];
+}
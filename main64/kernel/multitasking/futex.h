@@ -0,0 +1,27 @@
+#ifndef FUTEX_H
+#define FUTEX_H
+
+#include "waitqueue.h"
+
+// The number of buckets of the futex hash table (must be a power of 2)
+#define FUTEX_HASH_BUCKETS      64
+#define FUTEX_HASH_MASK         (FUTEX_HASH_BUCKETS - 1)
+
+// A futex word must be located below this address (in the User Mode part of the address space)
+#define FUTEX_USERMODE_LIMIT    0x0000800000000000
+
+// Blocks the current Task, as long as the 32 bit futex word at the given User Mode address contains the expected value.
+// It returns 1 after the Task was woken up, and 0 when the futex word contains another value or the address is invalid.
+int FutexWait(unsigned int *Address, unsigned int ExpectedValue);
+
+// Wakes up the given number of Tasks that are waiting on the futex word at the given User Mode address.
+// It returns the number of woken up Tasks.
+int FutexWake(unsigned int *Address, int Count);
+
+// Returns the key of the futex word at the given User Mode address, or 0 if the address is invalid
+static unsigned long GetFutexKey(unsigned int *Address);
+
+// Returns the Wait Queue of the hash bucket of the given futex key
+static WaitQueue *GetFutexWaitQueue(unsigned long Key);
+
+#endif
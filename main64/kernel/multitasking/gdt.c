@@ -2,58 +2,58 @@
 #include "../common.h"
 #include "../memory/heap.h"
 
-// The needed GDT and TSS structures
-GdtPointer gdtPointer;
-GdtEntry *gdtEntries = (GdtEntry *)GDT_START_OFFSET;
-TssEntry *tssEntry = (TssEntry *)TSS_START_OFFSET;
-
-// Installs the various need GDT entries
-void InitGdt()
+// Installs the various need GDT entries of the given processor
+void InitGdt(int CpuIndex)
 {
+    GdtPointer gdtPointer;
+    GdtEntry *gdtEntries = (GdtEntry *)(GDT_START_OFFSET + CpuIndex * GDT_SIZE_PER_CPU);
+    TssEntry *tssEntry = GetTss(CpuIndex);
+
     // Initialize the GDT
     gdtPointer.Limit = sizeof(GdtEntry) * (GDT_ENTRIES + 1);
     gdtPointer.Base = (unsigned long)gdtEntries;
     memset(gdtEntries, 0, sizeof(GdtEntry) * (GDT_ENTRIES + 1));
 
     // Initialize the TSS
-    memset(tssEntry, 0, sizeof(tssEntry));
+    memset(tssEntry, 0, sizeof(TssEntry));
 
     // The NULL Descriptor
-    GdtSetGate(0, 0, 0, 0, 0);
+    GdtSetGate(gdtEntries, 0, 0, 0, 0, 0);
 
     // The Code Segment Descriptor for Ring 0
-    GdtSetGate(1, 0, 0, GDT_FLAG_RING0 | GDT_FLAG_SEGMENT | GDT_FLAG_CODESEG | GDT_FLAG_PRESENT, GDT_FLAG_64_BIT);
+    GdtSetGate(gdtEntries, 1, 0, 0, GDT_FLAG_RING0 | GDT_FLAG_SEGMENT | GDT_FLAG_CODESEG | GDT_FLAG_PRESENT, GDT_FLAG_64_BIT);
 
     // The Data Segment Descriptor for Ring 0
-    GdtSetGate(2, 0, 0, GDT_FLAG_RING0 | GDT_FLAG_SEGMENT | GDT_FLAG_DATASEG | GDT_FLAG_PRESENT, 0);
-
-    // The Code Segment Descriptor for Ring 3
-    GdtSetGate(3, 0, 0, GDT_FLAG_RING3 | GDT_FLAG_SEGMENT | GDT_FLAG_CODESEG | GDT_FLAG_PRESENT, GDT_FLAG_64_BIT);
+    GdtSetGate(gdtEntries, 2, 0, 0, GDT_FLAG_RING0 | GDT_FLAG_SEGMENT | GDT_FLAG_DATASEG | GDT_FLAG_PRESENT, 0);
 
     // The Data Segment Descriptor for Ring 3
-    GdtSetGate(4, 0, 0, GDT_FLAG_RING3 | GDT_FLAG_SEGMENT | GDT_FLAG_DATASEG | GDT_FLAG_PRESENT, 0);
+    GdtSetGate(gdtEntries, 3, 0, 0, GDT_FLAG_RING3 | GDT_FLAG_SEGMENT | GDT_FLAG_DATASEG | GDT_FLAG_PRESENT, 0);
+
+    // The Code Segment Descriptor for Ring 3
+    GdtSetGate(gdtEntries, 4, 0, 0, GDT_FLAG_RING3 | GDT_FLAG_SEGMENT | GDT_FLAG_CODESEG | GDT_FLAG_PRESENT, GDT_FLAG_64_BIT);
 
     // The TSS Entry
-    GdtSetGate(5, (unsigned long)tssEntry, sizeof(TssEntry), 0x89, 0x40);
+    GdtSetGate(gdtEntries, 5, (unsigned long)tssEntry, sizeof(TssEntry), 0x89, 0x40);
 
-    // Install the new GDT
+    // Install the new GDT.
+    // The processor caches the GDT pointer, therefore it can be stored on the Stack.
     GdtFlush((unsigned long)&gdtPointer);
 }
 
-// Returns the TSS entry
-TssEntry *GetTss()
+// Returns the TSS entry of the given processor
+TssEntry *GetTss(int CpuIndex)
 {
-    return tssEntry;
+    return (TssEntry *)(TSS_START_OFFSET + CpuIndex * TSS_SIZE_PER_CPU);
 }
 
 // Sets the GDT entry
-void GdtSetGate(unsigned char Num, unsigned long Base, unsigned long Limit, unsigned char Access, unsigned char Granularity)
+void GdtSetGate(GdtEntry *GdtEntries, unsigned char Num, unsigned long Base, unsigned long Limit, unsigned char Access, unsigned char Granularity)
 {
-    gdtEntries[Num].BaseLow = Base & 0xFFFF;
-    gdtEntries[Num].BaseMiddle = ((Base >> 16) & 0xFF);
-    gdtEntries[Num].BaseHigh = ((Base >> 24) & 0xFF);
-    gdtEntries[Num].LimitLow = Limit & 0xFFFF;
-    gdtEntries[Num].Granularity = ((Limit >> 16) & 0x0F);
-    gdtEntries[Num].Granularity |= (Granularity & 0xF0);
-    gdtEntries[Num].Access = Access;
+    GdtEntries[Num].BaseLow = Base & 0xFFFF;
+    GdtEntries[Num].BaseMiddle = ((Base >> 16) & 0xFF);
+    GdtEntries[Num].BaseHigh = ((Base >> 24) & 0xFF);
+    GdtEntries[Num].LimitLow = Limit & 0xFFFF;
+    GdtEntries[Num].Granularity = ((Limit >> 16) & 0x0F);
+    GdtEntries[Num].Granularity |= (Granularity & 0xF0);
+    GdtEntries[Num].Access = Access;
 }
\ No newline at end of file
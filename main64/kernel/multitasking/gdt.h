@@ -1,9 +1,12 @@
 #ifndef GDT_H
 #define GDT_H
 
-// Virtual address where the GDT and TSS tables are stored
+// Virtual address where the GDT and TSS tables are stored.
+// Every processor has its own GDT and TSS, which are stored one after another.
 #define GDT_START_OFFSET    0xFFFF800000061000
 #define TSS_START_OFFSET    0xFFFF800000062000
+#define GDT_SIZE_PER_CPU    0x40
+#define TSS_SIZE_PER_CPU    0x80
 
 // The number of entries in the GDT
 #define GDT_ENTRIES	6
@@ -25,11 +28,13 @@
 #define GDT_FLAG_32_BIT             0x40
 #define GDT_FLAG_64_BIT             0x20
 
-// The various Segment Selectors for the GDT
+// The various Segment Selectors for the GDT.
+// SYSRET loads the User Mode Data Segment and Code Segment from the selectors that follow the Kernel Data Segment,
+// therefore the User Mode Data Segment comes first.
 #define GDT_KERNEL_CODE_SEGMENT     0x8
 #define GDT_KERNEL_DATA_SEGMENT     0x10
-#define GDT_USER_CODE_SEGMENT       0x18
-#define GDT_USER_DATA_SEGMENT       0x20
+#define GDT_USER_DATA_SEGMENT       0x18
+#define GDT_USER_CODE_SEGMENT       0x20
 
 // The various used RPL levels
 #define RPL_RING0                   0x0
@@ -71,14 +76,14 @@ typedef struct
     int reserved4;
 } __attribute__ ((packed)) TssEntry;
 
-// Initializes the GDT
-void InitGdt();
+// Initializes the GDT and the TSS of the given processor
+void InitGdt(int CpuIndex);
 
-// Returns the TSS Entry
-TssEntry *GetTss();
+// Returns the TSS Entry of the given processor
+TssEntry *GetTss(int CpuIndex);
 
 // Sets the GDT Entry
-void GdtSetGate(unsigned char Num, unsigned long Base, unsigned long Limit, unsigned char Access, unsigned char Granularity);
+void GdtSetGate(GdtEntry *GdtEntries, unsigned char Num, unsigned long Base, unsigned long Limit, unsigned char Access, unsigned char Granularity);
 
 // Loads the GDT table into the processor register (implemented in Assembler)
 extern void GdtFlush(unsigned long);
@@ -0,0 +1,37 @@
+#include "latency.h"
+
+// Records a latency (in nanoseconds) in the given histogram.
+// A histogram is only updated by the processor that dispatches the Task, therefore no atomic operations are needed.
+void RecordLatency(LatencyHistogram *Histogram, unsigned long Nanoseconds)
+{
+    int bucket = 0;
+
+    // The bucket is the index of the highest set bit
+    if (Nanoseconds > 1)
+        bucket = 63 - __builtin_clzl(Nanoseconds);
+
+    if (bucket >= LATENCY_BUCKETS)
+        bucket = LATENCY_BUCKETS - 1;
+
+    Histogram->Buckets[bucket]++;
+    Histogram->Count++;
+    Histogram->Total += Nanoseconds;
+
+    if (Nanoseconds > Histogram->Max)
+        Histogram->Max = Nanoseconds;
+}
+
+// Adds the values of the source histogram to the target histogram
+void MergeLatencyHistogram(LatencyHistogram *Target, LatencyHistogram *Source)
+{
+    int i;
+
+    for (i = 0; i < LATENCY_BUCKETS; i++)
+        Target->Buckets[i] += Source->Buckets[i];
+
+    Target->Count += Source->Count;
+    Target->Total += Source->Total;
+
+    if (Source->Max > Target->Max)
+        Target->Max = Source->Max;
+}
@@ -0,0 +1,32 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+// The number of buckets of a latency histogram.
+// The bucket i counts the latencies from 2^i up to 2^(i+1) - 1 nanoseconds, and the last bucket also counts all longer latencies.
+#define LATENCY_BUCKETS                 32
+
+// The latencies that are recorded by the scheduler:
+// LATENCY_RUNQUEUE: the time between queuing a runnable Task and its dispatch
+// LATENCY_WAKEUP: the time between waking up a blocked Task (like from an Interrupt Handler) and its dispatch
+#define LATENCY_RUNQUEUE                0
+#define LATENCY_WAKEUP                  1
+
+// A log2 histogram of latencies (in nanoseconds).
+// The same structure is defined in the file "libc.h".
+typedef struct LatencyHistogram
+{
+    unsigned long Buckets[LATENCY_BUCKETS];
+
+    // The number of recorded latencies, their sum, and the longest latency
+    unsigned long Count;
+    unsigned long Total;
+    unsigned long Max;
+} LatencyHistogram;
+
+// Records a latency (in nanoseconds) in the given histogram
+void RecordLatency(LatencyHistogram *Histogram, unsigned long Nanoseconds);
+
+// Adds the values of the source histogram to the target histogram
+void MergeLatencyHistogram(LatencyHistogram *Target, LatencyHistogram *Source);
+
+#endif
@@ -1,28 +1,67 @@
 #include "multitasking.h"
 #include "gdt.h"
+#include "smp.h"
+#include "workqueue.h"
+#include "spawnqueue.h"
+#include "fpu.h"
+#include "pid.h"
+#include "realtime.h"
+#include "latency.h"
+#include "thread.h"
 #include "../isr/idt.h"
+#include "../isr/apic.h"
 #include "../common.h"
-#include "../list.h"
 #include "../date.h"
 #include "../memory/heap.h"
 #include "../memory/virtual-memory.h"
 #include "../drivers/screen.h"
 #include "../drivers/keyboard.h"
+#include "../drivers/timer.h"
 #include "../syscalls/syscall.h"
+#include "../syscalls/ioring.h"
+#include "../syscalls/vdso.h"
 #include "../io/fat12.h"
 
-// Stores all Tasks to be executed
-List *TaskList = 0x0;
+// Stores all Tasks to be executed.
+// The TaskList is only used for the bookkeeping, the scheduling is done through the run queues of the processors.
+// The Tasks are chained through their fields "TaskListNext" and "TaskListPrevious", so that a Task is added and
+// removed in O(1).
+Task *taskListHead = 0x0;
+Task *taskListTail = 0x0;
+Spinlock taskListLock = SPINLOCK_INITIALIZER("TaskList");
 
-// This counter stores how often Context Switching was performed, 
-// and drives the system date calculation.
-unsigned long counter = 0;
+// One bit for each Kernel Mode Stack of the User Mode Tasks, which is set while the Kernel Mode Stack is in use
+unsigned long kernelModeStacks[KERNELMODE_STACK_BITMAP_WORDS];
 
-// Creates a new Kernel Mode Task
-Task* CreateKernelModeTask(void *TaskCode, unsigned long PID, unsigned long KernelModeStack)
+// The periodic timer that increments the system date
+Timer systemDateTimer;
+
+// Creates a new Kernel Mode Task.
+// It returns 0, when no PID is available anymore.
+Task* CreateKernelModeTask(void *TaskCode, unsigned long KernelModeStack)
+{
+    unsigned long pid = AllocatePid();
+    Task *newTask;
+
+    if (pid == 0)
+        return 0x0;
+
+    newTask = InitKernelModeTask(TaskCode, pid, KernelModeStack);
+
+    // Add the newly created Kernel Mode Task to the end of the TaskList, and make it runnable
+    AddTaskToTaskList(newTask);
+    AddTaskToRunQueue(newTask);
+
+    // Return a reference to the newly created Kernel Mode Task
+    return newTask;
+}
+
+// Initializes a new Kernel Mode Task structure without adding it to the TaskList
+static Task* InitKernelModeTask(void *TaskCode, unsigned long PID, unsigned long KernelModeStack)
 {
     // Allocate a new Task structure on the Heap
     Task *newTask = (Task *)malloc(sizeof(Task));
+    memset(newTask, 0, sizeof(Task));
     newTask->KernelModeStack = KernelModeStack;
     newTask->PID = PID;
     newTask->Status = TASK_STATUS_CREATED;
@@ -48,7 +87,7 @@ Task* CreateKernelModeTask(void *TaskCode, unsigned long PID, unsigned long Kern
     newTask->R12 = 0x0;
     newTask->R13 = 0x0;
     newTask->R14 = 0x0;
-    newTask->R15 = (unsigned long)newTask; // The address of the Task structure is stored in the R15 register
+    newTask->R15 = 0x0;
 
     // Set the Selectors for Ring 0
     newTask->CS = GDT_KERNEL_CODE_SEGMENT | RPL_RING0;
@@ -69,75 +108,235 @@ Task* CreateKernelModeTask(void *TaskCode, unsigned long PID, unsigned long Kern
     unsigned long *kernelModeStackPtr = (unsigned long *)KernelModeStack - 8;
     kernelModeStackPtr[0] = kernelModeStackPtr[0]; // This read/write operation causes a Page Fault!
 
-    // Add the newly created Kernel Mode Task to the end of the TaskList
-    AddEntryToList(TaskList, newTask, PID);
-
-    // Return a reference to the newly created Kernel Mode Task
     return newTask;
 }
 
-// Loads and executes a User Mode program from the FAT12 file system
-Task* ExecuteUserModeProgram(unsigned char *FileName, unsigned long PID)
+// Creates the Idle Task of the given processor.
+// The Idle Task is not part of the TaskList and of any run queue - a processor executes it when its run queue is empty.
+Task* CreateIdleTask(int CpuIndex)
+{
+    Task *idleTask = InitKernelModeTask(IdleTask, 0, IDLE_TASK_KERNELMODE_STACK - CpuIndex * IDLE_TASK_KERNELMODE_STACK_SIZE);
+    idleTask->Cpu = CpuIndex;
+
+    return idleTask;
+}
+
+// Adds the given Task to the end of the TaskList, and to the PID hash table
+static void AddTaskToTaskList(Task *Task)
+{
+    unsigned long flags = AcquireSpinlockIrqSave(&taskListLock);
+
+    Task->TaskListNext = 0x0;
+    Task->TaskListPrevious = taskListTail;
+
+    if (taskListTail != 0x0)
+        taskListTail->TaskListNext = Task;
+    else
+        taskListHead = Task;
+
+    taskListTail = Task;
+    ReleaseSpinlockIrqRestore(&taskListLock, flags);
+
+    AddTaskToPidTable(Task);
+}
+
+// Removes the given Task from the TaskList, and from the PID hash table
+static void RemoveTaskFromTaskList(Task *Task)
+{
+    unsigned long flags;
+
+    RemoveTaskFromPidTable(Task);
+    flags = AcquireSpinlockIrqSave(&taskListLock);
+
+    if (Task->TaskListPrevious != 0x0)
+        Task->TaskListPrevious->TaskListNext = Task->TaskListNext;
+    else
+        taskListHead = Task->TaskListNext;
+
+    if (Task->TaskListNext != 0x0)
+        Task->TaskListNext->TaskListPrevious = Task->TaskListPrevious;
+    else
+        taskListTail = Task->TaskListPrevious;
+
+    Task->TaskListNext = 0x0;
+    Task->TaskListPrevious = 0x0;
+    ReleaseSpinlockIrqRestore(&taskListLock, flags);
+}
+
+// Loads and executes a User Mode program from the FAT12 file system, and returns the PID of the new Task.
+// It returns 0, when the program was not found, or when no PID or Kernel Mode Stack is available anymore.
+// The PID is returned instead of the Task structure, because the new Task can already be terminated and released
+// on another processor, when this function returns.
+// The new process takes over the given pipe handles as its standard input and output (0 is the console).
+unsigned long ExecuteUserModeProgram(unsigned char *FileName, unsigned long StandardInput, unsigned long StandardOutput)
 {
+    // Every User Mode Task needs its own Kernel Mode Stack, because it can block within a SysCall
+    unsigned long kernelModeStack = AllocateKernelModeStack();
+    unsigned long pml4Clone;
+    unsigned long pid;
+
+    if (kernelModeStack == 0)
+        return 0;
+
+    pid = AllocatePid();
+
+    if (pid == 0)
+    {
+        ReleaseKernelModeStack(kernelModeStack);
+        return 0;
+    }
+
+    // Touch the virtual address of the Kernel Mode Stack (8 bytes below the starting address), so that we can
+    // be sure that the virtual address will get mapped to a physical Page Frame through the Page Fault Handler.
+    // 
+    // NOTE: If we don't do that, and the virtual address is unmapped, the OS will crash during the Context
+    // Switching routine, because a Page Fault would occur (when we prepare the return Stack Frame), which
+    // can'be be handled, because the interrupts are disabled!
+    unsigned long *kernelModeStackPtr = (unsigned long *)kernelModeStack - 8;
+    kernelModeStackPtr[0] = kernelModeStackPtr[0]; // This read/write operation causes a Page Fault!
+
     // Clone the Kernel Mode PML4 table for the new User Mode process
-    unsigned long pml4Clone = ClonePML4Table();
+    pml4Clone = ClonePML4Table();
 
     // Load the given program into the new User Mode Virtual Address Space
-    if (LoadProgramIntoUserModeVirtualAddressSpace(FileName, pml4Clone) == 1)
-    {
-        // Allocate a new Task structure on the Heap
-        Task *newTask = (Task *)malloc(sizeof(Task));
-        newTask->PID = PID;
-        newTask->Status = TASK_STATUS_CREATED;
-        newTask->RIP = EXECUTABLE_BASE_ADDRESS;
-        newTask->KernelModeStack = EXECUTABLE_KERNELMODE_STACK;
-        newTask->UserModeStack = EXECUTABLE_USERMODE_STACK;
-        newTask->CR3 = pml4Clone;
-
-        // The "Interrupt Enable Flag" (Bit 9) must be set
-        newTask->RFLAGS = 0x200;
-
-        // Set the General Purpose Registers
-        newTask->RAX = 0x0;
-        newTask->RBX = 0x0;
-        newTask->RCX = 0x0;
-        newTask->RDX = 0x0;
-        newTask->RBP = EXECUTABLE_USERMODE_STACK;
-        newTask->RSP = EXECUTABLE_USERMODE_STACK;
-        newTask->RSI = 0x0;
-        newTask->RDI = 0x0;
-        newTask->R8 =  0x0;
-        newTask->R9 =  0x0;
-        newTask->R10 = 0x0;
-        newTask->R11 = 0x0;
-        newTask->R12 = 0x0;
-        newTask->R13 = 0x0;
-        newTask->R14 = 0x0;
-        newTask->R15 = (unsigned long)newTask; // The address of the Task structure is stored in the R15 register
-
-        // Set the Selectors for Ring 3
-        newTask->CS = GDT_USER_CODE_SEGMENT | RPL_RING3;
-        newTask->DS = GDT_USER_DATA_SEGMENT | RPL_RING3;
-        newTask->SS = GDT_USER_DATA_SEGMENT | RPL_RING3;
-
-        // Set the remaining Segment Registers to zero
-        newTask->ES = 0x0;
-        newTask->FS = 0x0;
-        newTask->GS = 0x0;
-        
-        // Add the newly created Kernel Mode Task to the end of the TaskList
-        AddEntryToList(TaskList, newTask, PID);
+    if (LoadProgramIntoUserModeVirtualAddressSpace(FileName, pml4Clone, pid) == 1)
+    {
+        Task *newTask = InitUserModeTask(pid, kernelModeStack, pml4Clone, EXECUTABLE_BASE_ADDRESS, EXECUTABLE_USERMODE_STACK);
+
+        // The initial Task is the thread slot 0 of the new process
+        newTask->ThreadGroup = CreateThreadGroup(pid);
+        newTask->ThreadGroup->StandardInput = StandardInput;
+        newTask->ThreadGroup->StandardOutput = StandardOutput;
+        newTask->ThreadSlot = 0;
+
+        // Add the newly created User Mode Task to the end of the TaskList, and make it runnable
+        AddTaskToTaskList(newTask);
+        AddTaskToRunQueue(newTask);
 
-        // Return a reference to the newly created User Mode Task
-        return newTask;
+        // Return the PID of the newly created User Mode Task
+        return pid;
     }
 
     // The given program name was not found...
-    return 0x0;
+    ReleasePid(pid);
+    ReleaseKernelModeStack(kernelModeStack);
+    return 0;
+}
+
+// Creates a new thread in the User Mode process of the given Task, and returns its PID (the thread ID).
+// The thread shares the address space of the process, but has its own User Mode Stack and Kernel Mode Stack.
+// It starts at the given entry point with the argument in the register RDI, and its FS base is set to the given
+// Thread Pointer. It returns 0, when the entry point or the Thread Pointer isn't a User Mode address, when the process
+// has already the maximum number of threads, or when no PID or Kernel Mode Stack is available anymore.
+unsigned long CreateUserModeThread(Task *Parent, unsigned long EntryPoint, unsigned long Argument, unsigned long ThreadPointer)
+{
+    unsigned long kernelModeStack;
+    unsigned long pid;
+    Task *newTask;
+    int slot;
+
+    // Kernel Mode Tasks can't create threads
+    if (Parent->ThreadGroup == 0x0)
+        return 0;
+
+    // The entry point and the Thread Pointer are loaded into RIP and the FS base by the Context Switch.
+    // A non-canonical or Kernel Mode address would raise a General Protection Fault in Kernel Mode.
+    if ((EntryPoint >= USERMODE_ADDRESS_LIMIT) || (ThreadPointer >= USERMODE_ADDRESS_LIMIT))
+        return 0;
+
+    kernelModeStack = AllocateKernelModeStack();
+
+    if (kernelModeStack == 0)
+        return 0;
+
+    pid = AllocatePid();
+
+    if (pid == 0)
+    {
+        ReleaseKernelModeStack(kernelModeStack);
+        return 0;
+    }
+
+    slot = ReserveThreadSlot(Parent, pid);
+
+    if (slot == -1)
+    {
+        ReleasePid(pid);
+        ReleaseKernelModeStack(kernelModeStack);
+        return 0;
+    }
+
+    // Touch the Kernel Mode Stack, because the Context Switching routine can't handle a Page Fault on it
+    unsigned long *kernelModeStackPtr = (unsigned long *)kernelModeStack - 8;
+    kernelModeStackPtr[0] = kernelModeStackPtr[0]; // This read/write operation causes a Page Fault!
+
+    // The User Mode Stack of the thread is mapped by the Page Faults of the thread itself
+    newTask = InitUserModeTask(pid, kernelModeStack, Parent->CR3, EntryPoint, GetThreadUserModeStack(slot));
+    newTask->RDI = Argument;
+    newTask->FsBase = ThreadPointer;
+    newTask->ThreadGroup = Parent->ThreadGroup;
+    newTask->ThreadSlot = slot;
+
+    // Add the newly created thread to the end of the TaskList, and make it runnable
+    AddTaskToTaskList(newTask);
+    AddTaskToRunQueue(newTask);
+
+    return pid;
+}
+
+// Initializes a new User Mode Task structure without adding it to the TaskList.
+// The Task starts at the given entry point with the given User Mode Stack in the address space of the given PML4 table.
+static Task* InitUserModeTask(unsigned long PID, unsigned long KernelModeStack, unsigned long CR3, unsigned long EntryPoint, unsigned long UserModeStack)
+{
+    // Allocate a new Task structure on the Heap
+    Task *newTask = (Task *)malloc(sizeof(Task));
+    memset(newTask, 0, sizeof(Task));
+    newTask->PID = PID;
+    newTask->Status = TASK_STATUS_CREATED;
+    newTask->RIP = EntryPoint;
+    newTask->KernelModeStack = KernelModeStack;
+    newTask->UserModeStack = UserModeStack;
+    newTask->CR3 = CR3;
+
+    // The "Interrupt Enable Flag" (Bit 9) must be set
+    newTask->RFLAGS = 0x200;
+
+    // Set the General Purpose Registers
+    newTask->RAX = 0x0;
+    newTask->RBX = 0x0;
+    newTask->RCX = 0x0;
+    newTask->RDX = 0x0;
+    newTask->RBP = UserModeStack;
+
+    // The program entry point is entered like a called function (RSP + 8 is 16 byte aligned),
+    // because the compiler relies on the Stack alignment for SSE instructions
+    newTask->RSP = UserModeStack - 8;
+    newTask->RSI = 0x0;
+    newTask->RDI = 0x0;
+    newTask->R8 =  0x0;
+    newTask->R9 =  0x0;
+    newTask->R10 = 0x0;
+    newTask->R11 = 0x0;
+    newTask->R12 = 0x0;
+    newTask->R13 = 0x0;
+    newTask->R14 = 0x0;
+    newTask->R15 = 0x0;
+
+    // Set the Selectors for Ring 3
+    newTask->CS = GDT_USER_CODE_SEGMENT | RPL_RING3;
+    newTask->DS = GDT_USER_DATA_SEGMENT | RPL_RING3;
+    newTask->SS = GDT_USER_DATA_SEGMENT | RPL_RING3;
+
+    // Set the remaining Segment Registers to zero
+    newTask->ES = 0x0;
+    newTask->FS = 0x0;
+    newTask->GS = 0x0;
+
+    return newTask;
 }
 
-// Loads the given program into a new User Mode Virtual Address Space
-static int LoadProgramIntoUserModeVirtualAddressSpace(unsigned char *FileName, unsigned long UserModePML4Table)
+// Loads the given program into a new User Mode Virtual Address Space, and maps the vDSO of the process with the given PID
+static int LoadProgramIntoUserModeVirtualAddressSpace(unsigned char *FileName, unsigned long UserModePML4Table, unsigned long PID)
 {
     int returnCode = 0;
 
@@ -147,18 +346,12 @@ static int LoadProgramIntoUserModeVirtualAddressSpace(unsigned char *FileName, u
     // Load the program into the User Mode Virtual Address Space
     if (LoadProgram(FileName) == 1)
     {
-        // Touch the virtual address of the Kernel Mode Stack (8 bytes below the starting address), so that we can
-        // be sure that the virtual address will get mapped to a physical Page Frame through the Page Fault Handler.
-        // 
-        // NOTE: If we don't do that, and the virtual address is unmapped, the OS will crash during the Context
-        // Switching routine, because a Page Fault would occur (when we prepare the return Stack Frame), which
-        // can'be be handled, because the interrupts are disabled!
-        unsigned long *kernelModeStackPtr = (unsigned long *)EXECUTABLE_KERNELMODE_STACK - 8;
-        kernelModeStackPtr[0] = kernelModeStackPtr[0]; // This read/write operation causes a Page Fault!
-
         unsigned long *userModeStackPtr = (unsigned long *)EXECUTABLE_USERMODE_STACK - 8;
         userModeStackPtr[0] = userModeStackPtr[0]; // This read/write operation causes a Page Fault!
 
+        // The program reads its PID and the clocks from the vDSO without a SysCall
+        MapVdso(PID);
+
         returnCode = 1;
     }
 
@@ -169,97 +362,675 @@ static int LoadProgramIntoUserModeVirtualAddressSpace(unsigned char *FileName, u
     return returnCode;
 }
 
-// This function continuously checks if there is a new User Mode program to be started.
-void StartUserModeTask()
+// Creates all initial OS tasks.
+void CreateInitialTasks()
 {
-    // Get a pointer to the memory location
-    char *str = (char *)USERMODE_PROGRAMM_TO_EXECUTE;
+    Task *keyboardTask;
 
-    // Initially, we clear the memory location
-    strcpy(str, "");
+    // Create the initial Kernel Mode Tasks.
+    // The keyboard input is handled by a Real-Time Task, so that it isn't waiting behind CPU bound Tasks.
+    keyboardTask = CreateKernelModeTask(KeyboardHandlerTask, 0xFFFF800001100000);
+    SetRealTimeScheduling(keyboardTask, RT_PRIORITY_INPUT, RT_KERNEL_RUNTIME_NANOSECONDS, RT_KERNEL_PERIOD_NANOSECONDS);
 
-    // We just check continuously the memory location...
-    while (1 == 1)
+    // Create the Worker Tasks of the Work Queue, of the Spawn Queue, and of the I/O Rings
+    CreateWorkQueueWorkers();
+    CreateSpawnWorker();
+    CreateIoRingWorker();
+
+    /* CreateKernelModeTask(Dummy1, 0xFFFF800001100000);
+    CreateKernelModeTask(Dummy2, 0xFFFF800001200000);
+    CreateKernelModeTask(Dummy3, 0xFFFF800001300000); */
+
+    // Load and execute some programs from the FAT12 file system
+    ExecuteUserModeProgram("SHELL   BIN", 0, 0);
+    // ExecuteUserModeProgram("PROG1   BIN", 0, 0);
+    // ExecuteUserModeProgram("PROG2   BIN", 0, 0);
+}
+
+// Selects the next runnable Task of the current processor and programs the next timer interrupt.
+// A preempted Task is queued at the end of the run queue, and the Task at its head is executed next.
+// When the run queue is empty, a Task is stolen from another processor - otherwise the Idle Task is executed.
+// The next timer interrupt fires at the end of the time slice when another Task wants to run, otherwise when
+// the next timer of the Timer Wheel expires.
+Task* MoveToNextTask(Task *CurrentTask)
+{
+    Cpu *cpu = GetCurrentCpu();
+    unsigned long now;
+    unsigned long nextTimerInterrupt = 0;
+    unsigned long timeSliceEnd;
+    int preempted = 0;
+    Task *nextTask;
+
+    // Save the FPU state of the interrupted Task, before another processor can continue it
+    if (CurrentTask != 0x0)
+        FpuContextSwitchOut(cpu, CurrentTask);
+
+    if ((CurrentTask != 0x0) && (CurrentTask != cpu->IdleTask))
     {
-        // Check, if a 8.3 program name is stored at the memory location
-        if (strlen(str) == 11)
+        // Account the CPU time of the interrupted Task - the saved Code Segment tells us in which mode it was interrupted
+        AccountCpuTime(CurrentTask, (CurrentTask->CS & RPL_RING3) != RPL_RING3);
+
+        // Charge the runtime of a Real-Time Task to its budget
+        ChargeRealTimeRuntime(CurrentTask, GetMonotonicTime());
+
+        if (CurrentTask->Status == TASK_STATUS_RUNNING)
+        {
+            // The interrupted Task was preempted, and is queued again below
+            preempted = 1;
+        }
+        else if (CurrentTask->Status == TASK_STATUS_TERMINATED)
+        {
+            // The terminated Task is switched out for the last time
+            ReleaseTask(CurrentTask);
+        }
+        else
         {
-            // Execute the requested user mode program
-            ExecuteUserModeProgram(str, 10);
-            
-            // Clear the memory location
-            strcpy(str, "");
+            // The Task has blocked itself.
+            // From now on it can be continued by any processor, as soon as it gets woken up.
+            CurrentTask->VoluntaryContextSwitches++;
+            __atomic_store_n(&CurrentTask->OnCpu, 0, __ATOMIC_RELEASE);
         }
     }
+    else if (CurrentTask != 0x0)
+    {
+        // The time of the Idle Task is accounted as Kernel Mode time
+        AccountCpuTime(CurrentTask, 1);
+    }
+
+    // Wake up the sleeping Tasks, and run the other expired timers
+    RunExpiredTimers();
+
+    AcquireSpinlock(&cpu->RunQueueLock);
+
+    if (preempted)
+    {
+        // The preempted Task is only switched out, when another Task is waiting in the run queue.
+        // A running Task that has given up the CPU by itself (like through the SysCall "SYSCALL_YIELD") was not preempted.
+        if ((cpu->RunQueueLength > 0) && (CurrentTask->ResumeMode == TASK_RESUME_SWITCH))
+            CurrentTask->VoluntaryContextSwitches++;
+        else if (cpu->RunQueueLength > 0)
+            CurrentTask->InvoluntaryContextSwitches++;
+
+        CurrentTask->Status = TASK_STATUS_RUNNABLE;
+        AppendToRunQueue(cpu, CurrentTask);
+        __atomic_store_n(&CurrentTask->OnCpu, 0, __ATOMIC_RELEASE);
+    }
+
+    nextTask = TakeTaskFromRunQueue(cpu, 0);
+    ReleaseSpinlock(&cpu->RunQueueLock);
+
+    // Steal a Task from another processor, before we execute the Idle Task
+    if (nextTask == 0x0)
+        nextTask = StealTask(cpu);
+
+    if (nextTask == 0x0)
+        nextTask = cpu->IdleTask;
+
+    // A Task that was woken up on another processor is maybe still switched out there
+    while (__atomic_load_n(&nextTask->OnCpu, __ATOMIC_ACQUIRE) == 1)
+        asm volatile("pause");
+
+    nextTask->OnCpu = 1;
+    nextTask->Cpu = cpu->Index;
+    cpu->CurrentTask = nextTask;
+
+    // Record the Context Switch, and how long the next Task has waited for it.
+    // A Task that continues immediately (because no other Task is runnable) hasn't waited at all.
+    if (nextTask != CurrentTask)
+    {
+        cpu->ContextSwitchCount++;
+        nextTask->ContextSwitches++;
+        RecordDispatchLatency(cpu, nextTask);
+    }
+    else
+    {
+        nextTask->EnqueueTimestamp = 0;
+        nextTask->WakeupTimestamp = 0;
+    }
+
+    // The CPU time of the next Task is accounted from now on
+    now = GetMonotonicTime();
+    nextTask->AccountingTimestamp = rdtsc();
+    nextTask->RtRunTimestamp = now;
+
+    // Set the status of the next Task to TASK_STATUS_RUNNING
+    nextTask->Status = TASK_STATUS_RUNNING;
+
+    // Set the Kernel Mode Stack for the next executing Task
+    cpu->KernelStack = nextTask->KernelModeStack;
+    cpu->Tss->rsp0 = nextTask->KernelModeStack;
+
+    // Load the Thread Local Storage of the next Task - the MSR is only written when the FS base changes
+    if (cpu->FsBase != nextTask->FsBase)
+    {
+        wrmsr(IA32_FS_BASE, nextTask->FsBase);
+        cpu->FsBase = nextTask->FsBase;
+    }
+
+    // Program the next timer interrupt.
+    // The Timer Wheel is shared by all processors, therefore every processor wakes up for the next expiring timer.
+    nextTimerInterrupt = GetNextTimerExpiry();
+    timeSliceEnd = GetTimeSliceEnd(cpu, nextTask, now);
+
+    if (timeSliceEnd < nextTimerInterrupt)
+        nextTimerInterrupt = timeSliceEnd;
+
+    if (nextTimerInterrupt == TIMER_NOT_PENDING)
+        StopTimerInterrupt();
+    else if (nextTimerInterrupt > now)
+        ProgramTimerInterrupt(nextTimerInterrupt - now);
+    else
+        ProgramTimerInterrupt(0);
+
+    // Return the next Task
+    return nextTask;
 }
 
-// Creates all initial OS tasks.
-void CreateInitialTasks()
+// Adds the given runnable Task to the run queue of a processor.
+// When the run queue was empty, the processor is interrupted, so that it executes the Task immediately.
+void AddTaskToRunQueue(Task *Task)
 {
-    // Initialize the TaskList
-    TaskList = NewList();
-    TaskList->PrintFunctionPtr = &PrintTaskList;
+    unsigned long flags = SaveFlagsAndDisableInterrupts();
+    Cpu *cpu = SelectCpuForTask(Task);
+    struct Task *currentTask;
+    int wasEmpty;
 
-    // Create the initial Kernel Mode Tasks
-    CreateKernelModeTask(KeyboardHandlerTask, 1, 0xFFFF800001100000);
-    CreateKernelModeTask(StartUserModeTask, 2, 0xFFFF800001200000);
+    AcquireSpinlock(&cpu->RunQueueLock);
+    wasEmpty = cpu->RunQueueLength == 0;
+    AppendToRunQueue(cpu, Task);
+    ReleaseSpinlock(&cpu->RunQueueLock);
 
-    /* CreateKernelModeTask(Dummy1, 1, 0xFFFF800001100000);
-    CreateKernelModeTask(Dummy2, 2, 0xFFFF800001200000);
-    CreateKernelModeTask(Dummy3, 3, 0xFFFF800001300000); */
+    // A processor that hasn't scheduled its first Task yet is not interrupted.
+    // A Real-Time Task preempts the current Task of the processor immediately, when it has a higher priority.
+    currentTask = cpu->CurrentTask;
 
-    // Load and execute some programs from the FAT12 file system
-    ExecuteUserModeProgram("SHELL   BIN", 4);
-    // ExecuteUserModeProgram("PROG1   BIN", 4);
-    // ExecuteUserModeProgram("PROG2   BIN", 5);
+    if ((currentTask != 0x0) && (wasEmpty || PreemptsTask(Task, currentTask)))
+    {
+        if (cpu == GetCurrentCpu())
+            ProgramTimerInterrupt(0);
+        else
+            ApicSendIpi(cpu->ApicId, APIC_ICR_FIXED | APIC_TIMER_VECTOR);
+    }
+
+    RestoreFlags(flags);
 }
 
-// Moves the current Task from the head of the TaskList to the tail of the TaskList.
-Task* MoveToNextTask()
+// Appends the given Task to the run queue of the given processor.
+// A Real-Time Task is appended to the queue of its priority, and a throttled Real-Time Task is queued like a normal Task.
+// The caller must hold the lock of the run queue.
+static void AppendToRunQueue(Cpu *Cpu, Task *Task)
 {
-    // Remove the old head from the TaskList and set its status to TASK_STATUS_RUNNABLE
-    ListEntry *oldHead = TaskList->RootEntry;
-    ((Task *)oldHead->Payload)->Status = TASK_STATUS_RUNNABLE;
-    RemoveEntryFromList(TaskList, oldHead);
+    struct Task **head = &Cpu->RunQueueHead;
+    struct Task **tail = &Cpu->RunQueueTail;
+
+    ReplenishRealTimeBudget(Task, GetMonotonicTime());
 
-    // Add the old head to the end of the TaskList
-    AddEntryToList(TaskList, oldHead->Payload, oldHead->Key);
+    if (IsRealTimeTask(Task))
+    {
+        head = &Cpu->RtQueueHead[Task->RtPriority];
+        tail = &Cpu->RtQueueTail[Task->RtPriority];
+        Cpu->RtQueueBitmap |= 1U << Task->RtPriority;
+    }
 
-    // Set the status of the new head to TASK_STATUS_RUNNING
-    ((Task *)TaskList->RootEntry->Payload)->Status = TASK_STATUS_RUNNING;
+    Task->EnqueueTimestamp = rdtsc();
+    Task->RunQueueNext = 0x0;
+    Task->RunQueuePrevious = *tail;
 
-    // Record the Context Switch
-    ((Task *)TaskList->RootEntry->Payload)->ContextSwitches++;
+    if (*tail != 0x0)
+        (*tail)->RunQueueNext = Task;
+    else
+        *head = Task;
 
-    // Set the Kernel Mode Stack for the next executing Task
-    TssEntry *tssEntry = GetTss();
-    tssEntry->rsp0 = ((Task *)TaskList->RootEntry->Payload)->KernelModeStack;
-    
-    // Increment the clock counter
-    counter++;
+    *tail = Task;
+    Cpu->RunQueueLength++;
+}
 
-    // The timer is fired every 4 milliseconds
-    if (counter % 250 == 0)
+// Removes the next Task (or the Task to be stolen) from the run queue of the given processor.
+// The next Task is the first Task of the highest Real-Time priority, or the first normal Task.
+// A stolen Task is taken from the tail of the normal Tasks, so that a Real-Time Task is only stolen by a processor
+// that would otherwise be idle.
+// The caller must hold the lock of the run queue.
+static Task* TakeTaskFromRunQueue(Cpu *Cpu, int FromTail)
+{
+    Task *task;
+    int priority;
+
+    if ((Cpu->RtQueueBitmap != 0) && (!FromTail || (Cpu->RunQueueHead == 0x0)))
+    {
+        priority = 31 - __builtin_clz(Cpu->RtQueueBitmap);
+        task = FromTail ? Cpu->RtQueueTail[priority] : Cpu->RtQueueHead[priority];
+        UnlinkFromRunQueue(&Cpu->RtQueueHead[priority], &Cpu->RtQueueTail[priority], task);
+
+        if (Cpu->RtQueueHead[priority] == 0x0)
+            Cpu->RtQueueBitmap &= ~(1U << priority);
+    }
+    else
+    {
+        task = FromTail ? Cpu->RunQueueTail : Cpu->RunQueueHead;
+
+        if (task == 0x0)
+            return 0x0;
+
+        UnlinkFromRunQueue(&Cpu->RunQueueHead, &Cpu->RunQueueTail, task);
+    }
+
+    Cpu->RunQueueLength--;
+
+    return task;
+}
+
+// Removes the given Task from the given queue of a run queue.
+// The caller must hold the lock of the run queue.
+static void UnlinkFromRunQueue(Task **Head, Task **Tail, Task *Task)
+{
+    if (Task->RunQueuePrevious != 0x0)
+        Task->RunQueuePrevious->RunQueueNext = Task->RunQueueNext;
+    else
+        *Head = Task->RunQueueNext;
+
+    if (Task->RunQueueNext != 0x0)
+        Task->RunQueueNext->RunQueuePrevious = Task->RunQueuePrevious;
+    else
+        *Tail = Task->RunQueuePrevious;
+
+    Task->RunQueueNext = 0x0;
+    Task->RunQueuePrevious = 0x0;
+}
+
+// Returns the monotonic time when the time slice of the given Task ends, or TIMER_NOT_PENDING.
+// A normal Task is preempted at the end of its time slice, when another Task is waiting in the run queue.
+// A Real-Time Task only shares the CPU with the Real-Time Tasks of the same priority, and is preempted when its budget is exhausted.
+static unsigned long GetTimeSliceEnd(Cpu *Cpu, Task *Task, unsigned long Now)
+{
+    unsigned long timeSliceEnd = TIMER_NOT_PENDING;
+    unsigned long budgetEnd;
+
+    if (IsRealTimeTask(Task))
+    {
+        if (Cpu->RtQueueHead[Task->RtPriority] != 0x0)
+            timeSliceEnd = Now + TIMESLICE_NANOSECONDS;
+
+        budgetEnd = GetRealTimeBudgetEnd(Task, Now);
+
+        if (budgetEnd < timeSliceEnd)
+            timeSliceEnd = budgetEnd;
+    }
+    else if (Cpu->RunQueueLength > 0)
+        timeSliceEnd = Now + TIMESLICE_NANOSECONDS;
+
+    return timeSliceEnd;
+}
+
+// Steals a runnable Task from the processor with the longest run queue.
+// The Task is taken from the tail of the run queue, while the owning processor continues at its head.
+static Task* StealTask(Cpu *Thief)
+{
+    Cpu *victim = 0x0;
+    int longestRunQueue = 0;
+    Task *task;
+    int i;
+
+    // The lengths of the run queues are only read without a lock - the victim is checked again under its lock
+    for (i = 0; i < GetCpuCount(); i++)
+    {
+        Cpu *cpu = GetCpu(i);
+
+        if ((cpu != Thief) && cpu->Online && (cpu->RunQueueLength > longestRunQueue))
+        {
+            victim = cpu;
+            longestRunQueue = cpu->RunQueueLength;
+        }
+    }
+
+    if (victim == 0x0)
+        return 0x0;
+
+    AcquireSpinlock(&victim->RunQueueLock);
+    task = TakeTaskFromRunQueue(victim, 1);
+    ReleaseSpinlock(&victim->RunQueueLock);
+
+    return task;
+}
+
+// Selects the processor whose run queue receives a runnable Task.
+// An idle processor is preferred (ideally the one that has executed the Task the last time, because of its caches),
+// then a processor where a Real-Time Task can preempt the current Task, otherwise the processor with the shortest run queue is selected.
+static Cpu* SelectCpuForTask(Task *Task)
+{
+    Cpu *selectedCpu = GetCurrentCpu();
+    int i;
+
+    if (IsCpuIdle(GetCpu(Task->Cpu)))
+        return GetCpu(Task->Cpu);
+
+    for (i = 0; i < GetCpuCount(); i++)
     {
-        // Increment the system date by 1 second
-        IncrementSystemDate();
+        if (IsCpuIdle(GetCpu(i)))
+            return GetCpu(i);
+    }
+
+    // A Real-Time Task prefers a processor where it can preempt the current Task immediately
+    if (IsRealTimeTask(Task))
+    {
+        for (i = 0; i < GetCpuCount(); i++)
+        {
+            Cpu *cpu = GetCpu(i);
+
+            if (cpu->Online && (cpu->CurrentTask != 0x0) && PreemptsTask(Task, cpu->CurrentTask))
+                return cpu;
+        }
+    }
+
+    for (i = 0; i < GetCpuCount(); i++)
+    {
+        Cpu *cpu = GetCpu(i);
+
+        if (cpu->Online && (cpu->RunQueueLength < selectedCpu->RunQueueLength))
+            selectedCpu = cpu;
+    }
+
+    return selectedCpu;
+}
+
+// Returns 1 if the given processor executes its Idle Task, and has no runnable Tasks
+static int IsCpuIdle(Cpu *Cpu)
+{
+    return Cpu->Online && (Cpu->CurrentTask == Cpu->IdleTask) && (Cpu->RunQueueLength == 0);
+}
+
+// Allocates a Kernel Mode Stack for a User Mode Task.
+// It returns the starting address of the Kernel Mode Stack, or 0 if all Kernel Mode Stacks are in use.
+static unsigned long AllocateKernelModeStack()
+{
+    unsigned long used;
+    int word;
+    int slot;
+
+    for (word = 0; word < KERNELMODE_STACK_BITMAP_WORDS; word++)
+    {
+        used = __atomic_load_n(&kernelModeStacks[word], __ATOMIC_RELAXED);
 
-        // Refresh the status line
-        RefreshStatusLine();
+        while (~used != 0)
+        {
+            slot = word * 64 + __builtin_ctzl(~used);
+
+            // The last bitmap word can have more bits than Kernel Mode Stacks
+            if (slot >= MAX_KERNELMODE_STACKS)
+                break;
+
+            if (__atomic_compare_exchange_n(&kernelModeStacks[word], &used, used | (1UL << (slot % 64)), 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+                return EXECUTABLE_KERNELMODE_STACKS + (slot + 1) * EXECUTABLE_KERNELMODE_STACK_SIZE;
+        }
     }
 
-    // Return the new head
-    return ((Task *)TaskList->RootEntry->Payload);
+    return 0;
+}
+
+// Releases the Kernel Mode Stack with the given starting address
+static void ReleaseKernelModeStack(unsigned long KernelModeStack)
+{
+    int slot = (KernelModeStack - EXECUTABLE_KERNELMODE_STACKS) / EXECUTABLE_KERNELMODE_STACK_SIZE - 1;
+
+    __atomic_and_fetch(&kernelModeStacks[slot / 64], ~(1UL << (slot % 64)), __ATOMIC_RELEASE);
+}
+
+// Releases the resources of a terminated Task, after it was switched out.
+// The Task was already removed from the TaskList by "TerminateTask".
+// Its PID is only released now, so that it isn't reused while the Task is still executing.
+static void ReleaseTask(Task *Task)
+{
+    // Only User Mode Tasks are using a Kernel Mode Stack from the pool
+    if (Task->UserModeStack != 0)
+        ReleaseKernelModeStack(Task->KernelModeStack);
+
+    ReleasePid(Task->PID);
+    ReleaseRealTimeBandwidth(Task);
+    ReleaseFpuState(Task);
+    ReleaseThreadGroup(Task);
+    free(Task);
 }
 
-// Terminates the Kernel Mode Task with the given PID
-void TerminateTask(unsigned long PID)
+// Accounts the CPU time of the given Task since its last accounting point.
+// It is called when the Task is switched out, and when a SysCall is entered and left.
+void AccountCpuTime(Task *Task, int KernelMode)
 {
-    // Find the Task which needs to be terminated
-    ListEntry *task = GetEntryFromList(TaskList, PID);
+    unsigned long tsc = rdtsc();
+
+    if (KernelMode)
+        Task->KernelTime += tsc - Task->AccountingTimestamp;
+    else
+        Task->UserTime += tsc - Task->AccountingTimestamp;
 
-    // Remove the Task from the TaskList
-    RemoveEntryFromList(TaskList, task);
+    Task->AccountingTimestamp = tsc;
+}
+
+// Returns a snapshot of the statistics of all Tasks (including the Idle Task).
+// The return value is the number of Tasks that were copied into the provided buffer.
+int GetTaskStatistics(TaskStatistics *Buffer, int MaxEntries)
+{
+    unsigned long flags;
+    Task *task;
+    int count = 0;
+    int i;
+
+    // The Idle Tasks of all processors are reported as PID 0
+    for (i = 0; (i < GetCpuCount()) && (count < MaxEntries); i++)
+        FillTaskStatistics(GetCpu(i)->IdleTask, &Buffer[count++]);
+
+    flags = AcquireSpinlockIrqSave(&taskListLock);
+    task = taskListHead;
+
+    while ((task != 0x0) && (count < MaxEntries))
+    {
+        FillTaskStatistics(task, &Buffer[count++]);
+        task = task->TaskListNext;
+    }
+
+    ReleaseSpinlockIrqRestore(&taskListLock, flags);
+
+    return count;
+}
+
+// Copies the statistics of the given Task into the snapshot structure
+static void FillTaskStatistics(Task *Task, TaskStatistics *Statistics)
+{
+    Statistics->PID = Task->PID;
+    Statistics->Status = Task->Status;
+    Statistics->UserTime = TscToNanoseconds(Task->UserTime);
+    Statistics->KernelTime = TscToNanoseconds(Task->KernelTime);
+    Statistics->WaitTime = TscToNanoseconds(Task->WaitTime);
+    Statistics->ContextSwitches = Task->ContextSwitches;
+    Statistics->VoluntaryContextSwitches = Task->VoluntaryContextSwitches;
+    Statistics->InvoluntaryContextSwitches = Task->InvoluntaryContextSwitches;
+    Statistics->PageFaults = Task->PageFaults;
+}
+
+// Records the scheduling latencies of the given Task, when it gets dispatched on the given processor.
+// They are recorded in the histograms of the Task and of the processor.
+static void RecordDispatchLatency(Cpu *Cpu, Task *Task)
+{
+    unsigned long tsc = rdtsc();
+    unsigned long latency;
+
+    if (Task->EnqueueTimestamp != 0)
+    {
+        latency = TscToNanoseconds(tsc - Task->EnqueueTimestamp);
+        RecordLatency(&Task->RunQueueLatency, latency);
+        RecordLatency(&Cpu->RunQueueLatency, latency);
+        Task->EnqueueTimestamp = 0;
+    }
+
+    if (Task->WakeupTimestamp != 0)
+    {
+        latency = TscToNanoseconds(tsc - Task->WakeupTimestamp);
+        RecordLatency(&Task->WakeupLatency, latency);
+        RecordLatency(&Cpu->WakeupLatency, latency);
+        Task->WakeupTimestamp = 0;
+    }
+}
+
+// Returns a snapshot of a latency histogram (LATENCY_RUNQUEUE or LATENCY_WAKEUP) of the Task with the given PID.
+// The PID 0 returns the system-wide histogram of all processors. It returns 0 if the Task doesn't exist.
+int GetLatencyHistogram(unsigned long PID, int Kind, LatencyHistogram *Buffer)
+{
+    LatencyHistogram snapshot;
+    unsigned long flags;
+    Task *task;
+    int i;
+
+    memset(&snapshot, 0, sizeof(LatencyHistogram));
+
+    if (PID == 0)
+    {
+        // The histograms of the processors are read without a lock, so a snapshot can be slightly inconsistent
+        for (i = 0; i < GetCpuCount(); i++)
+            MergeLatencyHistogram(&snapshot, Kind == LATENCY_WAKEUP ? &GetCpu(i)->WakeupLatency : &GetCpu(i)->RunQueueLatency);
+    }
+    else
+    {
+        // A terminating Task is removed from the TaskList before it gets released,
+        // so the Task can't be released while we hold the lock of the TaskList.
+        flags = AcquireSpinlockIrqSave(&taskListLock);
+        task = FindTaskByPid(PID);
+
+        if (task != 0x0)
+            MergeLatencyHistogram(&snapshot, Kind == LATENCY_WAKEUP ? &task->WakeupLatency : &task->RunQueueLatency);
+
+        ReleaseSpinlockIrqRestore(&taskListLock, flags);
+
+        if (task == 0x0)
+            return 0;
+    }
+
+    memcpy(Buffer, &snapshot, sizeof(LatencyHistogram));
+
+    return 1;
+}
+
+// Sets the trace ring of the Task with the given PID (0x0 stops the tracing). It returns 0 if the Task doesn't exist.
+int SetSysCallTrace(unsigned long PID, struct SysCallTrace *Trace)
+{
+    unsigned long flags;
+    Task *task;
+
+    // The Task can't be released while we hold the lock of the TaskList
+    flags = AcquireSpinlockIrqSave(&taskListLock);
+    task = FindTaskByPid(PID);
+
+    if (task != 0x0)
+        task->SysCallTrace = Trace;
+
+    ReleaseSpinlockIrqRestore(&taskListLock, flags);
+
+    return task != 0x0;
+}
+
+// Blocks the given Task (the current one) for the given number of nanoseconds.
+// The Task gives up the CPU immediately, and continues on any processor after the timer has woken it up.
+// The interrupts are disabled, because a preemption before the timer was added would block the waiting Task forever.
+void SleepTask(Task *Task, unsigned long Nanoseconds)
+{
+    unsigned long flags = SaveFlagsAndDisableInterrupts();
+
+    PrepareToWait(Task);
+    AddTimer(&Task->SleepTimer, GetMonotonicTime() + Nanoseconds, WakeUpTask, Task);
+    YieldTask();
+
+    RestoreFlags(flags);
+}
+
+// Marks the current Task as waiting, before it registers itself where it gets woken up.
+// A wakeup that happens before the Task gives up the CPU is therefore not lost.
+void PrepareToWait(Task *Task)
+{
+    Task->WaitTimestamp = rdtsc();
+    Task->Status = TASK_STATUS_WAITING;
+
+    // The status must be visible to the other processors, before the Task checks its wakeup condition
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+// Marks the current Task as running again, when it hasn't blocked after "PrepareToWait".
+// When the Task was woken up in the meantime, it was already added to a run queue - therefore it gives up the CPU once.
+void FinishWait(Task *Task)
+{
+    if (!__sync_bool_compare_and_swap(&Task->Status, TASK_STATUS_WAITING, TASK_STATUS_RUNNING))
+        YieldTask();
+}
+
+// Makes the given Task runnable again (called by the Timer Wheel).
+// Only one of several concurrent wakeups adds the Task to a run queue.
+void WakeUpTask(void *Context)
+{
+    Task *task = (Task *)Context;
+
+    if (__sync_bool_compare_and_swap(&task->Status, TASK_STATUS_WAITING, TASK_STATUS_RUNNABLE))
+    {
+        unsigned long tsc = rdtsc();
+
+        task->WaitTime += tsc - task->WaitTimestamp;
+        task->WakeupTimestamp = tsc;
+        AddTaskToRunQueue(task);
+    }
+}
+
+// Gives up the CPU, and continues with the next runnable Task.
+// When the current Task has set its status to TASK_STATUS_WAITING before, it is blocked until it gets woken up.
+void YieldTask()
+{
+    SwitchToNextTask();
+}
+
+// Increments the system date and refreshes the status line every second.
+// This work was done previously in the Timer Interrupt, now it's just a periodic timer of the Timer Wheel.
+void InitSystemDateTimer()
+{
+    AddTimer(&systemDateTimer, GetMonotonicTime() + NANOSECONDS_PER_SECOND, SystemDateTimerCallback, 0x0);
+}
+
+// Called by the Timer Wheel every second to increment the system date
+static void SystemDateTimerCallback(void *Context)
+{
+    // Increment the system date by 1 second.
+    // Formatting the status line is deferred to the Work Queue, so that it doesn't happen with disabled interrupts.
+    IncrementSystemDate();
+    UpdateVdsoWallClock();
+    QueueWork(RefreshStatusLineWork, 0x0);
+
+    // The timer is added again based on its previous expiration time, so that the system date doesn't drift
+    AddTimer(&systemDateTimer, systemDateTimer.Expires + NANOSECONDS_PER_SECOND, SystemDateTimerCallback, 0x0);
+}
+
+// The Idle Task halts the CPU until the next interrupt arrives
+void IdleTask()
+{
+    while (1 == 1)
+    {
+        asm volatile("hlt");
+    }
+}
+
+// Terminates the current Task.
+// Its Task structure is released by the Context Switch, after the Task was switched out for the last time.
+void TerminateTask()
+{
+    Task *task = GetTaskState();
+
+    // Remove the Task from the TaskList, so that it can't be found through its PID anymore
+    RemoveTaskFromTaskList(task);
+
+    // Wake up the threads that are joining the terminating thread
+    ExitThread(task);
+
+    // The terminated Task must not continue its execution
+    task->Status = TASK_STATUS_TERMINATED;
+    YieldTask();
+}
+
+// Refreshs the status line from a Worker Task of the Work Queue
+static void RefreshStatusLineWork(void *Context)
+{
+    RefreshStatusLine();
 }
 
 // Refreshs the status line
@@ -327,14 +1098,14 @@ void RefreshStatusLine()
 // Prints out the TaskList entries
 void PrintTaskList()
 {
-    ListEntry *currentEntry = TaskList->RootEntry;
-    Task *task = (Task *)currentEntry->Payload;
+    unsigned long flags = AcquireSpinlockIrqSave(&taskListLock);
+    Task *task = taskListHead;
 
     // Iterate over the whole list
-    while (currentEntry != 0x0)
+    while (task != 0x0)
     {
         printf("0x");
-        printf_long((unsigned long)currentEntry, 16);
+        printf_long((unsigned long)task, 16);
         printf(", PID: ");
         printf_long(task->PID, 10);
         printf(", KernelModeStack: 0x");
@@ -343,11 +1114,11 @@ void PrintTaskList()
         PrintStatus(task->Status);
         printf("\n");
     
-        // Move to the next entry in the Double Linked List
-        currentEntry = currentEntry->Next;
-        task = (Task *)currentEntry->Payload;
-    } 
+        // Move to the next Task in the Double Linked List
+        task = task->TaskListNext;
+    }
 
+    ReleaseSpinlockIrqRestore(&taskListLock, flags);
     printf("\n");
 }
 
@@ -360,6 +1131,7 @@ static void PrintStatus(int Status)
         case 1: printf("RUNNABLE"); break;
         case 2: printf("RUNNING"); break;
         case 3: printf("WAITING"); break;
+        case 4: printf("TERMINATED"); break;
     }
 }
 
@@ -1,17 +1,49 @@
 #ifndef TASK_H
 #define TASK_H
 
+#include "timerwheel.h"
+#include "latency.h"
+
+// Represents a processor (defined in the file "smp.h")
+struct Cpu;
+
+// Represents the threads of a User Mode process (defined in the file "thread.h")
+struct ThreadGroup;
+
 // The various Task states
 #define TASK_STATUS_CREATED             0x0
 #define TASK_STATUS_RUNNABLE            0x1
 #define TASK_STATUS_RUNNING             0x2
 #define TASK_STATUS_WAITING             0x3
+#define TASK_STATUS_TERMINATED          0x4
 
 #define EXECUTABLE_BASE_ADDRESS         0x0000700000000000
 #define EXECUTABLE_USERMODE_STACK       0x00007FFFF0000000
-#define EXECUTABLE_KERNELMODE_STACK     0xFFFF800001400000
 
-#define USERMODE_PROGRAMM_TO_EXECUTE    0xFFFF800000300000
+// The User Mode part of the virtual address space ends below this address (the lower canonical half)
+#define USERMODE_ADDRESS_LIMIT          0x0000800000000000
+
+// Every User Mode Task has its own Kernel Mode Stack (64 KB), because a Task can block within a SysCall.
+// The Kernel Mode Stacks are stored one after another in this area, so at most MAX_KERNELMODE_STACKS User Mode Tasks
+// can exist at the same time (the area in the file "MemoryMap.txt" must grow together with the constant).
+#define EXECUTABLE_KERNELMODE_STACKS    0xFFFF800002000000
+#define EXECUTABLE_KERNELMODE_STACK_SIZE 0x10000
+#define MAX_KERNELMODE_STACKS           64
+#define KERNELMODE_STACK_BITMAP_WORDS   ((MAX_KERNELMODE_STACKS + 63) / 64)
+
+// The Kernel Mode Stack of the Idle Task of the Bootstrap Processor.
+// The Idle Tasks of the Application Processors are using the 64 KB below.
+#define IDLE_TASK_KERNELMODE_STACK      0xFFFF800001000000
+#define IDLE_TASK_KERNELMODE_STACK_SIZE 0x10000
+
+// The time slice of a Task in nanoseconds (sub-millisecond values are possible)
+#define TIMESLICE_NANOSECONDS           1000000
+
+// How a switched out Task is continued (the same constants are defined in the file "contextswitching.asm"):
+// A preempted Task is continued through IRETQ with its complete register state, and a Task that has given up the CPU
+// through "SwitchToNextTask" returns from that function.
+#define TASK_RESUME_IRETQ               0
+#define TASK_RESUME_SWITCH              1
 
 // Represents the state of a Task
 typedef struct Task
@@ -49,6 +81,11 @@ typedef struct Task
     // Control Registers
     unsigned long CR3;      // Offset +192
 
+    // The Kernel Mode Stack Pointer of a Task that has given up the CPU through "SwitchToNextTask",
+    // and how the Task is continued (TASK_RESUME_IRETQ or TASK_RESUME_SWITCH)
+    unsigned long SwitchRSP;    // Offset +200
+    unsigned long ResumeMode;   // Offset +208
+
     // The ID of the running Task
     unsigned long PID;
 
@@ -61,47 +98,251 @@ typedef struct Task
     // The number of context switches of the running Task
     unsigned long ContextSwitches;
 
+    // The number of context switches where the Task has blocked itself (like "Sleep"),
+    // and where the Task was preempted at the end of its time slice
+    unsigned long VoluntaryContextSwitches;
+    unsigned long InvoluntaryContextSwitches;
+
+    // The CPU time (in TSC ticks) that the Task has spent in User Mode and in Kernel Mode
+    unsigned long UserTime;
+    unsigned long KernelTime;
+
+    // The time (in TSC ticks) that the Task has spent in the status TASK_STATUS_WAITING
+    unsigned long WaitTime;
+
+    // The TSC value when the CPU time of the Task was accounted the last time
+    unsigned long AccountingTimestamp;
+
+    // The TSC value when the Task was blocked
+    unsigned long WaitTimestamp;
+
+    // The number of Page Faults raised by the Task
+    unsigned long PageFaults;
+
+    // The TSC values when the Task was queued into a run queue, and when it was woken up (0 if not pending)
+    unsigned long EnqueueTimestamp;
+    unsigned long WakeupTimestamp;
+
+    // The scheduling latencies of the Task (LATENCY_RUNQUEUE and LATENCY_WAKEUP)
+    LatencyHistogram RunQueueLatency;
+    LatencyHistogram WakeupLatency;
+
     // The status of the Task:
     // 0: CREATED
     // 1: RUNNABLE
     // 2: RUNNING
     // 3: WAITING
-    int Status;
+    // 4: TERMINATED
+    volatile int Status;
+
+    // The timer that wakes up the Task when it sleeps
+    Timer SleepTimer;
+
+    // The index of the processor that has executed the Task the last time
+    int Cpu;
+
+    // 1 while a processor executes the Task.
+    // Another processor can't continue the Task, until its state is completely saved by the Context Switch.
+    volatile int OnCpu;
+
+    // The scheduling class of the Task (SCHED_CLASS_NORMAL or SCHED_CLASS_REALTIME), and its Real-Time priority
+    int SchedulingClass;
+    int RtPriority;
+
+    // The runtime budget of a Real-Time Task: it may run for "RtRuntime" nanoseconds in each period of "RtPeriod" nanoseconds.
+    // A Task that has exhausted its budget is throttled until its next period starts.
+    unsigned long RtRuntime;
+    unsigned long RtPeriod;
+    unsigned long RtPeriodStart;
+    unsigned long RtConsumed;
+    unsigned long RtRunTimestamp;
+    int RtThrottled;
+    unsigned long RtThrottleCount;
+
+    // The admitted CPU bandwidth of the Real-Time Task (in parts per million of a processor)
+    unsigned long RtUtilization;
+
+    // The neighbours of the Task in the TaskList
+    struct Task *TaskListNext;
+    struct Task *TaskListPrevious;
+
+    // The next Task in the same bucket of the PID hash table
+    struct Task *PidHashNext;
+
+    // The neighbours of the Task in the run queue of a processor
+    struct Task *RunQueueNext;
+    struct Task *RunQueuePrevious;
+
+    // The saved FPU/SSE/AVX state (aligned for XSAVE), which is allocated when the Task uses the FPU for the first time
+    void *FpuState;
+    void *FpuStateAllocation;
+
+    // The index of the processor that has loaded the FPU state the last time
+    int FpuCpu;
+
+    // The FS base of the Task in User Mode, which points to its Thread Local Storage
+    unsigned long FsBase;
+
+    // The threads of the User Mode process (0 for Kernel Mode Tasks), and the thread slot of the Task
+    struct ThreadGroup *ThreadGroup;
+    int ThreadSlot;
+
+    // The exit code of a terminated thread
+    long ExitCode;
+
+    // The trace ring that records the SysCalls of the Task, or 0x0 if the Task isn't traced
+    struct SysCallTrace *SysCallTrace;
 } Task;
 
+// A snapshot of the statistics of a Task, as returned by the SysCall "SYSCALL_GETTASKSTATISTICS".
+// The same structure is defined in the file "libc.h".
+typedef struct TaskStatistics
+{
+    unsigned long PID;
+    unsigned long Status;
+
+    // The CPU time in User Mode and in Kernel Mode, and the time in the status TASK_STATUS_WAITING (in nanoseconds)
+    unsigned long UserTime;
+    unsigned long KernelTime;
+    unsigned long WaitTime;
+
+    unsigned long ContextSwitches;
+    unsigned long VoluntaryContextSwitches;
+    unsigned long InvoluntaryContextSwitches;
+    unsigned long PageFaults;
+} TaskStatistics;
+
 // The Context Switching routine implemented in Assembler
 extern void Irq0_ContextSwitching();
 
 // The GetTaskState function implemented in Assembler
 extern Task *GetTaskState();
 
+// Gives up the CPU voluntarily, and continues with the next Task (implemented in Assembler).
+// Only the callee-saved registers are saved, and the Task continues by returning from this function.
+extern void SwitchToNextTask();
+
 // Creates a new Kernel Task
-Task* CreateKernelModeTask(void *TaskCode, unsigned long PID, unsigned long KernelModeStack);
+Task* CreateKernelModeTask(void *TaskCode, unsigned long KernelModeStack);
+
+// Initializes a new Kernel Mode Task structure without adding it to the TaskList
+static Task* InitKernelModeTask(void *TaskCode, unsigned long PID, unsigned long KernelModeStack);
+
+// Creates the Idle Task of the given processor
+Task* CreateIdleTask(int CpuIndex);
+
+// Adds the given Task to the end of the TaskList, and to the PID hash table
+static void AddTaskToTaskList(Task *Task);
 
-// Creates a new User Mode Task
-Task* ExecuteUserModeProgram(unsigned char *FileName, unsigned long PID);
+// Removes the given Task from the TaskList, and from the PID hash table
+static void RemoveTaskFromTaskList(Task *Task);
 
-// Loads the given program into a new User Mode Virtual Address Space
-static int LoadProgramIntoUserModeVirtualAddressSpace(unsigned char *FileName, unsigned long UserModePML4Table);
+// Initializes a new User Mode Task structure without adding it to the TaskList
+static Task* InitUserModeTask(unsigned long PID, unsigned long KernelModeStack, unsigned long CR3, unsigned long EntryPoint, unsigned long UserModeStack);
+
+// Creates a new User Mode Task with the given standard input and output, and returns its PID
+unsigned long ExecuteUserModeProgram(unsigned char *FileName, unsigned long StandardInput, unsigned long StandardOutput);
+
+// Creates a new thread in the User Mode process of the given Task, and returns its PID (the thread ID)
+unsigned long CreateUserModeThread(Task *Parent, unsigned long EntryPoint, unsigned long Argument, unsigned long ThreadPointer);
+
+// Loads the given program into a new User Mode Virtual Address Space, and maps the vDSO of the process with the given PID
+static int LoadProgramIntoUserModeVirtualAddressSpace(unsigned char *FileName, unsigned long UserModePML4Table, unsigned long PID);
 
 // Creates all initial OS tasks
 void CreateInitialTasks();
 
-// Moves the current Task from the head of the TaskList to the tail of the TaskList
-Task* MoveToNextTask();
+// Selects the next runnable Task of the current processor and programs the next timer interrupt
+Task* MoveToNextTask(Task *CurrentTask);
+
+// Adds the given runnable Task to the run queue of a processor
+void AddTaskToRunQueue(Task *Task);
+
+// Appends the given Task to the run queue of the given processor
+static void AppendToRunQueue(struct Cpu *Cpu, Task *Task);
+
+// Removes the next Task (or the Task to be stolen) from the run queue of the given processor
+static Task* TakeTaskFromRunQueue(struct Cpu *Cpu, int FromTail);
+
+// Removes the given Task from the given queue of a run queue
+static void UnlinkFromRunQueue(Task **Head, Task **Tail, Task *Task);
+
+// Returns the monotonic time when the time slice of the given Task ends, or TIMER_NOT_PENDING
+static unsigned long GetTimeSliceEnd(struct Cpu *Cpu, Task *Task, unsigned long Now);
+
+// Steals a runnable Task from the processor with the longest run queue
+static Task* StealTask(struct Cpu *Thief);
+
+// Selects the processor whose run queue receives a runnable Task
+static struct Cpu* SelectCpuForTask(Task *Task);
+
+// Returns 1 if the given processor executes its Idle Task, and has no runnable Tasks
+static int IsCpuIdle(struct Cpu *Cpu);
+
+// Allocates a Kernel Mode Stack for a User Mode Task
+static unsigned long AllocateKernelModeStack();
+
+// Releases the Kernel Mode Stack with the given starting address
+static void ReleaseKernelModeStack(unsigned long KernelModeStack);
 
-// Terminates the Kernel Mode Task with the given PID
-void TerminateTask(unsigned long PID);
+// Releases the resources of a terminated Task, after it was switched out
+static void ReleaseTask(Task *Task);
+
+// Accounts the CPU time of the given Task since its last accounting point
+void AccountCpuTime(Task *Task, int KernelMode);
+
+// Returns a snapshot of the statistics of all Tasks (including the Idle Task)
+int GetTaskStatistics(TaskStatistics *Buffer, int MaxEntries);
+
+// Copies the statistics of the given Task into the snapshot structure
+static void FillTaskStatistics(Task *Task, TaskStatistics *Statistics);
+
+// Records the scheduling latencies of the given Task, when it gets dispatched on the given processor
+static void RecordDispatchLatency(struct Cpu *Cpu, Task *Task);
+
+// Returns a snapshot of a latency histogram (LATENCY_RUNQUEUE or LATENCY_WAKEUP) of the Task with the given PID.
+// The PID 0 returns the system-wide histogram of all processors. It returns 0 if the Task doesn't exist.
+int GetLatencyHistogram(unsigned long PID, int Kind, LatencyHistogram *Buffer);
+
+// Sets the trace ring of the Task with the given PID (0x0 stops the tracing). It returns 0 if the Task doesn't exist.
+int SetSysCallTrace(unsigned long PID, struct SysCallTrace *Trace);
+
+// Blocks the given Task (the current one) for the given number of nanoseconds
+void SleepTask(Task *Task, unsigned long Nanoseconds);
+
+// Marks the current Task as waiting, before it registers itself where it gets woken up
+void PrepareToWait(Task *Task);
+
+// Marks the current Task as running again, when it hasn't blocked after "PrepareToWait"
+void FinishWait(Task *Task);
+
+// Makes the given Task runnable again (called by the Timer Wheel)
+void WakeUpTask(void *Context);
+
+// Gives up the CPU, and continues with the next runnable Task
+void YieldTask();
+
+// Increments the system date and refreshes the status line every second
+void InitSystemDateTimer();
+
+// Called by the Timer Wheel every second to increment the system date
+static void SystemDateTimerCallback(void *Context);
+
+// The Idle Task halts the CPU until the next interrupt arrives
+void IdleTask();
+
+// Terminates the current Task
+void TerminateTask();
 
 // Refreshs the status line
 void RefreshStatusLine();
 
+// Refreshs the status line from a Worker Task of the Work Queue
+static void RefreshStatusLineWork(void *Context);
+
 // Prints out the TaskList entries
 void PrintTaskList();
 
-// This function continuously checks if there is a new User Mode program to be started
-void StartUserModeTask();
-
 // Prints out the status as text
 static void PrintStatus(int Status);
 
@@ -0,0 +1,110 @@
+#include "pid.h"
+#include "spinlock.h"
+
+// One bit for each PID, which is set while the PID is in use (PID 0 is reserved for the Idle Tasks)
+unsigned long pidBitmap[PID_BITMAP_WORDS] = { 0x1 };
+
+// The next PID that is checked by "AllocatePid"
+unsigned long nextPid = 1;
+
+// The hash table that maps a PID to its Task.
+// The Tasks of a bucket are chained through their field "PidHashNext", so adding a Task doesn't allocate any memory.
+Task *pidHashTable[PID_HASH_BUCKETS];
+
+// Protects the PID bitmap and the PID hash table
+Spinlock pidLock = SPINLOCK_INITIALIZER("Pids");
+
+// Allocates a new unique PID. It returns 0 if all PIDs are in use.
+// The PIDs are allocated in ascending order and wrap around at MAX_PID, so a released PID isn't reused immediately.
+unsigned long AllocatePid()
+{
+    unsigned long flags = AcquireSpinlockIrqSave(&pidLock);
+    unsigned long pid = nextPid;
+    unsigned long checked = 0;
+
+    while (checked <= MAX_PID)
+    {
+        if (pid > MAX_PID)
+            pid = 0;
+
+        // Skip the remaining PIDs of a completely used bitmap word
+        if (pidBitmap[pid / 64] == ~0UL)
+        {
+            checked += 64 - (pid % 64);
+            pid += 64 - (pid % 64);
+            continue;
+        }
+
+        if ((pidBitmap[pid / 64] & (1UL << (pid % 64))) == 0)
+        {
+            pidBitmap[pid / 64] |= 1UL << (pid % 64);
+            nextPid = pid + 1;
+            ReleaseSpinlockIrqRestore(&pidLock, flags);
+
+            return pid;
+        }
+
+        checked++;
+        pid++;
+    }
+
+    ReleaseSpinlockIrqRestore(&pidLock, flags);
+
+    return 0;
+}
+
+// Releases the given PID, so that it can be allocated again
+void ReleasePid(unsigned long PID)
+{
+    unsigned long flags;
+
+    if ((PID == 0) || (PID > MAX_PID))
+        return;
+
+    flags = AcquireSpinlockIrqSave(&pidLock);
+    pidBitmap[PID / 64] &= ~(1UL << (PID % 64));
+    ReleaseSpinlockIrqRestore(&pidLock, flags);
+}
+
+// Adds the given Task to the PID hash table
+void AddTaskToPidTable(Task *Task)
+{
+    unsigned long flags = AcquireSpinlockIrqSave(&pidLock);
+    unsigned long bucket = Task->PID & PID_HASH_MASK;
+
+    Task->PidHashNext = pidHashTable[bucket];
+    pidHashTable[bucket] = Task;
+
+    ReleaseSpinlockIrqRestore(&pidLock, flags);
+}
+
+// Removes the given Task from the PID hash table
+void RemoveTaskFromPidTable(Task *Task)
+{
+    unsigned long flags = AcquireSpinlockIrqSave(&pidLock);
+    struct Task **current = &pidHashTable[Task->PID & PID_HASH_MASK];
+
+    while ((*current != 0x0) && (*current != Task))
+        current = &(*current)->PidHashNext;
+
+    if (*current != 0x0)
+        *current = Task->PidHashNext;
+
+    Task->PidHashNext = 0x0;
+    ReleaseSpinlockIrqRestore(&pidLock, flags);
+}
+
+// Returns the Task with the given PID, or 0 if no such Task exists.
+// The Task structure is released after the Task has terminated, so the caller must not keep the pointer for long.
+Task *FindTaskByPid(unsigned long PID)
+{
+    unsigned long flags = AcquireSpinlockIrqSave(&pidLock);
+    Task *task = pidHashTable[PID & PID_HASH_MASK];
+
+    while ((task != 0x0) && (task->PID != PID))
+        task = task->PidHashNext;
+
+    ReleaseSpinlockIrqRestore(&pidLock, flags);
+
+    return task;
+}
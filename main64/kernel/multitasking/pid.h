@@ -0,0 +1,31 @@
+#ifndef PID_H
+#define PID_H
+
+#include "multitasking.h"
+
+// The highest PID. PID 0 is reserved for the Idle Tasks of the processors.
+#define MAX_PID                 32767
+
+// The PID bitmap has one bit for each PID, which is set while the PID is in use
+#define PID_BITMAP_WORDS        ((MAX_PID + 1) / 64)
+
+// The number of buckets of the hash table that maps a PID to its Task (must be a power of 2)
+#define PID_HASH_BUCKETS        256
+#define PID_HASH_MASK           (PID_HASH_BUCKETS - 1)
+
+// Allocates a new unique PID. It returns 0 if all PIDs are in use.
+unsigned long AllocatePid();
+
+// Releases the given PID, so that it can be allocated again
+void ReleasePid(unsigned long PID);
+
+// Adds the given Task to the PID hash table
+void AddTaskToPidTable(Task *Task);
+
+// Removes the given Task from the PID hash table
+void RemoveTaskFromPidTable(Task *Task);
+
+// Returns the Task with the given PID, or 0 if no such Task exists
+Task *FindTaskByPid(unsigned long PID);
+
+#endif
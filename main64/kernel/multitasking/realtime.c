@@ -0,0 +1,133 @@
+#include "realtime.h"
+#include "smp.h"
+#include "spinlock.h"
+#include "../drivers/timer.h"
+
+// The sum of the utilizations of all admitted Real-Time Tasks (in parts per million of a processor)
+unsigned long rtAdmittedUtilization = 0;
+Spinlock rtBandwidthLock = SPINLOCK_INITIALIZER("RtBandwidth");
+
+// Moves the given Task into the Real-Time scheduling class, or back into the normal class with a negative priority.
+// The Task may run for "Runtime" nanoseconds in each period of "Period" nanoseconds. It returns 0 if the Task wasn't admitted.
+// The admission control guarantees that the admitted Real-Time Tasks can't use the whole CPU time of the system.
+int SetRealTimeScheduling(Task *Task, int Priority, unsigned long Runtime, unsigned long Period)
+{
+    unsigned long utilization = 0;
+    unsigned long flags;
+
+    if (Priority >= RT_PRIORITIES)
+        return 0;
+
+    if (Priority >= 0)
+    {
+        if ((Period < RT_MIN_PERIOD_NANOSECONDS) || (Period > RT_MAX_PERIOD_NANOSECONDS) || (Runtime == 0) || (Runtime > Period))
+            return 0;
+
+        utilization = Runtime * RT_UTILIZATION_SCALE / Period;
+    }
+
+    flags = AcquireSpinlockIrqSave(&rtBandwidthLock);
+
+    // The bandwidth of the previous parameters is given back first
+    if ((rtAdmittedUtilization - Task->RtUtilization + utilization) > (unsigned long)GetCpuCount() * RT_MAX_UTILIZATION)
+    {
+        ReleaseSpinlockIrqRestore(&rtBandwidthLock, flags);
+        return 0;
+    }
+
+    rtAdmittedUtilization = rtAdmittedUtilization - Task->RtUtilization + utilization;
+    Task->RtUtilization = utilization;
+    ReleaseSpinlockIrqRestore(&rtBandwidthLock, flags);
+
+    if (Priority >= 0)
+    {
+        Task->RtPriority = Priority;
+        Task->RtRuntime = Runtime;
+        Task->RtPeriod = Period;
+        Task->RtPeriodStart = GetMonotonicTime();
+        Task->RtConsumed = 0;
+        Task->RtThrottled = 0;
+        Task->RtRunTimestamp = Task->RtPeriodStart;
+        Task->SchedulingClass = SCHED_CLASS_REALTIME;
+    }
+    else
+    {
+        Task->SchedulingClass = SCHED_CLASS_NORMAL;
+        Task->RtPriority = 0;
+        Task->RtThrottled = 0;
+    }
+
+    return 1;
+}
+
+// Releases the CPU bandwidth that was admitted to the given Task
+void ReleaseRealTimeBandwidth(Task *Task)
+{
+    unsigned long flags;
+
+    if (Task->RtUtilization == 0)
+        return;
+
+    flags = AcquireSpinlockIrqSave(&rtBandwidthLock);
+    rtAdmittedUtilization -= Task->RtUtilization;
+    Task->RtUtilization = 0;
+    ReleaseSpinlockIrqRestore(&rtBandwidthLock, flags);
+}
+
+// Returns 1 if the given Task is scheduled as a Real-Time Task (it's not throttled)
+int IsRealTimeTask(Task *Task)
+{
+    return (Task->SchedulingClass == SCHED_CLASS_REALTIME) && (Task->RtThrottled == 0);
+}
+
+// Returns 1 if the given Task has to preempt the Task that is currently executed.
+// A Real-Time Task preempts the normal Tasks and the Real-Time Tasks with a lower priority.
+int PreemptsTask(Task *Task, struct Task *CurrentTask)
+{
+    if (!IsRealTimeTask(Task))
+        return 0;
+
+    if (!IsRealTimeTask(CurrentTask))
+        return 1;
+
+    return Task->RtPriority > CurrentTask->RtPriority;
+}
+
+// Charges the runtime since the Task was scheduled to its budget, and throttles the Task when its budget is exhausted.
+// A throttled Task is scheduled like a normal Task until its next period, so a misbehaving Real-Time Task can't
+// starve the rest of the system.
+void ChargeRealTimeRuntime(Task *Task, unsigned long Now)
+{
+    if (!IsRealTimeTask(Task))
+        return;
+
+    Task->RtConsumed += Now - Task->RtRunTimestamp;
+    Task->RtRunTimestamp = Now;
+
+    if (Task->RtConsumed >= Task->RtRuntime)
+    {
+        Task->RtThrottled = 1;
+        Task->RtThrottleCount++;
+    }
+}
+
+// Refills the budget of the given Task, when its current period has ended
+void ReplenishRealTimeBudget(Task *Task, unsigned long Now)
+{
+    if ((Task->SchedulingClass != SCHED_CLASS_REALTIME) || (Now < Task->RtPeriodStart + Task->RtPeriod))
+        return;
+
+    // The new period starts at the last period boundary, so the periods stay aligned to the first one
+    Task->RtPeriodStart = Now - (Now - Task->RtPeriodStart) % Task->RtPeriod;
+    Task->RtConsumed = 0;
+    Task->RtThrottled = 0;
+}
+
+// Returns the monotonic time when the remaining budget of the given Real-Time Task is exhausted
+unsigned long GetRealTimeBudgetEnd(Task *Task, unsigned long Now)
+{
+    if (Task->RtConsumed >= Task->RtRuntime)
+        return Now;
+
+    return Now + Task->RtRuntime - Task->RtConsumed;
+}
@@ -0,0 +1,57 @@
+#ifndef REALTIME_H
+#define REALTIME_H
+
+#include "multitasking.h"
+
+// The scheduling classes of a Task.
+// A runnable Real-Time Task always preempts the Tasks of the normal scheduling class.
+#define SCHED_CLASS_NORMAL              0x0
+#define SCHED_CLASS_REALTIME            0x1
+
+// The number of fixed Real-Time priorities (0 is the lowest priority)
+#define RT_PRIORITIES                   32
+
+// The Real-Time priorities of the Kernel Mode Tasks, which are handling the input and the deferred interrupt work
+#define RT_PRIORITY_INPUT               24
+#define RT_PRIORITY_WORK_QUEUE          16
+
+// The User Mode Tasks can only use the priorities below the Kernel Mode Real-Time Tasks
+#define RT_MAX_USER_PRIORITY            (RT_PRIORITY_WORK_QUEUE - 1)
+
+// The runtime budgets of the Kernel Mode Real-Time Tasks
+#define RT_KERNEL_RUNTIME_NANOSECONDS   2000000
+#define RT_KERNEL_PERIOD_NANOSECONDS    10000000
+
+// The shortest and the longest possible period of a Real-Time Task.
+// The upper bound keeps the utilization calculation and the period arithmetic free of overflows.
+#define RT_MIN_PERIOD_NANOSECONDS       100000
+#define RT_MAX_PERIOD_NANOSECONDS       10000000000
+
+// The Real-Time Tasks are admitted until they can use 95% of each processor (in parts per million of a processor).
+// The remaining CPU time is left to the normal Tasks.
+#define RT_MAX_UTILIZATION              950000
+#define RT_UTILIZATION_SCALE            1000000
+
+// Moves the given Task into the Real-Time scheduling class, or back into the normal class with a negative priority.
+// The Task may run for "Runtime" nanoseconds in each period of "Period" nanoseconds. It returns 0 if the Task wasn't admitted.
+int SetRealTimeScheduling(Task *Task, int Priority, unsigned long Runtime, unsigned long Period);
+
+// Releases the CPU bandwidth that was admitted to the given Task
+void ReleaseRealTimeBandwidth(Task *Task);
+
+// Returns 1 if the given Task is scheduled as a Real-Time Task (it's not throttled)
+int IsRealTimeTask(Task *Task);
+
+// Returns 1 if the given Task has to preempt the Task that is currently executed
+int PreemptsTask(Task *Task, struct Task *CurrentTask);
+
+// Charges the runtime since the Task was scheduled to its budget, and throttles the Task when its budget is exhausted
+void ChargeRealTimeRuntime(Task *Task, unsigned long Now);
+
+// Refills the budget of the given Task, when its current period has ended
+void ReplenishRealTimeBudget(Task *Task, unsigned long Now);
+
+// Returns the monotonic time when the remaining budget of the given Real-Time Task is exhausted
+unsigned long GetRealTimeBudgetEnd(Task *Task, unsigned long Now);
+
+#endif
@@ -0,0 +1,209 @@
+#include "semaphore.h"
+
+// Initializes a Mutex with the given name
+void InitMutex(Mutex *Mutex, char *Name)
+{
+    Mutex->Locked = 0;
+    Mutex->Owner = 0x0;
+    InitWaitQueue(&Mutex->Waiters, Name);
+}
+
+// Acquires a Mutex. The current Task is blocked while another Task holds the Mutex.
+// The releasing Task hands the Mutex directly over to the first waiting Task, therefore it's granted in FIFO order.
+void AcquireMutex(Mutex *Mutex)
+{
+    unsigned long flags = AcquireSpinlockIrqSave(&Mutex->Waiters.Lock);
+    WaitQueueEntry entry;
+
+    if (Mutex->Locked == 0)
+    {
+        Mutex->Locked = 1;
+        Mutex->Owner = GetTaskState();
+    }
+    else
+    {
+        // When we are woken up, we are already the new owner of the Mutex
+        SleepOnWaitQueue(&Mutex->Waiters, &entry, 1);
+    }
+
+    ReleaseSpinlockIrqRestore(&Mutex->Waiters.Lock, flags);
+}
+
+// Tries to acquire a Mutex without blocking. It returns 1 if the Mutex was acquired.
+int TryAcquireMutex(Mutex *Mutex)
+{
+    unsigned long flags = AcquireSpinlockIrqSave(&Mutex->Waiters.Lock);
+    int acquired = 0;
+
+    if (Mutex->Locked == 0)
+    {
+        Mutex->Locked = 1;
+        Mutex->Owner = GetTaskState();
+        acquired = 1;
+    }
+
+    ReleaseSpinlockIrqRestore(&Mutex->Waiters.Lock, flags);
+
+    return acquired;
+}
+
+// Releases a Mutex, and hands it over to the next waiting Task
+void ReleaseMutex(Mutex *Mutex)
+{
+    unsigned long flags = AcquireSpinlockIrqSave(&Mutex->Waiters.Lock);
+    Task *nextOwner = WakeUpFirstWaiter(&Mutex->Waiters);
+
+    // The Mutex stays locked, when it was handed over to a waiting Task
+    Mutex->Owner = nextOwner;
+    Mutex->Locked = nextOwner != 0x0;
+
+    ReleaseSpinlockIrqRestore(&Mutex->Waiters.Lock, flags);
+}
+
+// Initializes a Semaphore with the given name and initial count
+void InitSemaphore(Semaphore *Semaphore, char *Name, long Count)
+{
+    Semaphore->Count = Count;
+    InitWaitQueue(&Semaphore->Waiters, Name);
+}
+
+// Decrements the count of a Semaphore. The current Task is blocked while the count is 0.
+void DownSemaphore(Semaphore *Semaphore)
+{
+    unsigned long flags = AcquireSpinlockIrqSave(&Semaphore->Waiters.Lock);
+    WaitQueueEntry entry;
+
+    if (Semaphore->Count > 0)
+        Semaphore->Count--;
+    else
+    {
+        // The releasing Task hands its unit directly over to us, so the count isn't incremented in the meantime
+        SleepOnWaitQueue(&Semaphore->Waiters, &entry, 1);
+    }
+
+    ReleaseSpinlockIrqRestore(&Semaphore->Waiters.Lock, flags);
+}
+
+// Tries to decrement the count of a Semaphore without blocking. It returns 1 if the count was decremented.
+int TryDownSemaphore(Semaphore *Semaphore)
+{
+    unsigned long flags = AcquireSpinlockIrqSave(&Semaphore->Waiters.Lock);
+    int decremented = 0;
+
+    if (Semaphore->Count > 0)
+    {
+        Semaphore->Count--;
+        decremented = 1;
+    }
+
+    ReleaseSpinlockIrqRestore(&Semaphore->Waiters.Lock, flags);
+
+    return decremented;
+}
+
+// Increments the count of a Semaphore, or hands it over to the next waiting Task
+void UpSemaphore(Semaphore *Semaphore)
+{
+    unsigned long flags = AcquireSpinlockIrqSave(&Semaphore->Waiters.Lock);
+
+    if (WakeUpFirstWaiter(&Semaphore->Waiters) == 0x0)
+        Semaphore->Count++;
+
+    ReleaseSpinlockIrqRestore(&Semaphore->Waiters.Lock, flags);
+}
+
+// Initializes a Reader-Writer Semaphore with the given name
+void InitRwSemaphore(RwSemaphore *Semaphore, char *Name)
+{
+    Semaphore->Readers = 0;
+    Semaphore->Writer = 0;
+    InitWaitQueue(&Semaphore->Waiters, Name);
+}
+
+// Acquires a Reader-Writer Semaphore for reading.
+// The reader proceeds immediately, when no writer holds the Semaphore and no other Task waits for it.
+void AcquireReadSemaphore(RwSemaphore *Semaphore)
+{
+    unsigned long flags = AcquireSpinlockIrqSave(&Semaphore->Waiters.Lock);
+    WaitQueueEntry entry;
+
+    if ((Semaphore->Writer == 0) && (PeekWaitQueue(&Semaphore->Waiters) == 0x0))
+        Semaphore->Readers++;
+    else
+    {
+        // The reader was already counted by "GrantRwSemaphore", when we are woken up
+        SleepOnWaitQueue(&Semaphore->Waiters, &entry, 0);
+    }
+
+    ReleaseSpinlockIrqRestore(&Semaphore->Waiters.Lock, flags);
+}
+
+// Releases a Reader-Writer Semaphore that was acquired for reading
+void ReleaseReadSemaphore(RwSemaphore *Semaphore)
+{
+    unsigned long flags = AcquireSpinlockIrqSave(&Semaphore->Waiters.Lock);
+
+    Semaphore->Readers--;
+
+    // The last reader hands the Semaphore over to a waiting writer
+    if (Semaphore->Readers == 0)
+        GrantRwSemaphore(Semaphore);
+
+    ReleaseSpinlockIrqRestore(&Semaphore->Waiters.Lock, flags);
+}
+
+// Acquires a Reader-Writer Semaphore for writing
+void AcquireWriteSemaphore(RwSemaphore *Semaphore)
+{
+    unsigned long flags = AcquireSpinlockIrqSave(&Semaphore->Waiters.Lock);
+    WaitQueueEntry entry;
+
+    if ((Semaphore->Writer == 0) && (Semaphore->Readers == 0) && (PeekWaitQueue(&Semaphore->Waiters) == 0x0))
+        Semaphore->Writer = 1;
+    else
+    {
+        // The writer was already registered by "GrantRwSemaphore", when we are woken up
+        SleepOnWaitQueue(&Semaphore->Waiters, &entry, 1);
+    }
+
+    ReleaseSpinlockIrqRestore(&Semaphore->Waiters.Lock, flags);
+}
+
+// Releases a Reader-Writer Semaphore that was acquired for writing
+void ReleaseWriteSemaphore(RwSemaphore *Semaphore)
+{
+    unsigned long flags = AcquireSpinlockIrqSave(&Semaphore->Waiters.Lock);
+
+    Semaphore->Writer = 0;
+    GrantRwSemaphore(Semaphore);
+
+    ReleaseSpinlockIrqRestore(&Semaphore->Waiters.Lock, flags);
+}
+
+// Hands over a Reader-Writer Semaphore to the waiting Tasks at the head of its Wait Queue.
+// Either the first waiting writer, or all consecutive waiting readers are woken up.
+// The caller must hold the lock of the Wait Queue.
+static void GrantRwSemaphore(RwSemaphore *Semaphore)
+{
+    WaitQueueEntry *entry;
+
+    while ((entry = PeekWaitQueue(&Semaphore->Waiters)) != 0x0)
+    {
+        if (entry->Exclusive)
+        {
+            if ((Semaphore->Readers == 0) && (Semaphore->Writer == 0))
+            {
+                Semaphore->Writer = 1;
+                WakeUpFirstWaiter(&Semaphore->Waiters);
+            }
+
+            return;
+        }
+
+        if (Semaphore->Writer != 0)
+            return;
+
+        Semaphore->Readers++;
+        WakeUpFirstWaiter(&Semaphore->Waiters);
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef SEMAPHORE_H
+#define SEMAPHORE_H
+
+#include "waitqueue.h"
+
+// Initializes statically allocated sleeping locks with the given name
+#define MUTEX_INITIALIZER(name) { .Waiters = WAIT_QUEUE_INITIALIZER(name) }
+#define SEMAPHORE_INITIALIZER(name, count) { .Count = count, .Waiters = WAIT_QUEUE_INITIALIZER(name) }
+#define RW_SEMAPHORE_INITIALIZER(name) { .Waiters = WAIT_QUEUE_INITIALIZER(name) }
+
+// Represents a sleeping Mutex.
+// A contended Task is blocked on the Wait Queue instead of spinning, so the Mutex can be held across long operations
+// (like ATA PIO transfers). It must not be used from Interrupt Handlers.
+typedef struct Mutex
+{
+    int Locked;
+
+    // The Task that holds the Mutex
+    Task *Owner;
+
+    WaitQueue Waiters;
+} Mutex;
+
+// Represents a counting Semaphore
+typedef struct Semaphore
+{
+    long Count;
+    WaitQueue Waiters;
+} Semaphore;
+
+// Represents a Reader-Writer Semaphore.
+// Several readers can hold it in parallel, while a writer holds it exclusively.
+// A new reader also waits when a writer is queued, so that the writers are not starved by a stream of readers.
+typedef struct RwSemaphore
+{
+    // The number of readers that are holding the Semaphore, and 1 when a writer holds it
+    int Readers;
+    int Writer;
+
+    WaitQueue Waiters;
+} RwSemaphore;
+
+// Initializes a Mutex with the given name
+void InitMutex(Mutex *Mutex, char *Name);
+
+// Acquires a Mutex. The current Task is blocked while another Task holds the Mutex.
+void AcquireMutex(Mutex *Mutex);
+
+// Tries to acquire a Mutex without blocking. It returns 1 if the Mutex was acquired.
+int TryAcquireMutex(Mutex *Mutex);
+
+// Releases a Mutex, and hands it over to the next waiting Task
+void ReleaseMutex(Mutex *Mutex);
+
+// Initializes a Semaphore with the given name and initial count
+void InitSemaphore(Semaphore *Semaphore, char *Name, long Count);
+
+// Decrements the count of a Semaphore. The current Task is blocked while the count is 0.
+void DownSemaphore(Semaphore *Semaphore);
+
+// Tries to decrement the count of a Semaphore without blocking. It returns 1 if the count was decremented.
+int TryDownSemaphore(Semaphore *Semaphore);
+
+// Increments the count of a Semaphore, or hands it over to the next waiting Task
+void UpSemaphore(Semaphore *Semaphore);
+
+// Initializes a Reader-Writer Semaphore with the given name
+void InitRwSemaphore(RwSemaphore *Semaphore, char *Name);
+
+// Acquires a Reader-Writer Semaphore for reading
+void AcquireReadSemaphore(RwSemaphore *Semaphore);
+
+// Releases a Reader-Writer Semaphore that was acquired for reading
+void ReleaseReadSemaphore(RwSemaphore *Semaphore);
+
+// Acquires a Reader-Writer Semaphore for writing
+void AcquireWriteSemaphore(RwSemaphore *Semaphore);
+
+// Releases a Reader-Writer Semaphore that was acquired for writing
+void ReleaseWriteSemaphore(RwSemaphore *Semaphore);
+
+// Hands over a Reader-Writer Semaphore to the waiting Tasks at the head of its Wait Queue
+static void GrantRwSemaphore(RwSemaphore *Semaphore);
+
+#endif
@@ -0,0 +1,104 @@
+; =================================================================================
+; This file implements the AP Trampoline, which brings an Application Processor
+; from the Real Mode through the Protected Mode into the Long Mode.
+; The code is copied by "StartApplicationProcessors" to the physical address
+; 0x8000, where the Application Processor starts after the Startup IPI.
+; =================================================================================
+[BITS 16]
+[GLOBAL ApTrampoline]
+[GLOBAL ApTrampolineEnd]
+[GLOBAL ApStartupData]
+
+; The physical address where the AP Trampoline is copied to
+AP_TRAMPOLINE_ADDRESS   EQU 0x8000
+
+; Translates a label of the AP Trampoline into its physical address after the copy
+%DEFINE TRAMPOLINE(label) (AP_TRAMPOLINE_ADDRESS + (label - ApTrampoline))
+
+; The Segment Selectors of the temporary GDT.
+; The 64 bit Code Segment uses the same selector as in the GDT of the Kernel.
+CODE64_SEG              EQU 0x08
+DATA_SEG                EQU 0x10
+CODE32_SEG              EQU 0x18
+
+ApTrampoline:
+    CLI
+    CLD
+
+    XOR     AX, AX
+    MOV     DS, AX
+    MOV     ES, AX
+    MOV     SS, AX
+
+    ; Load the temporary GDT, and switch into the Protected Mode
+    LGDT    [TRAMPOLINE(ApGdtPointer)]
+    MOV     EAX, CR0
+    OR      EAX, 0x1
+    MOV     CR0, EAX
+    JMP     DWORD CODE32_SEG:TRAMPOLINE(ApProtectedMode)
+
+[BITS 32]
+ApProtectedMode:
+    MOV     AX, DATA_SEG
+    MOV     DS, AX
+    MOV     ES, AX
+    MOV     SS, AX
+
+    ; Set the PAE and PGE bit (like KLDR16.BIN does for the Bootstrap Processor)
+    MOV     EAX, 10100000b
+    MOV     CR4, EAX
+
+    ; Use the PML4 table of the Kernel, which identity maps the AP Trampoline
+    MOV     EAX, [TRAMPOLINE(ApPml4)]
+    MOV     CR3, EAX
+
+    ; Set the LME bit in the EFER MSR
+    MOV     ECX, 0xC0000080
+    RDMSR
+    OR      EAX, 0x00000100
+    WRMSR
+
+    ; Activate the Long Mode by enabling paging.
+    ; The Write Protect bit protects the read-only pages also against Kernel Mode writes.
+    MOV     EAX, CR0
+    OR      EAX, 0x80010000
+    MOV     CR0, EAX
+    JMP     CODE64_SEG:TRAMPOLINE(ApLongMode)
+
+[BITS 64]
+ApLongMode:
+    MOV     AX, DATA_SEG
+    MOV     DS, AX
+    MOV     ES, AX
+    MOV     SS, AX
+    XOR     AX, AX
+    MOV     FS, AX
+    MOV     GS, AX
+
+    ; Switch to the Stack of the Application Processor, and continue in the Higher Half.
+    ; The 1st parameter of "ApMain" is the index of the processor.
+    MOV     RSP, [TRAMPOLINE(ApStack)]
+    MOV     RDI, [TRAMPOLINE(ApCpuIndex)]
+    MOV     RAX, [TRAMPOLINE(ApEntryPoint)]
+    JMP     RAX
+
+; The temporary GDT of the AP Trampoline
+ALIGN 8
+ApGdt:
+    DQ 0x0000000000000000                       ; Null Descriptor
+    DQ 0x00209A0000000000                       ; 64 bit Code Segment
+    DQ 0x00CF92000000FFFF                       ; Data Segment
+    DQ 0x00CF9A000000FFFF                       ; 32 bit Code Segment
+
+ApGdtPointer:
+    DW ApGdtPointer - ApGdt - 1
+    DD TRAMPOLINE(ApGdt)
+
+; The startup parameters (C structure "ApStartupParameters"), which are filled out for each Application Processor
+ALIGN 8
+ApStartupData:
+ApPml4:         DQ 0
+ApStack:        DQ 0
+ApEntryPoint:   DQ 0
+ApCpuIndex:     DQ 0
+ApTrampolineEnd:
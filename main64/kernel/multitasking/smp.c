@@ -0,0 +1,226 @@
+#include "smp.h"
+#include "fpu.h"
+#include "../isr/idt.h"
+#include "../isr/apic.h"
+#include "../common.h"
+#include "../drivers/acpi.h"
+#include "../drivers/timer.h"
+#include "../drivers/screen.h"
+#include "../memory/virtual-memory.h"
+#include "../syscalls/syscall.h"
+
+// All processors of the system - the Bootstrap Processor is stored at index 0
+Cpu cpus[MAX_CPUS];
+int cpuCount = 1;
+
+// Translates the ID of a Local APIC into the index of its processor
+unsigned char cpuIndexByApicId[256];
+
+// Set by the Bootstrap Processor as soon as the Application Processors are allowed to execute Tasks
+volatile int applicationProcessorsReleased = 0;
+
+// Serializes the SysCalls across the processors.
+// It's the most contended lock, therefore it's a MCS Lock where every waiting processor spins on its own queue node.
+McsLock kernelLock = SPINLOCK_INITIALIZER("Kernel");
+
+// Points the GS base of the Bootstrap Processor to its per-CPU data area.
+// It's called as the first step of the Kernel initialization, because every interrupt handler depends on it.
+void InitBootCpu()
+{
+    LoadPerCpuArea(&cpus[0]);
+}
+
+// Initializes the Bootstrap Processor, and finds the Application Processors in the ACPI tables
+void InitSmp()
+{
+    unsigned int apicIds[MAX_CPUS];
+    unsigned int bspApicId = ApicGetId();
+    int count;
+    int i;
+
+    memset(cpuIndexByApicId, 0, sizeof(cpuIndexByApicId));
+
+    // The Bootstrap Processor has the index 0
+    InitCpu(0, bspApicId);
+    cpus[0].Tss->ist1 = SCHEDULER_STACK;
+    cpus[0].Online = 1;
+
+    // Every other processor from the MADT is an Application Processor.
+    // Without a MADT we only use the Bootstrap Processor.
+    count = AcpiGetLocalApicIds(apicIds, MAX_CPUS);
+
+    for (i = 0; i < count; i++)
+    {
+        if ((apicIds[i] != bspApicId) && (cpuCount < MAX_CPUS))
+        {
+            InitCpu(cpuCount, apicIds[i]);
+            cpuCount++;
+        }
+    }
+}
+
+// Initializes the structure of the given processor
+static void InitCpu(int Index, unsigned int ApicId)
+{
+    Cpu *cpu = &cpus[Index];
+    unsigned long schedulerStack = SCHEDULER_STACK - Index * SCHEDULER_STACK_SIZE;
+
+    cpu->Index = Index;
+    cpu->ApicId = ApicId;
+    cpu->Tss = GetTss(Index);
+    cpuIndexByApicId[ApicId & 0xFF] = Index;
+    InitSpinlock(&cpu->RunQueueLock, "RunQueue");
+
+    // Each processor has its own Idle Task, which is not part of any run queue
+    cpu->IdleTask = CreateIdleTask(Index);
+    cpu->CurrentTask = 0x0;
+
+    // The Scheduler Stack is touched completely, because the Context Switching routine can't handle a Page Fault on it
+    memset((void *)(schedulerStack - SCHEDULER_STACK_SIZE), 0, SCHEDULER_STACK_SIZE);
+}
+
+// Starts all Application Processors through the INIT-SIPI-SIPI sequence.
+// The processors are started one after another, because they share the AP Trampoline and its startup parameters.
+void StartApplicationProcessors()
+{
+    int i;
+
+    if (cpuCount == 1)
+        return;
+
+    // Copy the AP Trampoline below 1 MB, where the Application Processors start in Real Mode
+    memcpy((void *)AP_TRAMPOLINE_VIRTUAL, ApTrampoline, ApTrampolineEnd - ApTrampoline);
+
+    for (i = 1; i < cpuCount; i++)
+        StartApplicationProcessor(&cpus[i]);
+}
+
+// Starts the given Application Processor through the INIT-SIPI-SIPI sequence
+static void StartApplicationProcessor(Cpu *Cpu)
+{
+    ApStartupParameters *parameters = (ApStartupParameters *)(AP_TRAMPOLINE_VIRTUAL + (ApStartupData - ApTrampoline));
+    unsigned long timeout;
+
+    // The Application Processor uses the PML4 table of the Kernel, and starts on the Stack of its Idle Task
+    parameters->PML4 = GetPML4Address();
+    parameters->Stack = Cpu->IdleTask->KernelModeStack;
+    parameters->EntryPoint = (unsigned long)ApMain;
+    parameters->CpuIndex = Cpu->Index;
+
+    // Reset the Application Processor through an INIT IPI
+    ApicSendIpi(Cpu->ApicId, APIC_ICR_INIT | APIC_ICR_LEVEL_ASSERT | APIC_ICR_TRIGGER_LEVEL);
+    BusyWait(AP_INIT_DELAY_NANOSECONDS);
+
+    // Start the Application Processor at the AP Trampoline.
+    // The 2nd Startup IPI is only sent, when the processor has ignored the 1st one.
+    ApicSendIpi(Cpu->ApicId, APIC_ICR_STARTUP | AP_STARTUP_VECTOR);
+    BusyWait(AP_STARTUP_DELAY_NANOSECONDS);
+
+    if (Cpu->Online == 0)
+        ApicSendIpi(Cpu->ApicId, APIC_ICR_STARTUP | AP_STARTUP_VECTOR);
+
+    // Wait until the Application Processor reports itself as online
+    timeout = GetMonotonicTime() + AP_ONLINE_TIMEOUT_NANOSECONDS;
+
+    while ((Cpu->Online == 0) && (GetMonotonicTime() < timeout))
+        asm volatile("pause");
+
+    if (Cpu->Online == 0)
+    {
+        printf("Application Processor with the Local APIC ID ");
+        printf_int(Cpu->ApicId, 10);
+        printf(" has not started\n");
+    }
+}
+
+// Lets the Application Processors execute Tasks, after the Context Switching was installed
+void ReleaseApplicationProcessors()
+{
+    __atomic_store_n(&applicationProcessorsReleased, 1, __ATOMIC_RELEASE);
+}
+
+// The entry point of an Application Processor in the Higher Half (called by the AP Trampoline)
+void ApMain(int CpuIndex)
+{
+    Cpu *cpu = &cpus[CpuIndex];
+
+    // The interrupt handlers are reaching the per-CPU data area through the GS base
+    LoadPerCpuArea(cpu);
+
+    // All processors share the same IDT, but every processor has its own GDT and TSS
+    LoadIdt();
+    InitGdt(CpuIndex);
+    InitFastSysCalls();
+    DisableInterrupts();
+    cpu->Tss->ist1 = SCHEDULER_STACK - CpuIndex * SCHEDULER_STACK_SIZE;
+
+    // Initialize the FPU, the Local APIC and its timer
+    InitFpu();
+    EnableLocalApic();
+    InitTimerMode();
+
+    // The processor is now online
+    __atomic_store_n(&cpu->Online, 1, __ATOMIC_RELEASE);
+
+    // Wait until the Bootstrap Processor has installed the Context Switching
+    while (__atomic_load_n(&applicationProcessorsReleased, __ATOMIC_ACQUIRE) == 0)
+        asm volatile("pause");
+
+    // Raise the first timer interrupt, which schedules the first Task of this processor.
+    // The startup code path has no current Task in the per-CPU data area, therefore it is never continued.
+    ProgramTimerInterrupt(0);
+
+    asm volatile(
+        "sti\n"
+        "1: hlt\n"
+        "jmp 1b");
+}
+
+// Points the GS base of the current processor to the given per-CPU data area.
+// The GS base of User Mode is 0, and it's swapped in through SWAPGS whenever the processor returns into User Mode.
+static void LoadPerCpuArea(Cpu *Cpu)
+{
+    Cpu->Self = Cpu;
+    wrmsr(IA32_GS_BASE, (unsigned long)Cpu);
+    wrmsr(IA32_KERNEL_GS_BASE, 0);
+}
+
+// Returns the current processor
+Cpu *GetCurrentCpu()
+{
+    Cpu *cpu;
+
+    asm volatile("mov %%gs:0, %0" : "=r" (cpu));
+    return cpu;
+}
+
+// Returns the top of the Scheduler Stack of the current processor (called by "SwitchToNextTask")
+unsigned long GetSchedulerStack()
+{
+    return GetCurrentCpu()->Tss->ist1;
+}
+
+// Returns the processor with the given index
+Cpu *GetCpu(int Index)
+{
+    return &cpus[Index];
+}
+
+// Returns the number of processors
+int GetCpuCount()
+{
+    return cpuCount;
+}
+
+// Acquires the Kernel Lock, which serializes the SysCalls across the processors.
+// It returns the previous RFLAGS register, because the interrupts are disabled while the lock is held.
+unsigned long AcquireKernelLock()
+{
+    return AcquireMcsLockIrqSave(&kernelLock, &GetCurrentCpu()->KernelLockNode);
+}
+
+// Releases the Kernel Lock
+void ReleaseKernelLock(unsigned long Flags)
+{
+    ReleaseMcsLockIrqRestore(&kernelLock, &GetCurrentCpu()->KernelLockNode, Flags);
+}
@@ -0,0 +1,156 @@
+#ifndef SMP_H
+#define SMP_H
+
+#include "multitasking.h"
+#include "spinlock.h"
+#include "gdt.h"
+#include "realtime.h"
+
+// The maximum number of supported processors
+#define MAX_CPUS                        16
+
+// The AP Trampoline is copied to this physical address (and its Higher Half mapping).
+// The Startup IPI starts the Application Processor in Real Mode at the address (vector * 4096).
+#define AP_TRAMPOLINE_ADDRESS           0x8000
+#define AP_TRAMPOLINE_VIRTUAL           0xFFFF800000008000
+#define AP_STARTUP_VECTOR               (AP_TRAMPOLINE_ADDRESS >> 12)
+
+// The delays of the INIT-SIPI-SIPI sequence, and how long we wait until an Application Processor reports itself as online
+#define AP_INIT_DELAY_NANOSECONDS       10000000
+#define AP_STARTUP_DELAY_NANOSECONDS    200000
+#define AP_ONLINE_TIMEOUT_NANOSECONDS   100000000
+
+// Every processor performs its Context Switches on its own Scheduler Stack (Interrupt Stack Table entry 1 of its TSS).
+// Therefore the Stack of the previous Task is not used anymore, when the Task continues on another processor.
+#define SCHEDULER_STACK                 0xFFFF800001800000
+#define SCHEDULER_STACK_SIZE            0x2000
+#define SCHEDULER_IST                   1
+
+// The Model Specific Registers with the FS and GS base of the processor, and the GS base that is swapped in by SWAPGS
+#define IA32_FS_BASE                    0xC0000100
+#define IA32_GS_BASE                    0xC0000101
+#define IA32_KERNEL_GS_BASE             0xC0000102
+
+// Represents a processor.
+// The GS base of the processor points to its structure, so that the Assembler code reaches the per-CPU data with
+// a single instruction like "MOV RAX, [GS:8]". Therefore the offsets of the first members must not be changed - they
+// are also defined in the files "contextswitching.asm", "irq.asm" and "syscall.asm".
+typedef struct Cpu
+{
+    // Points to the structure itself (Offset +0), so that "GetCurrentCpu" only reads the GS base
+    struct Cpu *Self;
+
+    // The Task that is currently executed (Offset +8)
+    Task *CurrentTask;
+
+    // The top of the Kernel Mode Stack of the current Task (Offset +16)
+    unsigned long KernelStack;
+
+    // The number of Context Switches, interrupts, and SysCalls on the processor (Offset +24, +32, +40)
+    unsigned long ContextSwitchCount;
+    unsigned long InterruptCount;
+    unsigned long SysCallCount;
+
+    // The User Mode Stack Pointer of the current Task while the SYSCALL entry switches to the Kernel Mode Stack (Offset +48)
+    unsigned long UserStack;
+
+    // The index of the processor (0 is the Bootstrap Processor), and the ID of its Local APIC
+    int Index;
+    unsigned int ApicId;
+
+    // 1 as soon as the processor executes Tasks
+    volatile int Online;
+
+    // The TSS of the processor
+    TssEntry *Tss;
+
+    // The Idle Task of the processor
+    Task *IdleTask;
+
+    // The run queue with the runnable Tasks of the processor.
+    // It's a Double Linked List through the Task structures, so that queuing a Task doesn't allocate any memory from the Heap.
+    Task *RunQueueHead;
+    Task *RunQueueTail;
+    volatile int RunQueueLength;
+    Spinlock RunQueueLock;
+
+    // The runnable Real-Time Tasks have their own queue for each priority, and the bitmap tells which queues are not empty.
+    // They are also counted in "RunQueueLength".
+    Task *RtQueueHead[RT_PRIORITIES];
+    Task *RtQueueTail[RT_PRIORITIES];
+    unsigned int RtQueueBitmap;
+
+    // The scheduling latencies of all Tasks that were dispatched on the processor (LATENCY_RUNQUEUE and LATENCY_WAKEUP)
+    LatencyHistogram RunQueueLatency;
+    LatencyHistogram WakeupLatency;
+
+    // The queue node of the processor for the Kernel Lock (the Kernel Lock is never acquired recursively)
+    McsNode KernelLockNode;
+
+    // The Task whose FPU state was loaded the last time into the FPU registers of the processor,
+    // and 1 while the current Task can use the FPU (the TS flag of CR0 is cleared)
+    Task *FpuOwner;
+    int FpuActive;
+
+    // The FS base that is currently loaded into the processor (the Thread Local Storage of the current Task)
+    unsigned long FsBase;
+} Cpu;
+
+// The startup parameters of an Application Processor, which are stored at the end of the AP Trampoline
+typedef struct ApStartupParameters
+{
+    unsigned long PML4;
+    unsigned long Stack;
+    unsigned long EntryPoint;
+    unsigned long CpuIndex;
+} ApStartupParameters;
+
+// The AP Trampoline and its startup parameters (implemented in Assembler)
+extern unsigned char ApTrampoline[];
+extern unsigned char ApTrampolineEnd[];
+extern unsigned char ApStartupData[];
+
+// Points the GS base of the Bootstrap Processor to its per-CPU data area
+void InitBootCpu();
+
+// Initializes the Bootstrap Processor, and finds the Application Processors in the ACPI tables
+void InitSmp();
+
+// Starts all Application Processors through the INIT-SIPI-SIPI sequence
+void StartApplicationProcessors();
+
+// Lets the Application Processors execute Tasks, after the Context Switching was installed
+void ReleaseApplicationProcessors();
+
+// The entry point of an Application Processor in the Higher Half (called by the AP Trampoline)
+void ApMain(int CpuIndex);
+
+// Returns the current processor
+Cpu *GetCurrentCpu();
+
+// Returns the top of the Scheduler Stack of the current processor (called by "SwitchToNextTask")
+unsigned long GetSchedulerStack();
+
+// Returns the processor with the given index
+Cpu *GetCpu(int Index);
+
+// Returns the number of processors
+int GetCpuCount();
+
+// Acquires the Kernel Lock, which serializes the SysCalls across the processors.
+// It returns the previous RFLAGS register, because the interrupts are disabled while the lock is held.
+unsigned long AcquireKernelLock();
+
+// Releases the Kernel Lock
+void ReleaseKernelLock(unsigned long Flags);
+
+// Initializes the structure of the given processor
+static void InitCpu(int Index, unsigned int ApicId);
+
+// Starts the given Application Processor through the INIT-SIPI-SIPI sequence
+static void StartApplicationProcessor(Cpu *Cpu);
+
+// Points the GS base of the current processor to the given per-CPU data area
+static void LoadPerCpuArea(Cpu *Cpu);
+
+#endif
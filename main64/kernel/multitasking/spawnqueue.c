@@ -0,0 +1,124 @@
+#include "spawnqueue.h"
+#include "../isr/idt.h"
+#include "../common.h"
+
+// The Spawn Queue of the Kernel.
+// The User Mode programs are loaded by the Spawn Worker Task, which builds the address space of a new process
+// outside of the address space of the requesting process.
+SpawnQueue spawnQueue =
+{
+    .Head = 0x0,
+    .WorkerWaitQueue = WAIT_QUEUE_INITIALIZER("SpawnWorker"),
+    .CompletionWaitQueue = WAIT_QUEUE_INITIALIZER("SpawnCompletion")
+};
+
+// Creates the Kernel Mode Spawn Worker Task
+void CreateSpawnWorker()
+{
+    CreateKernelModeTask(SpawnWorkerTask, SPAWN_WORKER_STACK);
+}
+
+// Starts the given User Mode program through the Spawn Worker Task, and waits until it's started.
+// It returns the PID of the new Task, or 0 if the program couldn't be started.
+// The current Task blocks, therefore the caller must not hold the Kernel Lock or any Spinlock.
+// The started program takes over the given pipe handles as its standard input and output (0 is the console).
+unsigned long SpawnUserModeProgram(char *FileName, unsigned long StandardInput, unsigned long StandardOutput)
+{
+    SpawnRequest request;
+    WaitQueueEntry entry;
+    unsigned long flags;
+    int i;
+
+    // Copy the program name, because the Spawn Worker Task can't access the User Mode memory of the requesting Task
+    for (i = 0; (i < SPAWN_FILENAME_LENGTH) && (FileName[i] != 0); i++)
+        request.FileName[i] = FileName[i];
+
+    request.FileName[i] = 0;
+    request.StandardInput = StandardInput;
+    request.StandardOutput = StandardOutput;
+    request.Status = SPAWN_STATUS_PENDING;
+    request.PID = 0;
+
+    // Push the request onto the Spawn Queue
+    request.Next = __atomic_load_n(&spawnQueue.Head, __ATOMIC_RELAXED);
+
+    while (!__atomic_compare_exchange_n(&spawnQueue.Head, &request.Next, &request, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+        ;
+
+    // Wake up the Spawn Worker Task.
+    // It checks the Spawn Queue under the lock of its Wait Queue, therefore the wakeup can't get lost.
+    flags = AcquireSpinlockIrqSave(&spawnQueue.WorkerWaitQueue.Lock);
+    WakeUpFirstWaiter(&spawnQueue.WorkerWaitQueue);
+    ReleaseSpinlockIrqRestore(&spawnQueue.WorkerWaitQueue.Lock, flags);
+
+    // Wait until the request is completed.
+    // The status is set under the lock of the Wait Queue, and the Spawn Worker Task doesn't touch the request afterwards.
+    flags = AcquireSpinlockIrqSave(&spawnQueue.CompletionWaitQueue.Lock);
+
+    while (request.Status == SPAWN_STATUS_PENDING)
+        SleepOnWaitQueue(&spawnQueue.CompletionWaitQueue, &entry, 0);
+
+    ReleaseSpinlockIrqRestore(&spawnQueue.CompletionWaitQueue.Lock, flags);
+
+    return request.PID;
+}
+
+// The Kernel Mode Spawn Worker Task that starts the requested User Mode programs
+void SpawnWorkerTask()
+{
+    WaitQueueEntry entry;
+
+    while (1 == 1)
+    {
+        SpawnRequest *request;
+        unsigned long flags = AcquireSpinlockIrqSave(&spawnQueue.WorkerWaitQueue.Lock);
+
+        // Wait until a request is queued
+        while (__atomic_load_n(&spawnQueue.Head, __ATOMIC_ACQUIRE) == 0x0)
+            SleepOnWaitQueue(&spawnQueue.WorkerWaitQueue, &entry, 1);
+
+        ReleaseSpinlockIrqRestore(&spawnQueue.WorkerWaitQueue.Lock, flags);
+        request = TakeSpawnRequests();
+
+        // Start the requested programs with enabled interrupts, because loading a program raises Page Faults
+        while (request != 0x0)
+        {
+            // The request is gone after its completion, so we have to remember its successor
+            SpawnRequest *next = request->Next;
+
+            CompleteSpawnRequest(request, ExecuteUserModeProgram(request->FileName, request->StandardInput, request->StandardOutput));
+            request = next;
+        }
+    }
+}
+
+// Takes all queued requests from the Spawn Queue in FIFO order
+static SpawnRequest *TakeSpawnRequests()
+{
+    SpawnRequest *request = __atomic_exchange_n(&spawnQueue.Head, 0x0, __ATOMIC_ACQUIRE);
+    SpawnRequest *reversed = 0x0;
+
+    // The requests were pushed onto a stack, so the latest request is at its top
+    while (request != 0x0)
+    {
+        SpawnRequest *next = request->Next;
+        request->Next = reversed;
+        reversed = request;
+        request = next;
+    }
+
+    return reversed;
+}
+
+// Completes the given request, and wakes up the requesting Task.
+// All requesting Tasks share the same Wait Queue, so every woken up Task checks the status of its own request.
+static void CompleteSpawnRequest(SpawnRequest *Request, unsigned long PID)
+{
+    unsigned long flags = AcquireSpinlockIrqSave(&spawnQueue.CompletionWaitQueue.Lock);
+
+    Request->PID = PID;
+    Request->Status = PID != 0 ? SPAWN_STATUS_STARTED : SPAWN_STATUS_FAILED;
+
+    WakeUpAllWaiters(&spawnQueue.CompletionWaitQueue);
+    ReleaseSpinlockIrqRestore(&spawnQueue.CompletionWaitQueue.Lock, flags);
+}
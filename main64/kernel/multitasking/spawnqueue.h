@@ -0,0 +1,67 @@
+#ifndef SPAWNQUEUE_H
+#define SPAWNQUEUE_H
+
+#include "multitasking.h"
+#include "waitqueue.h"
+
+// The Kernel Mode Stack of the Spawn Worker Task
+#define SPAWN_WORKER_STACK          0xFFFF800001200000
+
+// The length of a 8.3 program name (without the terminating zero)
+#define SPAWN_FILENAME_LENGTH       11
+
+// The status of a Spawn Request
+#define SPAWN_STATUS_PENDING        0x0
+#define SPAWN_STATUS_STARTED        0x1
+#define SPAWN_STATUS_FAILED         0x2
+
+// Represents the request to start a User Mode program.
+// The request is stored on the Kernel Mode Stack of the requesting Task, because the Task waits until it's completed.
+typedef struct SpawnRequest
+{
+    // The 8.3 name of the program
+    char FileName[SPAWN_FILENAME_LENGTH + 1];
+
+    // The pipe handles of the standard input and output of the program (0 is the console)
+    unsigned long StandardInput;
+    unsigned long StandardOutput;
+
+    // The status of the request, and the PID of the started program
+    volatile int Status;
+    unsigned long PID;
+
+    // The next request in the Spawn Queue
+    struct SpawnRequest *Next;
+} SpawnRequest;
+
+// Represents the Spawn Queue.
+// It's a lock-free Multi-Producer Single-Consumer queue: the requesting Tasks push their requests onto a stack,
+// and the Spawn Worker Task takes the whole stack at once and reverses it into the FIFO order.
+typedef struct SpawnQueue
+{
+    SpawnRequest *volatile Head;
+
+    // The Spawn Worker Task waits here until a request is queued
+    WaitQueue WorkerWaitQueue;
+
+    // The requesting Tasks are waiting here until their requests are completed
+    WaitQueue CompletionWaitQueue;
+} SpawnQueue;
+
+// Creates the Kernel Mode Spawn Worker Task
+void CreateSpawnWorker();
+
+// Starts the given User Mode program through the Spawn Worker Task, and waits until it's started.
+// It returns the PID of the new Task, or 0 if the program couldn't be started.
+unsigned long SpawnUserModeProgram(char *FileName, unsigned long StandardInput, unsigned long StandardOutput);
+
+// The Kernel Mode Spawn Worker Task that starts the requested User Mode programs
+void SpawnWorkerTask();
+
+// Takes all queued requests from the Spawn Queue in FIFO order
+static SpawnRequest *TakeSpawnRequests();
+
+// Completes the given request, and wakes up the requesting Task
+static void CompleteSpawnRequest(SpawnRequest *Request, unsigned long PID);
+
+#endif
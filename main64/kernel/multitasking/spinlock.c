@@ -0,0 +1,201 @@
+#include "spinlock.h"
+#include "../isr/idt.h"
+#include "../common.h"
+#include "../drivers/screen.h"
+
+// All locks that were acquired at least once
+LockStatistics *registeredLocks = 0x0;
+
+// Initializes a Spinlock with the given name
+void InitSpinlock(Spinlock *Lock, char *Name)
+{
+    memset(Lock, 0, sizeof(Spinlock));
+    Lock->Statistics.Name = Name;
+}
+
+// Acquires a Spinlock.
+// The processor draws the next ticket, and waits until its ticket is served.
+void AcquireSpinlock(Spinlock *Lock)
+{
+    unsigned int ticket = __atomic_fetch_add(&Lock->NextTicket, 1, __ATOMIC_RELAXED);
+    unsigned long spins = 0;
+
+    while (__atomic_load_n(&Lock->ServingTicket, __ATOMIC_ACQUIRE) != ticket)
+    {
+        asm volatile("pause");
+        spins++;
+    }
+
+    RecordAcquisition(&Lock->Statistics, spins);
+}
+
+// Releases a Spinlock by serving the next ticket
+void ReleaseSpinlock(Spinlock *Lock)
+{
+    RecordRelease(&Lock->Statistics);
+    __atomic_store_n(&Lock->ServingTicket, Lock->ServingTicket + 1, __ATOMIC_RELEASE);
+}
+
+// Disables the interrupts and acquires a Spinlock. It returns the previous RFLAGS register.
+// The lock holder can't be preempted, so that the other processors are not spinning for a whole time slice.
+unsigned long AcquireSpinlockIrqSave(Spinlock *Lock)
+{
+    unsigned long flags = SaveFlagsAndDisableInterrupts();
+    AcquireSpinlock(Lock);
+
+    return flags;
+}
+
+// Releases a Spinlock and restores the RFLAGS register returned by "AcquireSpinlockIrqSave"
+void ReleaseSpinlockIrqRestore(Spinlock *Lock, unsigned long Flags)
+{
+    ReleaseSpinlock(Lock);
+    RestoreFlags(Flags);
+}
+
+// Acquires a MCS Lock. The queue node must stay valid until the lock is released.
+// The node is appended to the queue of the waiting processors, and the processor spins until its predecessor hands over the lock.
+void AcquireMcsLock(McsLock *Lock, McsNode *Node)
+{
+    McsNode *predecessor;
+    unsigned long spins = 0;
+
+    Node->Next = 0x0;
+    Node->Locked = 1;
+
+    predecessor = __atomic_exchange_n(&Lock->Tail, Node, __ATOMIC_ACQ_REL);
+
+    if (predecessor != 0x0)
+    {
+        __atomic_store_n(&predecessor->Next, Node, __ATOMIC_RELEASE);
+
+        while (__atomic_load_n(&Node->Locked, __ATOMIC_ACQUIRE) == 1)
+        {
+            asm volatile("pause");
+            spins++;
+        }
+    }
+
+    RecordAcquisition(&Lock->Statistics, spins);
+}
+
+// Releases a MCS Lock by handing it over to the next waiting processor
+void ReleaseMcsLock(McsLock *Lock, McsNode *Node)
+{
+    McsNode *successor = __atomic_load_n(&Node->Next, __ATOMIC_ACQUIRE);
+
+    RecordRelease(&Lock->Statistics);
+
+    if (successor == 0x0)
+    {
+        McsNode *expected = Node;
+
+        // Nobody is waiting, so the lock is free afterwards
+        if (__atomic_compare_exchange_n(&Lock->Tail, &expected, 0x0, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+            return;
+
+        // Another processor has just appended its node, but hasn't linked it yet
+        while ((successor = __atomic_load_n(&Node->Next, __ATOMIC_ACQUIRE)) == 0x0)
+            asm volatile("pause");
+    }
+
+    __atomic_store_n(&successor->Locked, 0, __ATOMIC_RELEASE);
+}
+
+// Disables the interrupts and acquires a MCS Lock. It returns the previous RFLAGS register.
+unsigned long AcquireMcsLockIrqSave(McsLock *Lock, McsNode *Node)
+{
+    unsigned long flags = SaveFlagsAndDisableInterrupts();
+    AcquireMcsLock(Lock, Node);
+
+    return flags;
+}
+
+// Releases a MCS Lock and restores the RFLAGS register returned by "AcquireMcsLockIrqSave"
+void ReleaseMcsLockIrqRestore(McsLock *Lock, McsNode *Node, unsigned long Flags)
+{
+    ReleaseMcsLock(Lock, Node);
+    RestoreFlags(Flags);
+}
+
+// Records a lock acquisition after the given number of spin loop iterations
+static void RecordAcquisition(LockStatistics *Statistics, unsigned long Spins)
+{
+    Statistics->Acquisitions++;
+    Statistics->Spins += Spins;
+
+    if (Spins > 0)
+        Statistics->Contentions++;
+
+    // The lock is registered by its first holder, therefore it's never registered twice
+    if (Statistics->Registered == 0)
+    {
+        Statistics->Registered = 1;
+        Statistics->Next = __atomic_load_n(&registeredLocks, __ATOMIC_RELAXED);
+
+        while (!__atomic_compare_exchange_n(&registeredLocks, &Statistics->Next, Statistics, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+            ;
+    }
+
+    Statistics->AcquireTimestamp = rdtsc();
+}
+
+// Records the hold time of a lock before it gets released
+static void RecordRelease(LockStatistics *Statistics)
+{
+    unsigned long holdTime = rdtsc() - Statistics->AcquireTimestamp;
+
+    if (holdTime > Statistics->MaxHoldTime)
+        Statistics->MaxHoldTime = holdTime;
+}
+
+// Returns a snapshot of the statistics of all registered locks.
+// The return value is the number of locks that were copied into the provided buffer.
+int GetLockStatistics(LockStatisticsSnapshot *Buffer, int MaxEntries)
+{
+    LockStatistics *statistics = __atomic_load_n(&registeredLocks, __ATOMIC_ACQUIRE);
+    int count = 0;
+    int i;
+
+    // The counters are read without the locks, so a snapshot can be slightly inconsistent
+    while ((statistics != 0x0) && (count < MaxEntries))
+    {
+        LockStatisticsSnapshot *snapshot = &Buffer[count++];
+        char *name = statistics->Name != 0x0 ? statistics->Name : "Unnamed";
+
+        for (i = 0; (i < LOCK_NAME_LENGTH - 1) && (name[i] != 0); i++)
+            snapshot->Name[i] = name[i];
+
+        snapshot->Name[i] = 0;
+        snapshot->Acquisitions = statistics->Acquisitions;
+        snapshot->Contentions = statistics->Contentions;
+        snapshot->Spins = statistics->Spins;
+        snapshot->MaxHoldTime = statistics->MaxHoldTime;
+
+        statistics = statistics->Next;
+    }
+
+    return count;
+}
+
+// Prints out the statistics of all registered locks
+void DumpLockStatistics()
+{
+    LockStatistics *statistics = __atomic_load_n(&registeredLocks, __ATOMIC_ACQUIRE);
+
+    while (statistics != 0x0)
+    {
+        printf(statistics->Name != 0x0 ? statistics->Name : "Unnamed");
+        printf(": Acquisitions: ");
+        printf_long(statistics->Acquisitions, 10);
+        printf(", Contentions: ");
+        printf_long(statistics->Contentions, 10);
+        printf(", Spins: ");
+        printf_long(statistics->Spins, 10);
+        printf(", Max Hold Time: ");
+        printf_long(statistics->MaxHoldTime, 10);
+        printf(" TSC\n");
+
+        statistics = statistics->Next;
+    }
+}
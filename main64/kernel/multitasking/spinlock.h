@@ -1,17 +1,110 @@
 #ifndef SPINLOCK_H
 #define SPINLOCK_H
 
-// Declares a Spinlock
-#define DECLARE_SPINLOCK(name) volatile int name ## Locked
+// The maximum length of a lock name in the SysCall "SYSCALL_GETLOCKSTATISTICS"
+#define LOCK_NAME_LENGTH 16
+
+// Initializes a statically allocated Spinlock or MCS Lock with the given name
+#define SPINLOCK_INITIALIZER(name) { .Statistics = { .Name = name } }
+
+// The contention statistics of a lock.
+// They are only updated by the current lock holder, therefore they don't need any atomic operations.
+typedef struct LockStatistics
+{
+    // The name of the lock
+    char *Name;
+
+    // The number of acquisitions, and how many of them had to wait for another lock holder
+    unsigned long Acquisitions;
+    unsigned long Contentions;
+
+    // The number of spin loop iterations while waiting for the lock
+    unsigned long Spins;
+
+    // The longest time (in TSC ticks) that the lock was held
+    unsigned long MaxHoldTime;
+
+    // The TSC value when the current lock holder has acquired the lock
+    unsigned long AcquireTimestamp;
+
+    // Every lock is registered on its first acquisition, so that its statistics can be dumped
+    int Registered;
+    struct LockStatistics *Next;
+} LockStatistics;
+
+// Represents a Ticket Spinlock.
+// Every processor draws a ticket, and the lock is granted in the order of the tickets, therefore it's fair.
+typedef struct Spinlock
+{
+    volatile unsigned int NextTicket;
+    volatile unsigned int ServingTicket;
+    LockStatistics Statistics;
+} Spinlock;
+
+// Represents the queue node of a processor that waits for a MCS Lock.
+// Every waiting processor spins on its own node, so that the cache line of the lock isn't bouncing between the processors.
+typedef struct McsNode
+{
+    struct McsNode *volatile Next;
+    volatile int Locked;
+} McsNode;
+
+// Represents a MCS Lock, which is a queue of the waiting processors
+typedef struct McsLock
+{
+    McsNode *volatile Tail;
+    LockStatistics Statistics;
+} McsLock;
+
+// A snapshot of the statistics of a lock, as returned by the SysCall "SYSCALL_GETLOCKSTATISTICS".
+// The same structure is defined in the file "libc.h".
+typedef struct LockStatisticsSnapshot
+{
+    char Name[LOCK_NAME_LENGTH];
+    unsigned long Acquisitions;
+    unsigned long Contentions;
+    unsigned long Spins;
+    unsigned long MaxHoldTime;
+} LockStatisticsSnapshot;
+
+// Initializes a Spinlock with the given name
+void InitSpinlock(Spinlock *Lock, char *Name);
 
 // Acquires a Spinlock
-#define AcquireSpinlock(name) \
-    while (!__sync_bool_compare_and_swap(& name ## Locked, 0, 1)); \
-    __sync_synchronize();
+void AcquireSpinlock(Spinlock *Lock);
 
 // Releases a Spinlock
-#define ReleaseSpinlock(name) \
-    __sync_synchronize(); \
-    name ## Locked = 0;
+void ReleaseSpinlock(Spinlock *Lock);
+
+// Disables the interrupts and acquires a Spinlock. It returns the previous RFLAGS register.
+unsigned long AcquireSpinlockIrqSave(Spinlock *Lock);
+
+// Releases a Spinlock and restores the RFLAGS register returned by "AcquireSpinlockIrqSave"
+void ReleaseSpinlockIrqRestore(Spinlock *Lock, unsigned long Flags);
+
+// Acquires a MCS Lock. The queue node must stay valid until the lock is released.
+void AcquireMcsLock(McsLock *Lock, McsNode *Node);
+
+// Releases a MCS Lock
+void ReleaseMcsLock(McsLock *Lock, McsNode *Node);
+
+// Disables the interrupts and acquires a MCS Lock. It returns the previous RFLAGS register.
+unsigned long AcquireMcsLockIrqSave(McsLock *Lock, McsNode *Node);
+
+// Releases a MCS Lock and restores the RFLAGS register returned by "AcquireMcsLockIrqSave"
+void ReleaseMcsLockIrqRestore(McsLock *Lock, McsNode *Node, unsigned long Flags);
+
+// Returns a snapshot of the statistics of all registered locks.
+// The return value is the number of locks that were copied into the provided buffer.
+int GetLockStatistics(LockStatisticsSnapshot *Buffer, int MaxEntries);
+
+// Prints out the statistics of all registered locks
+void DumpLockStatistics();
+
+// Records a lock acquisition after the given number of spin loop iterations
+static void RecordAcquisition(LockStatistics *Statistics, unsigned long Spins);
+
+// Records the hold time of a lock before it gets released
+static void RecordRelease(LockStatistics *Statistics);
 
-#endif
\ No newline at end of file
+#endif
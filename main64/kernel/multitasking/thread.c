@@ -0,0 +1,162 @@
+#include "thread.h"
+#include "../common.h"
+#include "../memory/heap.h"
+#include "../syscalls/ioring.h"
+#include "../io/pipe.h"
+
+// The threads that are joining another thread are waiting here.
+// The lock of the Wait Queue also protects the thread slots of all ThreadGroups.
+WaitQueue threadJoinWaitQueue = WAIT_QUEUE_INITIALIZER("ThreadJoin");
+
+// Creates the ThreadGroup of a new User Mode process, whose initial Task has the given PID.
+// The initial Task owns the thread slot 0 and the reference to the ThreadGroup.
+ThreadGroup *CreateThreadGroup(unsigned long PID)
+{
+    ThreadGroup *group = (ThreadGroup *)malloc(sizeof(ThreadGroup));
+    memset(group, 0, sizeof(ThreadGroup));
+
+    group->ReferenceCount = 1;
+    group->Slots[0].TID = PID;
+    group->Slots[0].Status = THREAD_SLOT_RUNNING;
+
+    return group;
+}
+
+// Releases the reference of the given Task to its ThreadGroup.
+// The ThreadGroup is released together with the last Task of the process.
+void ReleaseThreadGroup(Task *Task)
+{
+    if (Task->ThreadGroup == 0x0)
+        return;
+
+    if (__atomic_sub_fetch(&Task->ThreadGroup->ReferenceCount, 1, __ATOMIC_ACQ_REL) == 0)
+    {
+        // The I/O Ring stays alive until its queued operations are executed
+        if (Task->ThreadGroup->IoRing != 0x0)
+            ReleaseIoRing(Task->ThreadGroup->IoRing);
+
+        // The readers of the standard output are getting the end of the file
+        if (IsPipeHandle(Task->ThreadGroup->StandardInput))
+            ClosePipeHandle(Task->ThreadGroup->StandardInput);
+
+        if (IsPipeHandle(Task->ThreadGroup->StandardOutput))
+            ClosePipeHandle(Task->ThreadGroup->StandardOutput);
+
+        // The pipes that weren't closed by the process are getting the end of the file (or a broken pipe)
+        ReleasePipeHandles(Task->ThreadGroup);
+
+        // The Shared Memory Segments are released together with their last process
+        ReleaseSharedMemory(Task->ThreadGroup);
+
+        free(Task->ThreadGroup);
+    }
+
+    Task->ThreadGroup = 0x0;
+}
+
+// Reserves a thread slot for the Task with the given PID in the ThreadGroup of the given Task.
+// It returns the slot index, or -1 if the process has already the maximum number of threads.
+// The new thread gets its own reference to the ThreadGroup.
+int ReserveThreadSlot(Task *Task, unsigned long TID)
+{
+    ThreadGroup *group = Task->ThreadGroup;
+    unsigned long flags = AcquireSpinlockIrqSave(&threadJoinWaitQueue.Lock);
+    int slot;
+
+    for (slot = 1; slot < MAX_THREADS; slot++)
+    {
+        if (group->Slots[slot].Status == THREAD_SLOT_FREE)
+        {
+            group->Slots[slot].TID = TID;
+            group->Slots[slot].Status = THREAD_SLOT_RUNNING;
+            group->Slots[slot].ExitCode = 0;
+            __atomic_add_fetch(&group->ReferenceCount, 1, __ATOMIC_RELAXED);
+
+            ReleaseSpinlockIrqRestore(&threadJoinWaitQueue.Lock, flags);
+            return slot;
+        }
+    }
+
+    ReleaseSpinlockIrqRestore(&threadJoinWaitQueue.Lock, flags);
+    return -1;
+}
+
+// Releases a reserved thread slot, when the thread couldn't be created
+void ReleaseThreadSlot(ThreadGroup *Group, int Slot)
+{
+    unsigned long flags = AcquireSpinlockIrqSave(&threadJoinWaitQueue.Lock);
+
+    Group->Slots[Slot].TID = 0;
+    Group->Slots[Slot].Status = THREAD_SLOT_FREE;
+    __atomic_sub_fetch(&Group->ReferenceCount, 1, __ATOMIC_RELAXED);
+
+    ReleaseSpinlockIrqRestore(&threadJoinWaitQueue.Lock, flags);
+}
+
+// Returns the starting address of the User Mode Stack of the given thread slot
+unsigned long GetThreadUserModeStack(int Slot)
+{
+    return EXECUTABLE_USERMODE_STACK - Slot * THREAD_USERMODE_STACK_SIZE;
+}
+
+// Publishes the exit code of the given terminating Task, and wakes up the threads that are joining it.
+// The User Mode Stack of the thread is not used anymore, so it can be reused as soon as the thread was joined.
+void ExitThread(Task *Task)
+{
+    unsigned long flags;
+    ThreadSlot *slot;
+
+    if (Task->ThreadGroup == 0x0)
+        return;
+
+    flags = AcquireSpinlockIrqSave(&threadJoinWaitQueue.Lock);
+    slot = &Task->ThreadGroup->Slots[Task->ThreadSlot];
+    slot->ExitCode = Task->ExitCode;
+    slot->Status = THREAD_SLOT_EXITED;
+
+    // All joining threads share the same Wait Queue, so every woken up thread checks the status of its own slot
+    WakeUpAllWaiters(&threadJoinWaitQueue);
+    ReleaseSpinlockIrqRestore(&threadJoinWaitQueue.Lock, flags);
+}
+
+// Waits until the thread with the given TID (of the same process) has exited, and returns its exit code.
+// It returns 0 if the thread doesn't exist, or when it's the current thread.
+// Only one thread can join an exited thread, because the slot is released afterwards.
+int JoinThread(Task *Task, unsigned long TID, long *ExitCode)
+{
+    ThreadGroup *group = Task->ThreadGroup;
+    WaitQueueEntry entry;
+    unsigned long flags;
+    ThreadSlot *slot = 0x0;
+    long exitCode;
+    int i;
+
+    if ((group == 0x0) || (TID == Task->PID))
+        return 0;
+
+    flags = AcquireSpinlockIrqSave(&threadJoinWaitQueue.Lock);
+
+    for (i = 0; i < MAX_THREADS; i++)
+    {
+        if ((group->Slots[i].Status != THREAD_SLOT_FREE) && (group->Slots[i].TID == TID))
+            slot = &group->Slots[i];
+    }
+
+    // Another thread can join the same thread concurrently, therefore the TID is checked again after every wakeup
+    while ((slot != 0x0) && (slot->TID == TID) && (slot->Status == THREAD_SLOT_RUNNING))
+        SleepOnWaitQueue(&threadJoinWaitQueue, &entry, 0);
+
+    if ((slot == 0x0) || (slot->TID != TID))
+    {
+        ReleaseSpinlockIrqRestore(&threadJoinWaitQueue.Lock, flags);
+        return 0;
+    }
+
+    exitCode = slot->ExitCode;
+    slot->TID = 0;
+    slot->Status = THREAD_SLOT_FREE;
+    ReleaseSpinlockIrqRestore(&threadJoinWaitQueue.Lock, flags);
+
+    *ExitCode = exitCode;
+    return 1;
+}
@@ -0,0 +1,81 @@
+#ifndef THREAD_H
+#define THREAD_H
+
+#include "multitasking.h"
+#include "waitqueue.h"
+#include "../memory/sharedmemory.h"
+#include "../io/pipe.h"
+
+// The maximum number of threads of a User Mode process (including its initial Task)
+#define MAX_THREADS                     16
+
+// Every thread has its own User Mode Stack (1 MB) below the User Mode Stack of the process.
+// The thread slot 0 is the initial Task of the process, which uses the Stack at EXECUTABLE_USERMODE_STACK.
+#define THREAD_USERMODE_STACK_SIZE      0x100000
+
+// The status of a thread slot
+#define THREAD_SLOT_FREE                0x0
+#define THREAD_SLOT_RUNNING             0x1
+#define THREAD_SLOT_EXITED              0x2
+
+// Represents a thread of a User Mode process.
+// The slot stays allocated after the thread has exited, until another thread has joined it and read its exit code.
+typedef struct ThreadSlot
+{
+    // The PID of the Task that executes the thread (the thread ID)
+    unsigned long TID;
+
+    // The status of the slot, and the exit code of an exited thread
+    int Status;
+    long ExitCode;
+} ThreadSlot;
+
+// Represents the threads of a User Mode process, which are sharing the same address space.
+// The structure is referenced by all Tasks of the process, and it's released by the last one.
+typedef struct ThreadGroup
+{
+    volatile int ReferenceCount;
+
+    // The slot index of a thread also selects its User Mode Stack
+    ThreadSlot Slots[MAX_THREADS];
+
+    // The I/O Ring of the process, or 0x0 if it wasn't set up
+    struct IoRing *IoRing;
+
+    // The pipe handles of the standard input and output of the process, or 0 for the console.
+    // The process owns these handles, and they are closed together with the ThreadGroup.
+    unsigned long StandardInput;
+    unsigned long StandardOutput;
+
+    // The pipe handles that were created by the process, or 0 for a free slot (protected by the pipe handle lock).
+    // A process can only use its own pipe handles, and they are closed together with the ThreadGroup.
+    unsigned long Pipes[MAX_PIPE_HANDLES];
+
+    // The Shared Memory handles of the process (protected by the Shared Memory lock)
+    SharedMemoryHandle SharedMemory[MAX_SHARED_MEMORY_HANDLES];
+} ThreadGroup;
+
+// Creates the ThreadGroup of a new User Mode process, whose initial Task has the given PID
+ThreadGroup *CreateThreadGroup(unsigned long PID);
+
+// Releases the reference of the given Task to its ThreadGroup
+void ReleaseThreadGroup(Task *Task);
+
+// Reserves a thread slot for the Task with the given PID in the ThreadGroup of the given Task.
+// It returns the slot index, or -1 if the process has already the maximum number of threads.
+int ReserveThreadSlot(Task *Task, unsigned long TID);
+
+// Releases a reserved thread slot, when the thread couldn't be created
+void ReleaseThreadSlot(ThreadGroup *Group, int Slot);
+
+// Returns the starting address of the User Mode Stack of the given thread slot
+unsigned long GetThreadUserModeStack(int Slot);
+
+// Publishes the exit code of the given terminating Task, and wakes up the threads that are joining it
+void ExitThread(Task *Task);
+
+// Waits until the thread with the given TID (of the same process) has exited, and returns its exit code.
+// It returns 0 if the thread doesn't exist, or when it's the current thread.
+int JoinThread(Task *Task, unsigned long TID, long *ExitCode);
+
+#endif
@@ -0,0 +1,264 @@
+#include "timerwheel.h"
+#include "spinlock.h"
+#include "../isr/idt.h"
+#include "../drivers/timer.h"
+#include "../common.h"
+
+// The hierarchical Timer Wheel.
+// Adding and cancelling a timer are O(1) operations, because a timer is just linked into
+// the slot that corresponds to its expiration time.
+TimerWheel timerWheel;
+
+// The Timer Wheel is shared by all processors
+Spinlock timerWheelLock = SPINLOCK_INITIALIZER("TimerWheel");
+
+// Initializes the Timer Wheel
+void InitTimerWheel()
+{
+    memset(&timerWheel, 0, sizeof(TimerWheel));
+    timerWheel.CurrentTick = GetMonotonicTime() / TIMER_WHEEL_RESOLUTION;
+}
+
+// Adds the given timer to the Timer Wheel.
+// The timer expires at the given point in time (nanoseconds of the monotonic clock).
+void AddTimer(Timer *Timer, unsigned long Expires, TimerCallback Callback, void *Context)
+{
+    // The Timer Wheel is also accessed by the Timer Interrupt
+    unsigned long flags = AcquireSpinlockIrqSave(&timerWheelLock);
+
+    // A pending timer is just rescheduled
+    if (Timer->Pending)
+        RemoveTimer(Timer);
+    else
+        timerWheel.PendingTimers++;
+
+    Timer->Expires = Expires;
+    Timer->Callback = Callback;
+    Timer->Context = Context;
+    Timer->Pending = 1;
+    InsertTimer(Timer);
+
+    ReleaseSpinlockIrqRestore(&timerWheelLock, flags);
+}
+
+// Removes the given timer from the Timer Wheel.
+// Returns 1 if the timer was pending, otherwise 0.
+int CancelTimer(Timer *Timer)
+{
+    int wasPending = 0;
+
+    // The Timer Wheel is also accessed by the Timer Interrupt
+    unsigned long flags = AcquireSpinlockIrqSave(&timerWheelLock);
+
+    if (Timer->Pending)
+    {
+        RemoveTimer(Timer);
+        Timer->Pending = 0;
+        timerWheel.PendingTimers--;
+        wasPending = 1;
+    }
+
+    ReleaseSpinlockIrqRestore(&timerWheelLock, flags);
+
+    return wasPending;
+}
+
+// Calls the callback functions of all expired timers.
+// This function is called from the Timer Interrupt, where the interrupts are disabled.
+// The callback functions are called without holding the lock of the Timer Wheel, because they can add timers again.
+void RunExpiredTimers()
+{
+    unsigned long now = GetMonotonicTime() / TIMER_WHEEL_RESOLUTION;
+    int level;
+
+    AcquireSpinlock(&timerWheelLock);
+
+    // Without any pending timer, we can directly move forward to the current tick
+    if (timerWheel.PendingTimers == 0)
+    {
+        if (timerWheel.CurrentTick <= now)
+            timerWheel.CurrentTick = now + 1;
+
+        ReleaseSpinlock(&timerWheelLock);
+        return;
+    }
+
+    while (timerWheel.CurrentTick <= now)
+    {
+        int slot = timerWheel.CurrentTick & TIMER_WHEEL_SLOT_MASK;
+
+        // When level 0 wraps around, the timers of the next slot of level 1 are moved into level 0, and so on
+        if (slot == 0)
+        {
+            for (level = 1; level < TIMER_WHEEL_LEVELS; level++)
+            {
+                int cascadeSlot = (timerWheel.CurrentTick >> (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOT_MASK;
+                CascadeTimers(level, cascadeSlot);
+
+                if (cascadeSlot != 0)
+                    break;
+            }
+        }
+
+        // Call the callback functions of all timers in the current slot.
+        // A callback function can add its timer again (like a periodic timer).
+        while (timerWheel.Slots[0][slot] != 0x0)
+        {
+            Timer *timer = timerWheel.Slots[0][slot];
+            RemoveTimer(timer);
+            timer->Pending = 0;
+            timerWheel.PendingTimers--;
+
+            ReleaseSpinlock(&timerWheelLock);
+            timer->Callback(timer->Context);
+            AcquireSpinlock(&timerWheelLock);
+        }
+
+        timerWheel.CurrentTick++;
+
+        // We skip the empty slots of level 0 up to the next occupied slot, or up to the next cascading of the higher levels.
+        // Therefore a longer idle period is processed in steps of 64 ticks, and not tick by tick.
+        if ((timerWheel.CurrentTick & TIMER_WHEEL_SLOT_MASK) != 0)
+        {
+            unsigned long occupied = timerWheel.OccupiedSlots[0] >> (timerWheel.CurrentTick & TIMER_WHEEL_SLOT_MASK);
+            unsigned long nextTick;
+
+            if (occupied != 0)
+                nextTick = timerWheel.CurrentTick + __builtin_ctzl(occupied);
+            else
+                nextTick = (timerWheel.CurrentTick | TIMER_WHEEL_SLOT_MASK) + 1;
+
+            if (nextTick > now + 1)
+                nextTick = now + 1;
+
+            timerWheel.CurrentTick = nextTick;
+        }
+    }
+
+    ReleaseSpinlock(&timerWheelLock);
+}
+
+// Returns the point in time (nanoseconds of the monotonic clock) when the Timer Wheel must be processed the next time.
+// For timers in the higher levels this is the point in time when they are cascaded into the lower levels.
+unsigned long GetNextTimerExpiry()
+{
+    unsigned long nextTick = TIMER_NOT_PENDING;
+    unsigned long flags = AcquireSpinlockIrqSave(&timerWheelLock);
+    int level;
+
+    for (level = 0; level < TIMER_WHEEL_LEVELS; level++)
+    {
+        unsigned long occupied = timerWheel.OccupiedSlots[level];
+        int shift = TIMER_WHEEL_SLOT_BITS * level;
+        unsigned long base = timerWheel.CurrentTick >> shift;
+        unsigned long start = 0;
+        unsigned long rotated;
+        unsigned long tick;
+        int first;
+
+        if (occupied == 0)
+            continue;
+
+        // The current slot of a higher level was already cascaded, when the current tick is not at its beginning
+        if ((timerWheel.CurrentTick & ((1UL << shift) - 1)) != 0)
+            start = 1;
+
+        // Find the next occupied slot, starting at the slot that is processed next
+        first = (base + start) & TIMER_WHEEL_SLOT_MASK;
+        rotated = occupied >> first;
+
+        if (first != 0)
+            rotated |= occupied << (TIMER_WHEEL_SLOTS - first);
+
+        tick = (base + start + __builtin_ctzl(rotated)) << shift;
+
+        if (tick < nextTick)
+            nextTick = tick;
+    }
+
+    ReleaseSpinlockIrqRestore(&timerWheelLock, flags);
+
+    if (nextTick == TIMER_NOT_PENDING)
+        return TIMER_NOT_PENDING;
+
+    return nextTick * TIMER_WHEEL_RESOLUTION;
+}
+
+// Stores the given timer in the corresponding slot of the Timer Wheel
+static void InsertTimer(Timer *Timer)
+{
+    // Timers never expire too early, therefore the expiration time is rounded up to the next tick
+    unsigned long expires = Timer->Expires / TIMER_WHEEL_RESOLUTION + ((Timer->Expires % TIMER_WHEEL_RESOLUTION) != 0);
+    unsigned long maxDelta = (1UL << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS)) - 1;
+    unsigned long delta;
+    int level = 0;
+    int slot;
+
+    // Already expired timers are processed with the next tick
+    if (expires < timerWheel.CurrentTick)
+        expires = timerWheel.CurrentTick;
+
+    // Timers beyond the range of the last level are clamped to it, and are cascaded again later
+    delta = expires - timerWheel.CurrentTick;
+
+    if (delta > maxDelta)
+    {
+        delta = maxDelta;
+        expires = timerWheel.CurrentTick + maxDelta;
+    }
+
+    // Find the level that covers the expiration time
+    while (delta >= (1UL << (TIMER_WHEEL_SLOT_BITS * (level + 1))))
+        level++;
+
+    slot = (expires >> (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOT_MASK;
+
+    // Add the timer to the front of the slot
+    Timer->Level = level;
+    Timer->Slot = slot;
+    Timer->Previous = 0x0;
+    Timer->Next = timerWheel.Slots[level][slot];
+
+    if (Timer->Next != 0x0)
+        Timer->Next->Previous = Timer;
+
+    timerWheel.Slots[level][slot] = Timer;
+    timerWheel.OccupiedSlots[level] |= (1UL << slot);
+}
+
+// Removes the given timer from its slot of the Timer Wheel
+static void RemoveTimer(Timer *Timer)
+{
+    if (Timer->Previous != 0x0)
+        Timer->Previous->Next = Timer->Next;
+    else
+        timerWheel.Slots[Timer->Level][Timer->Slot] = Timer->Next;
+
+    if (Timer->Next != 0x0)
+        Timer->Next->Previous = Timer->Previous;
+
+    // The slot is now empty
+    if (timerWheel.Slots[Timer->Level][Timer->Slot] == 0x0)
+        timerWheel.OccupiedSlots[Timer->Level] &= ~(1UL << Timer->Slot);
+
+    Timer->Next = 0x0;
+    Timer->Previous = 0x0;
+}
+
+// Moves the timers of the given slot into the lower levels of the Timer Wheel
+static void CascadeTimers(int Level, int Slot)
+{
+    Timer *timer = timerWheel.Slots[Level][Slot];
+
+    // Detach all timers from the slot
+    timerWheel.Slots[Level][Slot] = 0x0;
+    timerWheel.OccupiedSlots[Level] &= ~(1UL << Slot);
+
+    // Insert the timers again - based on the current tick they are stored in a lower level
+    while (timer != 0x0)
+    {
+        Timer *next = timer->Next;
+        InsertTimer(timer);
+        timer = next;
+    }
+}
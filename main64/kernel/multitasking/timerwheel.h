@@ -0,0 +1,88 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+// The resolution of the Timer Wheel in nanoseconds (100us)
+#define TIMER_WHEEL_RESOLUTION      100000
+
+// The Timer Wheel consists of 5 levels with 64 slots each.
+// Level 0 covers the next 6.4ms with a resolution of 100us, and every further level
+// covers a 64 times larger period of time with a 64 times coarser resolution.
+// The last level covers roughly 30 hours - timers that expire later are clamped to it.
+#define TIMER_WHEEL_LEVELS          5
+#define TIMER_WHEEL_SLOT_BITS       6
+#define TIMER_WHEEL_SLOTS           (1 << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_SLOT_MASK       (TIMER_WHEEL_SLOTS - 1)
+
+// Returned by "GetNextTimerExpiry", when no timer is pending
+#define TIMER_NOT_PENDING           0xFFFFFFFFFFFFFFFF
+
+// The function that is called when a timer expires
+typedef void (*TimerCallback)(void *Context);
+
+// Represents a timer.
+// The structure is embedded into the owning structure (like the "Task" structure), therefore
+// adding a timer to the Timer Wheel doesn't allocate any memory from the Heap.
+typedef struct Timer
+{
+    // The timers of a slot are stored in a Double Linked List
+    struct Timer *Next;
+    struct Timer *Previous;
+
+    // The point in time (nanoseconds of the monotonic clock) when the timer expires
+    unsigned long Expires;
+
+    // The function that is called when the timer expires, and its parameter
+    TimerCallback Callback;
+    void *Context;
+
+    // The level and the slot in which the timer is currently stored
+    int Level;
+    int Slot;
+
+    // 1 if the timer is currently stored in the Timer Wheel
+    int Pending;
+} Timer;
+
+// Represents the Timer Wheel
+typedef struct TimerWheel
+{
+    // The heads of the Double Linked Lists of each slot
+    Timer *Slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+
+    // One bit per slot, which is set if the slot contains at least one timer
+    unsigned long OccupiedSlots[TIMER_WHEEL_LEVELS];
+
+    // The next tick (in units of TIMER_WHEEL_RESOLUTION) that must be processed
+    unsigned long CurrentTick;
+
+    // The number of pending timers
+    unsigned long PendingTimers;
+} TimerWheel;
+
+// Initializes the Timer Wheel
+void InitTimerWheel();
+
+// Adds the given timer to the Timer Wheel.
+// The timer expires at the given point in time (nanoseconds of the monotonic clock).
+void AddTimer(Timer *Timer, unsigned long Expires, TimerCallback Callback, void *Context);
+
+// Removes the given timer from the Timer Wheel.
+// Returns 1 if the timer was pending, otherwise 0.
+int CancelTimer(Timer *Timer);
+
+// Calls the callback functions of all expired timers
+void RunExpiredTimers();
+
+// Returns the point in time (nanoseconds of the monotonic clock) when the Timer Wheel must be processed the next time
+unsigned long GetNextTimerExpiry();
+
+// Stores the given timer in the corresponding slot of the Timer Wheel
+static void InsertTimer(Timer *Timer);
+
+// Removes the given timer from its slot of the Timer Wheel
+static void RemoveTimer(Timer *Timer);
+
+// Moves the timers of the given slot into the lower levels of the Timer Wheel
+static void CascadeTimers(int Level, int Slot);
+
+#endif
@@ -0,0 +1,132 @@
+#include "waitqueue.h"
+
+// Initializes a Wait Queue with the given name
+void InitWaitQueue(WaitQueue *Queue, char *Name)
+{
+    InitSpinlock(&Queue->Lock, Name);
+    Queue->Head = 0x0;
+    Queue->Tail = 0x0;
+}
+
+// Blocks the current Task on the Wait Queue until it gets woken up.
+// The caller must hold the lock of the Wait Queue with disabled interrupts. The lock is released while the Task
+// is blocked, and it's held again when the function returns - so the caller can check its wakeup condition.
+void SleepOnWaitQueue(WaitQueue *Queue, WaitQueueEntry *Entry, int Exclusive)
+{
+    Task *task = GetTaskState();
+
+    Entry->Task = task;
+    Entry->Exclusive = Exclusive;
+    Entry->Woken = 0;
+    Entry->Next = 0x0;
+
+    // Append the Task at the end of the Wait Queue, so that the waiting Tasks are woken up in FIFO order
+    if (Queue->Tail != 0x0)
+        Queue->Tail->Next = Entry;
+    else
+        Queue->Head = Entry;
+
+    Queue->Tail = Entry;
+
+    while (__atomic_load_n(&Entry->Woken, __ATOMIC_ACQUIRE) == 0)
+    {
+        // The Task announces its wait while it still holds the lock, therefore the wakeup can't get lost
+        PrepareToWait(task);
+        ReleaseSpinlock(&Queue->Lock);
+
+        if (__atomic_load_n(&Entry->Woken, __ATOMIC_ACQUIRE) == 0)
+            YieldTask();
+
+        FinishWait(task);
+        AcquireSpinlock(&Queue->Lock);
+    }
+}
+
+// Returns the first entry of the Wait Queue without removing it, or 0 if no Task is waiting.
+// The caller must hold the lock of the Wait Queue.
+WaitQueueEntry *PeekWaitQueue(WaitQueue *Queue)
+{
+    return Queue->Head;
+}
+
+// Removes the first entry from the Wait Queue, and wakes up its Task.
+// The caller must hold the lock of the Wait Queue. It returns the woken up Task, or 0 if no Task was waiting.
+Task *WakeUpFirstWaiter(WaitQueue *Queue)
+{
+    WaitQueueEntry *entry = Queue->Head;
+    Task *task;
+
+    if (entry == 0x0)
+        return 0x0;
+
+    Queue->Head = entry->Next;
+
+    if (Queue->Head == 0x0)
+        Queue->Tail = 0x0;
+
+    // The entry lives on the Stack of the waiting Task, so it must not be accessed anymore after "Woken" was set
+    task = entry->Task;
+    __atomic_store_n(&entry->Woken, 1, __ATOMIC_RELEASE);
+    WakeUpTask(task);
+
+    return task;
+}
+
+// Wakes up all Tasks that are waiting on the Wait Queue.
+// The caller must hold the lock of the Wait Queue. It returns the number of woken up Tasks.
+int WakeUpAllWaiters(WaitQueue *Queue)
+{
+    int count = 0;
+
+    while (WakeUpFirstWaiter(Queue) != 0x0)
+        count++;
+
+    return count;
+}
+
+// Blocks the current Task on the Wait Queue until it gets woken up for the given key.
+// The caller must hold the lock of the Wait Queue with disabled interrupts.
+void SleepOnWaitQueueWithKey(WaitQueue *Queue, WaitQueueEntry *Entry, unsigned long Key)
+{
+    Entry->Key = Key;
+    SleepOnWaitQueue(Queue, Entry, 0);
+}
+
+// Wakes up the first Tasks (up to the given count) that are waiting for the given key.
+// The other Tasks stay in the Wait Queue in their FIFO order.
+// The caller must hold the lock of the Wait Queue. It returns the number of woken up Tasks.
+int WakeUpWaitersWithKey(WaitQueue *Queue, unsigned long Key, int Count)
+{
+    WaitQueueEntry *previous = 0x0;
+    WaitQueueEntry *entry = Queue->Head;
+    int count = 0;
+
+    while ((entry != 0x0) && (count < Count))
+    {
+        WaitQueueEntry *next = entry->Next;
+
+        if (entry->Key == Key)
+        {
+            Task *task = entry->Task;
+
+            if (previous != 0x0)
+                previous->Next = next;
+            else
+                Queue->Head = next;
+
+            if (Queue->Tail == entry)
+                Queue->Tail = previous;
+
+            // The entry lives on the Stack of the waiting Task, so it must not be accessed anymore after "Woken" was set
+            __atomic_store_n(&entry->Woken, 1, __ATOMIC_RELEASE);
+            WakeUpTask(task);
+            count++;
+        }
+        else
+            previous = entry;
+
+        entry = next;
+    }
+
+    return count;
+}
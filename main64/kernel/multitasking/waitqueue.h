@@ -0,0 +1,66 @@
+#ifndef WAITQUEUE_H
+#define WAITQUEUE_H
+
+#include "multitasking.h"
+#include "spinlock.h"
+
+// Initializes a statically allocated Wait Queue with the given name (used for the statistics of its lock)
+#define WAIT_QUEUE_INITIALIZER(name) { .Lock = SPINLOCK_INITIALIZER(name) }
+
+// Represents a Task that waits on a Wait Queue.
+// The entry is stored on the Kernel Mode Stack of the waiting Task, because the Task can't continue until it's woken up.
+typedef struct WaitQueueEntry
+{
+    // The waiting Task
+    Task *Task;
+
+    // 1 if the Task waits for exclusive access (like a writer of a Reader-Writer Semaphore)
+    int Exclusive;
+
+    // The key the Task waits for, when several wait conditions are sharing the same Wait Queue (like the futexes)
+    unsigned long Key;
+
+    // Set by the waker, after the entry was removed from the Wait Queue
+    volatile int Woken;
+
+    struct WaitQueueEntry *Next;
+} WaitQueueEntry;
+
+// Represents a FIFO queue of blocked Tasks
+typedef struct WaitQueue
+{
+    // Protects the Wait Queue, and the state of the synchronization primitive that uses it
+    Spinlock Lock;
+
+    WaitQueueEntry *Head;
+    WaitQueueEntry *Tail;
+} WaitQueue;
+
+// Initializes a Wait Queue with the given name
+void InitWaitQueue(WaitQueue *Queue, char *Name);
+
+// Blocks the current Task on the Wait Queue until it gets woken up.
+// The caller must hold the lock of the Wait Queue with disabled interrupts.
+void SleepOnWaitQueue(WaitQueue *Queue, WaitQueueEntry *Entry, int Exclusive);
+
+// Returns the first entry of the Wait Queue without removing it, or 0 if no Task is waiting.
+// The caller must hold the lock of the Wait Queue.
+WaitQueueEntry *PeekWaitQueue(WaitQueue *Queue);
+
+// Removes the first entry from the Wait Queue, and wakes up its Task.
+// The caller must hold the lock of the Wait Queue. It returns the woken up Task, or 0 if no Task was waiting.
+Task *WakeUpFirstWaiter(WaitQueue *Queue);
+
+// Wakes up all Tasks that are waiting on the Wait Queue.
+// The caller must hold the lock of the Wait Queue. It returns the number of woken up Tasks.
+int WakeUpAllWaiters(WaitQueue *Queue);
+
+// Blocks the current Task on the Wait Queue until it gets woken up for the given key.
+// The caller must hold the lock of the Wait Queue with disabled interrupts.
+void SleepOnWaitQueueWithKey(WaitQueue *Queue, WaitQueueEntry *Entry, unsigned long Key);
+
+// Wakes up the first Tasks (up to the given count) that are waiting for the given key.
+// The caller must hold the lock of the Wait Queue. It returns the number of woken up Tasks.
+int WakeUpWaitersWithKey(WaitQueue *Queue, unsigned long Key, int Count);
+
+#endif
@@ -0,0 +1,162 @@
+#include "workqueue.h"
+#include "realtime.h"
+#include "../isr/idt.h"
+#include "../common.h"
+
+// The Work Queue of the Kernel.
+// Interrupt Handlers only do the absolute minimum of work, and defer everything else into this Work Queue.
+WorkQueue workQueue;
+
+// Initializes the Work Queue
+void InitWorkQueue()
+{
+    int i;
+
+    memset(&workQueue, 0, sizeof(WorkQueue));
+
+    // Initially, the sequence number of each Work Item is its position in the ring buffer
+    for (i = 0; i < WORK_QUEUE_SIZE; i++)
+        workQueue.Items[i].Sequence = i;
+}
+
+// Creates the Kernel Mode Worker Tasks
+void CreateWorkQueueWorkers()
+{
+    int i;
+
+    for (i = 0; i < WORK_QUEUE_WORKERS; i++)
+    {
+        // Each Worker Task gets its own 64 KB Kernel Mode Stack.
+        // The Worker Tasks are completing the interrupt work, therefore they are Real-Time Tasks.
+        workQueue.Workers[i] = CreateKernelModeTask(WorkQueueWorkerTask, WORK_QUEUE_WORKER_STACK - i * 0x10000);
+        SetRealTimeScheduling(workQueue.Workers[i], RT_PRIORITY_WORK_QUEUE, RT_KERNEL_RUNTIME_NANOSECONDS, RT_KERNEL_PERIOD_NANOSECONDS);
+    }
+}
+
+// Queues a Work Item, which is executed later by a Worker Task.
+// This function can be called from Interrupt Handlers. It returns 0 if the Work Queue is full.
+int QueueWork(WorkFunction Function, void *Context)
+{
+    unsigned long position = __atomic_load_n(&workQueue.EnqueuePosition, __ATOMIC_RELAXED);
+    WorkItem *item;
+    int i;
+
+    while (1 == 1)
+    {
+        item = &workQueue.Items[position & WORK_QUEUE_MASK];
+        long difference = (long)__atomic_load_n(&item->Sequence, __ATOMIC_ACQUIRE) - (long)position;
+
+        if (difference == 0)
+        {
+            // The Work Item is free, so we try to reserve it
+            if (__atomic_compare_exchange_n(&workQueue.EnqueuePosition, &position, position + 1, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+        else if (difference < 0)
+        {
+            // The Work Queue is full
+            return 0;
+        }
+        else
+        {
+            // Another producer has reserved the Work Item in the meantime
+            position = __atomic_load_n(&workQueue.EnqueuePosition, __ATOMIC_RELAXED);
+        }
+    }
+
+    // Fill out the reserved Work Item, and publish it to the Worker Tasks
+    item->Function = Function;
+    item->Context = Context;
+    __atomic_store_n(&item->Sequence, position + 1, __ATOMIC_RELEASE);
+
+    // The Work Item must be visible before we check for a waiting Worker Task (see "WorkQueueWorkerTask")
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    // Wake up a waiting Worker Task.
+    // Adding it to a run queue interrupts an idle processor, so that the Worker Task doesn't wait for the end of a time slice.
+    for (i = 0; i < WORK_QUEUE_WORKERS; i++)
+    {
+        Task *worker = workQueue.Workers[i];
+
+        if ((worker != 0x0) && (worker->Status == TASK_STATUS_WAITING))
+        {
+            WakeUpTask(worker);
+            break;
+        }
+    }
+
+    return 1;
+}
+
+// The Kernel Mode Worker Task that executes the queued Work Items
+void WorkQueueWorkerTask()
+{
+    Task *worker = GetTaskState();
+
+    while (1 == 1)
+    {
+        WorkFunction function;
+        void *context;
+
+        // The interrupts are disabled while we check the Work Queue, so that the Worker Task isn't preempted
+        // between the check and the blocking.
+        unsigned long flags = SaveFlagsAndDisableInterrupts();
+
+        while (1 == 1)
+        {
+            // The Worker Task announces its wait before it checks the Work Queue, so that a Work Item that is queued
+            // concurrently (by an Interrupt Handler or by another processor) can't get lost.
+            PrepareToWait(worker);
+
+            if (DequeueWork(&function, &context) == 1)
+                break;
+
+            // The Work Queue is empty, so we wait until the next Work Item is queued
+            YieldTask();
+        }
+
+        FinishWait(worker);
+        RestoreFlags(flags);
+
+        // Execute the Work Item with enabled interrupts
+        function(context);
+    }
+}
+
+// Dequeues the next Work Item. It returns 0 if the Work Queue is empty.
+static int DequeueWork(WorkFunction *Function, void **Context)
+{
+    unsigned long position = __atomic_load_n(&workQueue.DequeuePosition, __ATOMIC_RELAXED);
+    WorkItem *item;
+
+    while (1 == 1)
+    {
+        item = &workQueue.Items[position & WORK_QUEUE_MASK];
+        long difference = (long)__atomic_load_n(&item->Sequence, __ATOMIC_ACQUIRE) - (long)(position + 1);
+
+        if (difference == 0)
+        {
+            // The Work Item is filled, so we try to take it
+            if (__atomic_compare_exchange_n(&workQueue.DequeuePosition, &position, position + 1, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+        else if (difference < 0)
+        {
+            // The Work Queue is empty
+            return 0;
+        }
+        else
+        {
+            // Another Worker Task has taken the Work Item in the meantime
+            position = __atomic_load_n(&workQueue.DequeuePosition, __ATOMIC_RELAXED);
+        }
+    }
+
+    *Function = item->Function;
+    *Context = item->Context;
+
+    // Release the Work Item for the next round through the ring buffer
+    __atomic_store_n(&item->Sequence, position + WORK_QUEUE_SIZE, __ATOMIC_RELEASE);
+
+    return 1;
+}
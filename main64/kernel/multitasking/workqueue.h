@@ -0,0 +1,61 @@
+#ifndef WORKQUEUE_H
+#define WORKQUEUE_H
+
+#include "multitasking.h"
+
+// The number of Work Items that can be queued (must be a power of 2)
+#define WORK_QUEUE_SIZE             256
+#define WORK_QUEUE_MASK             (WORK_QUEUE_SIZE - 1)
+
+// The number of Kernel Mode Worker Tasks that execute the queued Work Items.
+// The Work Items of the keyboard must be executed in order, therefore we only use 1 Worker Task.
+#define WORK_QUEUE_WORKERS          1
+
+// The Kernel Mode Stacks of the Worker Tasks
+#define WORK_QUEUE_WORKER_STACK     0xFFFF800001300000
+
+// The function that is executed by a Worker Task
+typedef void (*WorkFunction)(void *Context);
+
+// Represents a Work Item in the ring buffer of the Work Queue
+typedef struct WorkItem
+{
+    // The sequence number tells the producers and the consumers, if the Work Item is free or filled
+    unsigned long Sequence;
+
+    // The function to be executed, and its parameter
+    WorkFunction Function;
+    void *Context;
+} WorkItem;
+
+// Represents the Work Queue.
+// It's a lock-free ring buffer, so that Interrupt Handlers can queue Work Items without taking any locks.
+typedef struct WorkQueue
+{
+    WorkItem Items[WORK_QUEUE_SIZE];
+
+    // The next positions where a Work Item is queued and dequeued
+    unsigned long EnqueuePosition;
+    unsigned long DequeuePosition;
+
+    // The Worker Tasks that execute the Work Items
+    Task *Workers[WORK_QUEUE_WORKERS];
+} WorkQueue;
+
+// Initializes the Work Queue
+void InitWorkQueue();
+
+// Creates the Kernel Mode Worker Tasks
+void CreateWorkQueueWorkers();
+
+// Queues a Work Item, which is executed later by a Worker Task.
+// This function can be called from Interrupt Handlers. It returns 0 if the Work Queue is full.
+int QueueWork(WorkFunction Function, void *Context);
+
+// The Kernel Mode Worker Task that executes the queued Work Items
+void WorkQueueWorkerTask();
+
+// Dequeues the next Work Item. It returns 0 if the Work Queue is empty.
+static int DequeueWork(WorkFunction *Function, void **Context);
+
+#endif
@@ -0,0 +1,254 @@
+#include "ioring.h"
+#include "syscall.h"
+#include "../multitasking/thread.h"
+#include "../io/pipe.h"
+#include "../memory/heap.h"
+#include "../memory/physical-memory.h"
+#include "../memory/virtual-memory.h"
+#include "../common.h"
+
+// The I/O Rings of the processes.
+// They are statically allocated, because the locks of their Wait Queues are registered on their first acquisition.
+IoRing ioRings[MAX_IO_RINGS] =
+{
+    [0 ... MAX_IO_RINGS - 1] = { .CompletionWaitQueue = WAIT_QUEUE_INITIALIZER("IoRing") }
+};
+
+// The queued batches in FIFO order.
+// The I/O Ring Worker Task waits on the Wait Queue, and its lock also protects the list of the queued batches.
+IoRingBatch *ioRingBatchHead = 0x0;
+IoRingBatch *ioRingBatchTail = 0x0;
+WaitQueue ioRingWorkerWaitQueue = WAIT_QUEUE_INITIALIZER("IoRingWorker");
+
+// Creates the Kernel Mode I/O Ring Worker Task
+void CreateIoRingWorker()
+{
+    CreateKernelModeTask(IoRingWorkerTask, IO_RING_WORKER_STACK);
+}
+
+// Returns the User Mode address of the I/O Ring of the process of the given Task (the current one).
+// The I/O Ring is created with the first call. It returns 0 if no I/O Ring is available.
+// It's called under the Kernel Lock, therefore the threads of a process can't create two I/O Rings.
+unsigned long SetupIoRing(Task *Task)
+{
+    ThreadGroup *group = Task->ThreadGroup;
+    IoRing *ring = 0x0;
+    int i;
+
+    // Only User Mode processes can use an I/O Ring
+    if (group == 0x0)
+        return 0;
+
+    if (group->IoRing != 0x0)
+        return IO_RING_USERMODE_ADDRESS;
+
+    // The process has already used the address of the shared page
+    if (GetPhysicalAddress(IO_RING_USERMODE_ADDRESS) != 0)
+        return 0;
+
+    // Reserve a free I/O Ring
+    for (i = 0; (i < MAX_IO_RINGS) && (ring == 0x0); i++)
+    {
+        int expected = 0;
+
+        if (__atomic_compare_exchange_n(&ioRings[i].ReferenceCount, &expected, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            ring = &ioRings[i];
+    }
+
+    if (ring == 0x0)
+        return 0;
+
+    // The shared page stays mapped into the Kernel Mode address space, so that no other processor can cache a stale mapping
+    if (ring->PageFrame == 0)
+    {
+        ring->PageFrame = AllocatePageFrame();
+        ring->Shared = (IoRingShared *)(IO_RING_KERNEL_BASE + (ring - ioRings) * SMALL_PAGE_SIZE);
+        MapVirtualAddressToPhysicalAddress((unsigned long)ring->Shared, ring->PageFrame * SMALL_PAGE_SIZE);
+    }
+
+    memset(ring->Shared, 0, SMALL_PAGE_SIZE);
+    ring->CR3 = Task->CR3;
+    ring->InFlight = 0;
+
+    // Map the shared page into the address space of the process
+    MapVirtualAddressToPhysicalAddress(IO_RING_USERMODE_ADDRESS, ring->PageFrame * SMALL_PAGE_SIZE);
+    group->IoRing = ring;
+
+    return IO_RING_USERMODE_ADDRESS;
+}
+
+// Submits up to the given number of operations from the Submission Queue, and waits until the given number of
+// completions is available. It returns the number of submitted operations.
+// Only as many operations are submitted, as completions fit into the Completion Queue. The current Task blocks,
+// therefore the caller must not hold the Kernel Lock or any Spinlock.
+int EnterIoRing(Task *Task, int ToSubmit, int MinComplete)
+{
+    IoRing *ring = Task->ThreadGroup != 0x0 ? Task->ThreadGroup->IoRing : 0x0;
+    IoRingShared *shared;
+    IoRingBatch *batch;
+    WaitQueueEntry entry;
+    unsigned long flags;
+    unsigned int head;
+    int count;
+
+    if (ring == 0x0)
+        return 0;
+
+    shared = ring->Shared;
+    batch = (IoRingBatch *)malloc(sizeof(IoRingBatch));
+    batch->Ring = ring;
+    batch->Count = 0;
+    batch->Next = 0x0;
+
+    // Consume the operations from the Submission Queue.
+    // The operations are copied, because User Mode can overwrite their entries as soon as the head has moved on.
+    flags = AcquireSpinlockIrqSave(&ring->CompletionWaitQueue.Lock);
+    head = shared->SubmissionHead;
+
+    while ((batch->Count < ToSubmit) && (batch->Count < IO_RING_ENTRIES) &&
+           (head != __atomic_load_n(&shared->SubmissionTail, __ATOMIC_ACQUIRE)) &&
+           (ring->InFlight + (shared->CompletionTail - shared->CompletionHead) < IO_RING_COMPLETION_ENTRIES))
+    {
+        batch->Submissions[batch->Count++] = shared->Submissions[head & IO_RING_MASK];
+        ring->InFlight++;
+        head++;
+    }
+
+    __atomic_store_n(&shared->SubmissionHead, head, __ATOMIC_RELEASE);
+    ReleaseSpinlockIrqRestore(&ring->CompletionWaitQueue.Lock, flags);
+    count = batch->Count;
+
+    if (count > 0)
+    {
+        // The batch keeps the I/O Ring alive, even when the process terminates in the meantime
+        __atomic_add_fetch(&ring->ReferenceCount, 1, __ATOMIC_RELAXED);
+
+        // Queue the batch, and wake up the I/O Ring Worker Task
+        flags = AcquireSpinlockIrqSave(&ioRingWorkerWaitQueue.Lock);
+
+        if (ioRingBatchTail != 0x0)
+            ioRingBatchTail->Next = batch;
+        else
+            ioRingBatchHead = batch;
+
+        ioRingBatchTail = batch;
+        WakeUpFirstWaiter(&ioRingWorkerWaitQueue);
+        ReleaseSpinlockIrqRestore(&ioRingWorkerWaitQueue.Lock, flags);
+    }
+    else
+        free(batch);
+
+    // Wait until enough completions are available - but not for completions that can't arrive anymore
+    flags = AcquireSpinlockIrqSave(&ring->CompletionWaitQueue.Lock);
+
+    while ((ring->InFlight > 0) && ((int)(shared->CompletionTail - shared->CompletionHead) < MinComplete))
+        SleepOnWaitQueue(&ring->CompletionWaitQueue, &entry, 0);
+
+    ReleaseSpinlockIrqRestore(&ring->CompletionWaitQueue.Lock, flags);
+
+    return count;
+}
+
+// Releases the reference of a terminated process (or of an executed batch) to its I/O Ring.
+// The I/O Ring can be reused by another process afterwards.
+void ReleaseIoRing(IoRing *Ring)
+{
+    __atomic_sub_fetch(&Ring->ReferenceCount, 1, __ATOMIC_RELEASE);
+}
+
+// The Kernel Mode I/O Ring Worker Task that executes the submitted operations.
+// The operations are executed one after another, so that a chain of linked operations (like reading and writing
+// the same buffer) keeps its order.
+void IoRingWorkerTask()
+{
+    WaitQueueEntry entry;
+
+    while (1 == 1)
+    {
+        IoRingBatch *batch;
+        int cancel = 0;
+        int i;
+        unsigned long flags = AcquireSpinlockIrqSave(&ioRingWorkerWaitQueue.Lock);
+
+        // Wait until a batch is queued
+        while (ioRingBatchHead == 0x0)
+            SleepOnWaitQueue(&ioRingWorkerWaitQueue, &entry, 1);
+
+        batch = ioRingBatchHead;
+        ioRingBatchHead = batch->Next;
+
+        if (ioRingBatchHead == 0x0)
+            ioRingBatchTail = 0x0;
+
+        ReleaseSpinlockIrqRestore(&ioRingWorkerWaitQueue.Lock, flags);
+
+        // The operations are accessing the User Mode buffers of the process, therefore we switch into its address space
+        SwitchPageDirectory((PageMapLevel4Table *)batch->Ring->CR3);
+
+        for (i = 0; i < batch->Count; i++)
+        {
+            IoRingSubmission *submission = &batch->Submissions[i];
+            long result = cancel ? IO_RING_RESULT_CANCELED : ExecuteIoRingOperation(submission);
+
+            CompleteIoRingOperation(batch->Ring, submission->UserData, result);
+
+            // A failed operation cancels the rest of its chain, which ends with the first operation that isn't linked
+            if (submission->Flags & IO_RING_LINK)
+                cancel = cancel || (result <= 0);
+            else
+                cancel = 0;
+        }
+
+        // Switch back to the Kernel Mode address space
+        SwitchPageDirectory((PageMapLevel4Table *)GetPML4Address());
+
+        ReleaseIoRing(batch->Ring);
+        free(batch);
+    }
+}
+
+// Executes the given operation in the address space of its process.
+// Only the SysCalls that are flagged with SYSCALL_FLAG_ASYNC can be executed, because they don't depend on the
+// calling Task. The arguments are passed through the same registers as by a SysCall.
+//
+// The operations on a pipe handle are rejected, because a pipe can block until another process reads or writes it.
+// All I/O Rings are sharing the same worker, so a blocked pipe operation would stall the rings of all processes.
+static long ExecuteIoRingOperation(IoRingSubmission *Submission)
+{
+    SysCallDescriptor *descriptor = GetSysCallDescriptor(Submission->Operation);
+    SysCallRegisters registers;
+
+    if ((descriptor == 0x0) || !(descriptor->Flags & SYSCALL_FLAG_ASYNC))
+        return IO_RING_RESULT_INVALID;
+
+    // The file SysCalls are getting the file handle as their first integer argument
+    if ((descriptor->ArgumentTypes[0] == 'i') && IsPipeHandle(Submission->Arguments[0]))
+        return IO_RING_RESULT_INVALID;
+
+    registers.RDI = Submission->Operation;
+    registers.RSI = Submission->Arguments[0];
+    registers.RDX = Submission->Arguments[1];
+    registers.RCX = Submission->Arguments[2];
+    registers.R8 = Submission->Arguments[3];
+    registers.R9 = Submission->Arguments[4];
+    registers.RAX = 0;
+
+    return DispatchSysCall(descriptor, &registers);
+}
+
+// Posts a completion into the Completion Queue, and wakes up the waiting threads.
+// There is always a free entry, because "EnterIoRing" only submits as many operations as completions fit.
+static void CompleteIoRingOperation(IoRing *Ring, unsigned long UserData, long Result)
+{
+    IoRingShared *shared = Ring->Shared;
+    unsigned long flags = AcquireSpinlockIrqSave(&Ring->CompletionWaitQueue.Lock);
+    unsigned int tail = shared->CompletionTail;
+
+    shared->Completions[tail & IO_RING_COMPLETION_MASK].UserData = UserData;
+    shared->Completions[tail & IO_RING_COMPLETION_MASK].Result = Result;
+    __atomic_store_n(&shared->CompletionTail, tail + 1, __ATOMIC_RELEASE);
+    Ring->InFlight--;
+
+    WakeUpAllWaiters(&Ring->CompletionWaitQueue);
+    ReleaseSpinlockIrqRestore(&Ring->CompletionWaitQueue.Lock, flags);
+}
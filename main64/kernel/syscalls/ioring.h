@@ -0,0 +1,127 @@
+#ifndef IORING_H
+#define IORING_H
+
+#include "../multitasking/multitasking.h"
+#include "../multitasking/waitqueue.h"
+
+// The number of entries of the Submission Queue, and of the Completion Queue (must be powers of 2).
+// The Completion Queue is twice as large, so that User Mode can submit a new batch before it has consumed all completions.
+#define IO_RING_ENTRIES                 32
+#define IO_RING_MASK                    (IO_RING_ENTRIES - 1)
+#define IO_RING_COMPLETION_ENTRIES      64
+#define IO_RING_COMPLETION_MASK         (IO_RING_COMPLETION_ENTRIES - 1)
+
+// The maximum number of arguments of an operation (the SysCall arguments without the SysCall number)
+#define IO_RING_ARGUMENTS               5
+
+// The maximum number of processes that can use an I/O Ring at the same time
+#define MAX_IO_RINGS                    16
+
+// The shared page of an I/O Ring is mapped at this address into the User Mode process
+#define IO_RING_USERMODE_ADDRESS        0x0000600000000000
+
+// The shared pages of the I/O Rings are mapped one after another into the Kernel Mode address space
+#define IO_RING_KERNEL_BASE             0xFFFF800003000000
+
+// The Kernel Mode Stack of the I/O Ring Worker Task
+#define IO_RING_WORKER_STACK            0xFFFF800001400000
+
+// The operation is linked with the next one: when it fails (result <= 0), the rest of the chain is canceled
+#define IO_RING_LINK                    0x1
+
+// The results of the operations that were not executed (an operation on a pipe handle is invalid, because it can block)
+#define IO_RING_RESULT_INVALID          -1
+#define IO_RING_RESULT_CANCELED         -2
+
+// Represents an operation in the Submission Queue.
+// The operation is a SysCall number, and the arguments are passed like the registers of the SysCall.
+// The same structure is defined in the file "libc.h".
+typedef struct IoRingSubmission
+{
+    int Operation;
+    int Flags;
+    unsigned long Arguments[IO_RING_ARGUMENTS];
+
+    // An opaque value that is returned in the completion of the operation
+    unsigned long UserData;
+} IoRingSubmission;
+
+// Represents a completed operation in the Completion Queue.
+// The same structure is defined in the file "libc.h".
+typedef struct IoRingCompletion
+{
+    unsigned long UserData;
+    long Result;
+} IoRingCompletion;
+
+// The page that is shared between the Kernel and a User Mode process.
+// User Mode produces the operations at the SubmissionTail, and the Kernel consumes them at the SubmissionHead.
+// The Kernel produces the completions at the CompletionTail, and User Mode consumes them at the CompletionHead.
+// The positions are running freely, and they are masked when they index into a queue.
+// The same structure is defined in the file "libc.h".
+typedef struct IoRingShared
+{
+    volatile unsigned int SubmissionHead;
+    volatile unsigned int SubmissionTail;
+    volatile unsigned int CompletionHead;
+    volatile unsigned int CompletionTail;
+    IoRingSubmission Submissions[IO_RING_ENTRIES];
+    IoRingCompletion Completions[IO_RING_COMPLETION_ENTRIES];
+} IoRingShared;
+
+// Represents the I/O Ring of a process in the Kernel
+typedef struct IoRing
+{
+    // The shared page in the Kernel Mode address space.
+    // Its Page Frame is allocated with the first use of the slot, and it's reused by the following processes.
+    IoRingShared *Shared;
+    unsigned long PageFrame;
+
+    // The address space of the process, in which the I/O Ring Worker Task executes the operations
+    unsigned long CR3;
+
+    // The process and every queued batch are holding a reference. The slot is free when it's 0.
+    volatile int ReferenceCount;
+
+    // The number of consumed operations that are not completed yet
+    int InFlight;
+
+    // The threads of the process are waiting here for completions.
+    // The lock of the Wait Queue also protects the positions of the queues.
+    WaitQueue CompletionWaitQueue;
+} IoRing;
+
+// A batch of operations that was consumed from a Submission Queue by one "EnterIoRing" call.
+// The operations of a batch are executed in order, therefore they can be linked.
+typedef struct IoRingBatch
+{
+    IoRing *Ring;
+    int Count;
+    IoRingSubmission Submissions[IO_RING_ENTRIES];
+    struct IoRingBatch *Next;
+} IoRingBatch;
+
+// Creates the Kernel Mode I/O Ring Worker Task
+void CreateIoRingWorker();
+
+// Returns the User Mode address of the I/O Ring of the process of the given Task (the current one).
+// The I/O Ring is created with the first call. It returns 0 if no I/O Ring is available.
+unsigned long SetupIoRing(Task *Task);
+
+// Submits up to the given number of operations from the Submission Queue, and waits until the given number of
+// completions is available. It returns the number of submitted operations.
+int EnterIoRing(Task *Task, int ToSubmit, int MinComplete);
+
+// Releases the reference of a terminated process to its I/O Ring
+void ReleaseIoRing(IoRing *Ring);
+
+// The Kernel Mode I/O Ring Worker Task that executes the submitted operations
+void IoRingWorkerTask();
+
+// Executes the given operation in the address space of its process
+static long ExecuteIoRingOperation(IoRingSubmission *Submission);
+
+// Posts a completion into the Completion Queue, and wakes up the waiting threads
+static void CompleteIoRingOperation(IoRing *Ring, unsigned long UserData, long Result);
+
+#endif
@@ -1,12 +1,35 @@
 [BITS 64]
 [GLOBAL SysCallHandlerAsm]
+[GLOBAL FastSysCallHandlerAsm]
 [EXTERN SysCallHandlerC]
 
-; Virtual address where the SysCallRegisters structure will be stored
-SYSCALLREGISTERS_OFFSET    EQU 0xFFFF800000064000
+; The size of the SysCallRegisters structure
+SYSCALLREGISTERS_SIZE      EQU 56
+
+; The offsets into the per-CPU data area (C structure "Cpu")
+PERCPU_KERNEL_STACK        EQU 16
+PERCPU_SYSCALL_COUNT       EQU 40
+PERCPU_USER_STACK          EQU 48
+
+; The User Mode Code and Data Segment selectors (with the Requested Privilege Level 3)
+USER_CODE_SEGMENT          EQU 0x23
+USER_DATA_SEGMENT          EQU 0x1B
+
+; Executes SWAPGS, when the interrupted code (or the code that we return to) executes in User Mode.
+; In Kernel Mode the GS base points to the per-CPU data area of the processor, and in User Mode the per-CPU data
+; area is parked in the MSR IA32_KERNEL_GS_BASE. The parameter is the offset of the saved CS register from RSP.
+; (the same macro is defined in the files "idt.asm", "irq.asm", "syscall.asm" and "contextswitching.asm")
+%MACRO SWAPGS_IF_USERMODE 1
+    TEST    QWORD [RSP + %1], 0x3
+    JZ      %%KernelMode
+    SWAPGS
+%%KernelMode:
+%ENDMACRO
 
 SysCallHandlerAsm:
+    SWAPGS_IF_USERMODE 8
     CLI
+    INC     QWORD [GS:PERCPU_SYSCALL_COUNT]
 
     ; Save the General Purpose registers on the Stack
     PUSH    RBX
@@ -26,33 +49,21 @@ SysCallHandlerAsm:
     PUSH    R14
     PUSH    R15
 
-    ; Store the RDI Number
-    MOV     RAX, SYSCALLREGISTERS_OFFSET
-    MOV     [RAX], RDI
-
-    ; Store the RSI register
-    ADD     RAX, 0x8
-    MOV     [RAX], RSI
-
-    ; Store the RDX register
-    ADD     RAX, 0x8
-    MOV     [RAX], RDX
-
-    ; Store the RCX register
-    ADD     RAX, 0x8
-    MOV     [RAX], RCX
-
-    ; Store the R8 register
-    ADD     RAX, 0x8
-    MOV     [RAX], R8
-
-    ; Store the R9 register
-    ADD     RAX, 0x8
-    MOV     [RAX], R9
+    ; Store the SysCall parameters (C structure "SysCallRegisters") on the Kernel Mode Stack of the Task.
+    ; A blocked Task keeps its parameters, while other Tasks are executing SysCalls on other processors.
+    SUB     RSP, SYSCALLREGISTERS_SIZE
+    MOV     [RSP], RDI
+    MOV     [RSP + 0x8], RSI
+    MOV     [RSP + 0x10], RDX
+    MOV     [RSP + 0x18], RCX
+    MOV     [RSP + 0x20], R8
+    MOV     [RSP + 0x28], R9
+    MOV     [RSP + 0x30], RAX
 
     ; Call the ISR handler that is implemented in C
-    MOV     RDI, SYSCALLREGISTERS_OFFSET 
+    MOV     RDI, RSP
     CALL    SysCallHandlerC
+    ADD     RSP, SYSCALLREGISTERS_SIZE
 
     ; Restore the General Purpose registers from the Stack
     POP     R15
@@ -75,5 +86,79 @@ SysCallHandlerAsm:
     POP     RBX     ; Original RAX value
     POP     RBX
 
+    SWAPGS_IF_USERMODE 8
     STI
-    IRETQ
\ No newline at end of file
+    IRETQ
+
+; The entry point of the SYSCALL instruction (MSR IA32_LSTAR).
+; The processor has stored the return address in RCX and RFLAGS in R11, and it has cleared the Interrupt Flag
+; through the MSR IA32_FMASK - but it still executes on the User Mode Stack.
+; The libc stubs are calling a SysCall like a function, therefore only the registers that the called function must
+; preserve (RBX, RBP, R12 - R15) are kept, and "SysCallHandlerC" preserves them already. The 3rd parameter is passed
+; in R10, because RCX is overwritten by the SYSCALL instruction, and the 6th parameter is passed in RAX.
+FastSysCallHandlerAsm:
+    ; Switch to the per-CPU data area and to the Kernel Mode Stack of the current Task
+    SWAPGS
+    MOV     [GS:PERCPU_USER_STACK], RSP
+    MOV     RSP, [GS:PERCPU_KERNEL_STACK]
+    INC     QWORD [GS:PERCPU_SYSCALL_COUNT]
+
+    ; Save the User Mode Stack Pointer, RFLAGS, and the return address on the Kernel Mode Stack.
+    ; The Task can block within the SysCall, and another Task overwrites the per-CPU data in the meantime.
+    PUSH    QWORD [GS:PERCPU_USER_STACK]
+    PUSH    R11
+    PUSH    RCX
+
+    ; Store the SysCall parameters (C structure "SysCallRegisters") on the Kernel Mode Stack of the Task.
+    ; Together with the 3 saved registers the structure keeps the Stack 16 byte aligned for the function call.
+    SUB     RSP, SYSCALLREGISTERS_SIZE
+    MOV     [RSP], RDI
+    MOV     [RSP + 0x8], RSI
+    MOV     [RSP + 0x10], RDX
+    MOV     [RSP + 0x18], R10
+    MOV     [RSP + 0x20], R8
+    MOV     [RSP + 0x28], R9
+    MOV     [RSP + 0x30], RAX
+
+    ; Call the ISR handler that is implemented in C
+    MOV     RDI, RSP
+    CALL    SysCallHandlerC
+    ADD     RSP, SYSCALLREGISTERS_SIZE
+
+    ; Clear the scratch registers, so that no Kernel values are leaking into User Mode
+    XOR     EDI, EDI
+    XOR     ESI, ESI
+    XOR     EDX, EDX
+    XOR     R8D, R8D
+    XOR     R9D, R9D
+    XOR     R10D, R10D
+
+    ; Restore the return address, RFLAGS, and the User Mode Stack Pointer.
+    ; The interrupts stay disabled until SYSRET, so nothing can interrupt us on the User Mode Stack.
+    POP     RCX
+    POP     R11
+
+    ; SYSRET raises the General Protection Fault of a non-canonical return address still in Kernel Mode, but
+    ; already on the User Mode Stack. Such a return address goes through IRETQ, which faults on the Kernel Mode Stack.
+    MOV     RDI, RCX
+    SHL     RDI, 16
+    SAR     RDI, 16
+    CMP     RDI, RCX
+    JNE     FastSysCallReturnIretq
+    XOR     EDI, EDI
+
+    POP     RSP
+    SWAPGS
+    O64 SYSRET
+
+; Returns into User Mode through an interrupt stack frame (the User Mode Stack Pointer is on the Stack)
+FastSysCallReturnIretq:
+    POP     RDI
+    PUSH    QWORD USER_DATA_SEGMENT
+    PUSH    RDI
+    PUSH    R11
+    PUSH    QWORD USER_CODE_SEGMENT
+    PUSH    RCX
+    XOR     EDI, EDI
+    SWAPGS
+    IRETQ
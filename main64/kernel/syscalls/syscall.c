@@ -1,176 +1,891 @@
 #include "../multitasking/multitasking.h"
+#include "../multitasking/smp.h"
+#include "../multitasking/spinlock.h"
+#include "../multitasking/spawnqueue.h"
+#include "../multitasking/realtime.h"
+#include "../multitasking/thread.h"
+#include "../multitasking/futex.h"
+#include "../multitasking/gdt.h"
 #include "../drivers/screen.h"
 #include "../drivers/keyboard.h"
+#include "../drivers/timer.h"
 #include "../io/fat12.h"
+#include "../io/pipe.h"
+#include "../memory/heap.h"
+#include "../memory/sharedmemory.h"
+#include "../isr/idt.h"
 #include "../common.h"
 #include "syscall.h"
+#include "usercopy.h"
+#include "ioring.h"
+#include "systrace.h"
 
-// Implements the SysCall Handler
-// 
-// CAUTION!
-// When the function "SysCallHandlerC" is executed, Interrupts are disabled (performed in the
-// Assembler code).
-// Therefore, it is *safe* to call other functions in the Kernel (like "GetTaskState"), 
-// because a Context Switch can't happen, because of the disabled Timer Interrupt.
-// But we can't call functions that are causing Page Fault, because of the disabled interrupts
-// we can't handle Page Faults.
+// Enables the SYSCALL/SYSRET instructions on the current processor.
+// SYSCALL loads the Kernel Code Segment and the Kernel Data Segment (the selector + 8) from the bits 32 - 47 of IA32_STAR.
+// SYSRET loads the User Mode Data Segment (the selector + 8) and the User Mode Code Segment (the selector + 16) from
+// the bits 48 - 63. The INT 0x80 entry stays available for compatibility.
+void InitFastSysCalls()
+{
+    unsigned long star = ((unsigned long)(GDT_KERNEL_DATA_SEGMENT | RPL_RING3) << 48) | ((unsigned long)GDT_KERNEL_CODE_SEGMENT << 32);
+
+    wrmsr(IA32_STAR, star);
+    wrmsr(IA32_LSTAR, (unsigned long)FastSysCallHandlerAsm);
+    wrmsr(IA32_FMASK, SYSCALL_RFLAGS_MASK);
+    wrmsr(IA32_EFER, rdmsr(IA32_EFER) | EFER_SCE);
+}
+
+// The dispatch table of the SysCalls, indexed by the SysCall number
+#define SYSCALL_DESCRIPTOR(Number, Name, Handler, ArgumentTypes, Flags) \
+    [Number] = { Handler, #Name, ArgumentTypes, sizeof(ArgumentTypes) - 1, Flags },
+
+static SysCallDescriptor sysCallTable[] =
+{
+    SYSCALL_TABLE(SYSCALL_DESCRIPTOR)
+};
+
+// The number of entries in the dispatch table (the highest SysCall number + 1)
+#define SYSCALL_COUNT (sizeof(sysCallTable) / sizeof(SysCallDescriptor))
+
+// Implements the SysCall Handler.
+// The SysCall parameters are stored on the Kernel Mode Stack of the current Task (performed in the Assembler code),
+// therefore the SysCalls are re-entrant across the processors and across a Context Switch.
+// The Assembler code enters the function with disabled interrupts. The SysCalls that are running without the
+// Kernel Lock are enabling them, so that a slow SysCall (like reading a file) can be preempted.
 unsigned long SysCallHandlerC(SysCallRegisters *Registers)
 {
-    // The SysCall Number is stored in the register RDI
-    int sysCallNumber = Registers->RDI;
+    Task *task = (Task *)GetTaskState();
+    SysCallDescriptor *descriptor = GetSysCallDescriptor(Registers->RDI);
+    unsigned long result;
+    unsigned long start;
 
-    // printf
-    if (sysCallNumber == SYSCALL_PRINTF)
-    {
-        printf((char *)Registers->RSI);
+    // An unknown SysCall number returns 0 to the caller
+    if (descriptor == 0x0)
+        return 0;
 
-        return 1;
-    }
-    // GetPID
-    else if (sysCallNumber == SYSCALL_GETPID)
+    // The time until now was spent in User Mode
+    AccountCpuTime(task, 0);
+
+    // Execute the requested SysCall
+    start = rdtsc();
+    result = DispatchSysCall(descriptor, Registers);
+
+    // The time of the SysCall was spent in Kernel Mode
+    AccountCpuTime(task, 1);
+
+    // Record the SysCall in the statistics, and in the trace ring of a traced Task
+    RecordSysCall(task, Registers, result, rdtsc() - start);
+
+    return result;
+}
+
+// Executes the handler of the given SysCall (called by the SysCall Handler and by the I/O Ring Worker Task).
+// The SysCalls that are flagged with SYSCALL_FLAG_BLOCKING are running preemptible with enabled interrupts.
+// All other SysCalls are short, and they are still serialized across the processors through the Kernel Lock
+// with disabled interrupts.
+unsigned long DispatchSysCall(SysCallDescriptor *Descriptor, SysCallRegisters *Registers)
+{
+    unsigned long result;
+    unsigned long flags;
+
+    if (Descriptor->Flags & SYSCALL_FLAG_BLOCKING)
     {
-        Task *state = (Task *)GetTaskState();
-        return state->PID;
+        // The User Mode buffers of the SysCall are accessed through the copy routines, which are handling Page
+        // Faults and invalid pointers. The previous interrupt state is restored before we return into User Mode.
+        flags = SaveFlagsAndDisableInterrupts();
+        EnableInterrupts();
+        result = Descriptor->Handler(Registers);
+        RestoreFlags(flags);
     }
-    // TerminateProcess
-    else if (sysCallNumber == SYSCALL_TERMINATE_PROCESS)
+    else
     {
-        Task *state = (Task *)GetTaskState();
-        TerminateTask(state->PID);
-
-        return 1;
+        flags = AcquireKernelLock();
+        result = Descriptor->Handler(Registers);
+        ReleaseKernelLock(flags);
     }
-    // getchar
-    else if (sysCallNumber == SYSCALL_GETCHAR)
-    {
-        char returnValue;
 
-        // Get a pointer to the keyboard buffer
-        char *keyboardBuffer = (char *)KEYBOARD_BUFFER;
-        
-        // Copy the entered character into the variable that is returned
-        memcpy(&returnValue, keyboardBuffer, 1);
+    return result;
+}
+
+// Returns the descriptor of the given SysCall number, or 0x0 for an unknown SysCall.
+// The SysCall number is checked against the bounds of the table, because it's provided by User Mode.
+SysCallDescriptor *GetSysCallDescriptor(unsigned long SysCallNumber)
+{
+    if ((SysCallNumber >= SYSCALL_COUNT) || (sysCallTable[SysCallNumber].Handler == 0x0))
+        return 0x0;
 
-        // Clear the keyboard buffer
-        keyboardBuffer[0] = 0;
+    return &sysCallTable[SysCallNumber];
+}
 
-        // Return the entered character
-        return returnValue;
-    }
-    // GetCursor
-    else if (sysCallNumber == SYSCALL_GETCURSOR)
+// Copies a null-terminated string from User Mode into the given Kernel Mode buffer.
+// It returns 0, when the string isn't accessible or doesn't fit into the buffer.
+static int CopyStringFromUser(char *Destination, unsigned long Source, long Size)
+{
+    long length = strncpy_from_user(Destination, (char *)Source, Size);
+
+    return (length >= 0) && (length < Size);
+}
+
+// Copies the buffer descriptions of a vectored SysCall from User Mode, and allocates a Kernel Mode buffer for each of them.
+// The returned array and the Kernel Mode buffers are allocated together, and they are released with a single "free".
+// It returns 0x0, when the descriptions aren't accessible, or when a buffer is longer than a physical disk sector.
+static IoVector *CopyIoVectorsFromUser(IoVector *UserVectors, unsigned long Source, int Count)
+{
+    unsigned char *buffers;
+    IoVector *vectors;
+    int i;
+
+    if ((Count <= 0) || (Count > IO_VECTOR_MAX))
+        return 0x0;
+
+    if (copy_from_user(UserVectors, (void *)Source, Count * sizeof(IoVector)) != 0)
+        return 0x0;
+
+    for (i = 0; i < Count; i++)
     {
-        int *Row = (int *)Registers->RSI;
-        int *Col = (int *)Registers->RDX;
-        GetCursorPosition(Row, Col);
+        if (UserVectors[i].Length > BYTES_PER_SECTOR)
+            return 0x0;
+    }
 
-        return 1;
+    // Every Kernel Mode buffer has an additional byte for a null terminator
+    vectors = (IoVector *)malloc(Count * (sizeof(IoVector) + BYTES_PER_SECTOR + 1));
+    buffers = (unsigned char *)(vectors + Count);
+
+    for (i = 0; i < Count; i++)
+    {
+        vectors[i].Buffer = buffers + i * (BYTES_PER_SECTOR + 1);
+        vectors[i].Length = UserVectors[i].Length;
     }
-    // SetCursor
-    else if (sysCallNumber == SYSCALL_SETCURSOR)
+
+    return vectors;
+}
+
+// Returns 1 if the given handle is a pipe handle, that doesn't belong to the process of the current Task.
+// The SysCalls are rejecting such a handle, so that a process can't guess and use the pipes of other processes.
+static int IsForeignPipeHandle(unsigned long Handle)
+{
+    Task *task = (Task *)GetTaskState();
+
+    return IsPipeHandle(Handle) && !IsPipeHandleOwned(task->ThreadGroup, Handle);
+}
+
+// Prints out a null-terminated string onto the standard output of the current process.
+// The string is written into a pipe, when the standard output of the process was redirected.
+static unsigned long SysCallPrintf(SysCallRegisters *Registers)
+{
+    char buffer[SYSCALL_PRINTF_CHUNK_SIZE + 1];
+    char *string = (char *)Registers->RSI;
+    Task *task = (Task *)GetTaskState();
+    unsigned long output = task->ThreadGroup != 0x0 ? task->ThreadGroup->StandardOutput : 0;
+    unsigned long flags;
+    IoVector vector;
+    long length;
+
+    // A long string is copied and printed out in chunks
+    do
     {
-        int *row = (int *)Registers->RSI;
-        int *col = (int *)Registers->RDX;
-        SetCursorPosition(*row, *col);
+        length = strncpy_from_user(buffer, string, SYSCALL_PRINTF_CHUNK_SIZE);
 
-        return 1;
-    }
-    // ExecuteUserProcess
-    else if (sysCallNumber == SYSCALL_EXECUTE)
-    {
-        // We can't start directly here in the SysCall handler the requested User Mode program, because interrupts are
-        // currently disabled, and therefore we can't load the new program into memory.
-        // Loading the program into memory would generate Page Faults that we can't handle, because of the disabled interrupts.
-        // 
-        // Therefore, we store the User Mode program that we want to start, at the memory location "USERMODE_PROGRAMM_TO_EXECUTE".
-        // The Kernel Mode Task "StartUserModeTask()" continuously checks this memory location if there is a new User Mode program
-        // to be started.
-        // If yes, the program is started, and the memory location is finally cleared.
-
-        // Find the Root Directory Entry for the given program name
-        RootDirectoryEntry *entry = FindRootDirectoryEntry((char *)Registers->RSI);
-
-        if (entry != 0)
+        if (length < 0)
+            return 0;
+
+        if (IsPipeHandle(output))
         {
-            // The given program name was found, so we copy the program name to the memory locattion "USERMODE_PROGRAMM_TO_EXECUTE"
-            char *fileName = (char *)USERMODE_PROGRAMM_TO_EXECUTE;
-            strcpy(fileName, (char *)Registers->RSI);
-            return 1;
+            // The writer blocks while the pipe is full, and fails when the pipe has no readers anymore
+            vector.Buffer = (unsigned char *)buffer;
+            vector.Length = length;
+
+            if ((length > 0) && (WritePipe(output, &vector, 1) == 0))
+                return 0;
         }
         else
-            return 0;
-    }
-    // PrintRootDirectory
-    else if (sysCallNumber == SYSCALL_PRINTROOTDIRECTORY)
+        {
+            buffer[length] = 0;
+            flags = AcquireKernelLock();
+            printf(buffer);
+            ReleaseKernelLock(flags);
+        }
+
+        string += length;
+    } while (length == SYSCALL_PRINTF_CHUNK_SIZE);
+
+    return 1;
+}
+
+// Returns the PID of the current Task
+static unsigned long SysCallGetPid(SysCallRegisters *Registers)
+{
+    Task *state = (Task *)GetTaskState();
+    return state->PID;
+}
+
+// Terminates the current Task
+static unsigned long SysCallTerminateProcess(SysCallRegisters *Registers)
+{
+    // The current Task gives up the CPU, and never returns from this SysCall
+    TerminateTask();
+
+    return 1;
+}
+
+// Returns the entered character from the keyboard buffer, or the next character from the standard input of the
+// current process, when it was redirected to a pipe. It returns -1 at the end of a redirected standard input.
+static unsigned long SysCallGetChar(SysCallRegisters *Registers)
+{
+    Task *task = (Task *)GetTaskState();
+    unsigned long input = task->ThreadGroup != 0x0 ? task->ThreadGroup->StandardInput : 0;
+    unsigned long flags;
+    IoVector vector;
+    char returnValue;
+
+    if (IsPipeHandle(input))
     {
-        PrintRootDirectory();
-        
-        return 1;
+        // The reader blocks until a character is available
+        vector.Buffer = (unsigned char *)&returnValue;
+        vector.Length = 1;
+
+        if (ReadPipe(input, &vector, 1) == 0)
+            return -1;
+
+        return returnValue;
     }
-    // ClearScreen
-    else if (sysCallNumber == SYSCALL_CLEARSCREEN)
+
+    flags = AcquireKernelLock();
+
+    // Get a pointer to the keyboard buffer
+    char *keyboardBuffer = (char *)KEYBOARD_BUFFER;
+    
+    // Copy the entered character into the variable that is returned
+    memcpy(&returnValue, keyboardBuffer, 1);
+
+    // Clear the keyboard buffer
+    keyboardBuffer[0] = 0;
+    ReleaseKernelLock(flags);
+
+    // Return the entered character
+    return returnValue;
+}
+
+// Returns the current cursor position
+static unsigned long SysCallGetCursor(SysCallRegisters *Registers)
+{
+    int row;
+    int col;
+    GetCursorPosition(&row, &col);
+
+    if ((copy_to_user((void *)Registers->RSI, &row, sizeof(int)) != 0) || (copy_to_user((void *)Registers->RDX, &col, sizeof(int)) != 0))
+        return 0;
+
+    return 1;
+}
+
+// Sets the current cursor position
+static unsigned long SysCallSetCursor(SysCallRegisters *Registers)
+{
+    int row;
+    int col;
+
+    if ((copy_from_user(&row, (void *)Registers->RSI, sizeof(int)) != 0) || (copy_from_user(&col, (void *)Registers->RDX, sizeof(int)) != 0))
+        return 0;
+
+    SetCursorPosition(row, col);
+
+    return 1;
+}
+
+// Starts a User Mode program, and returns its PID
+static unsigned long SysCallExecute(SysCallRegisters *Registers)
+{
+    // The requested User Mode program is started by the Kernel Mode Task "SpawnWorkerTask()", which builds the
+    // address space of the new process, and the current Task waits until the program is started.
+    // The SysCall returns the PID of the new Task, or 0 if it wasn't started.
+    //
+    // The program can get the read end of a pipe as its standard input, and the write end of a pipe as its standard
+    // output. The program gets its own references to these pipe ends, so the caller can close its handles afterwards.
+    char fileName[SYSCALL_FILENAME_LENGTH];
+    unsigned long input = IsPipeHandle(Registers->RDX) ? Registers->RDX : 0;
+    unsigned long output = IsPipeHandle(Registers->RCX) ? Registers->RCX : 0;
+    unsigned long pid = 0;
+
+    if (!CopyStringFromUser(fileName, Registers->RSI, sizeof(fileName)))
+        return 0;
+
+    // A process can only pass its own pipe handles to the new program
+    if (IsForeignPipeHandle(input) || IsForeignPipeHandle(output))
+        return 0;
+
+    // Check if the given program name exists in the Root Directory
+    if (!FileExists(fileName))
+        return 0;
+
+    if ((input != 0) && !DuplicatePipeHandle(input))
+        return 0;
+
+    if ((output != 0) && !DuplicatePipeHandle(output))
     {
-        ClearScreen();
+        if (input != 0)
+            ClosePipeHandle(input);
 
-        return 1;
+        return 0;
     }
-    // DeleteFile
-    else if (sysCallNumber == SYSCALL_DELETEFILE)
+
+    pid = SpawnUserModeProgram(fileName, input, output);
+
+    // The references of a program, that wasn't started, are released again
+    if (pid == 0)
     {
-        unsigned char *fileName = (unsigned char *)Registers->RSI;
-        unsigned char *extension = (unsigned char *)Registers->RDX;
+        if (input != 0)
+            ClosePipeHandle(input);
 
-        return DeleteFile(fileName, extension);
+        if (output != 0)
+            ClosePipeHandle(output);
     }
-    // OpenFile
-    else if(sysCallNumber == SYSCALL_OPENFILE)
+
+    return pid;
+}
+
+// Prints out the root directory of the FAT12 partition
+static unsigned long SysCallPrintRootDirectory(SysCallRegisters *Registers)
+{
+    PrintRootDirectory();
+    
+    return 1;
+}
+
+// Clears the screen
+static unsigned long SysCallClearScreen(SysCallRegisters *Registers)
+{
+    ClearScreen();
+
+    return 1;
+}
+
+// Opens a file in the FAT12 file system
+static unsigned long SysCallOpenFile(SysCallRegisters *Registers)
+{
+    char fileName[SYSCALL_FILENAME_LENGTH];
+    char extension[SYSCALL_FILENAME_LENGTH];
+    char fileMode[SYSCALL_FILENAME_LENGTH];
+
+    if (!CopyStringFromUser(fileName, Registers->RSI, sizeof(fileName)) ||
+        !CopyStringFromUser(extension, Registers->RDX, sizeof(extension)) ||
+        !CopyStringFromUser(fileMode, Registers->RCX, sizeof(fileMode)))
+        return 0;
+
+    return OpenFile(fileName, extension, fileMode);
+}
+
+// Reads from a file into a User Mode buffer
+static unsigned long SysCallReadFile(SysCallRegisters *Registers)
+{
+    unsigned long fileHandle = (unsigned long)Registers->RSI;
+    unsigned long length = (int)Registers->RCX;
+    unsigned char buffer[BYTES_PER_SECTOR];
+    unsigned long result;
+
+    // The requested data can't be longer than a physical disk sector
+    if ((length > BYTES_PER_SECTOR) || IsForeignPipeHandle(fileHandle))
+        return 0;
+
+    // The data is read into a Kernel Mode buffer, and the whole requested length is copied (it's zero-initialized)
+    if (IsPipeHandle(fileHandle))
     {
-        unsigned char *fileName = (unsigned char *)Registers->RSI;
-        unsigned char *extension = (unsigned char *)Registers->RDX;
-        char *fileMode = (unsigned char *)Registers->RCX;
+        IoVector vector = { buffer, length };
 
-        return OpenFile(fileName, extension, fileMode);
+        memset(buffer, 0x0, length);
+        result = ReadPipe(fileHandle, &vector, 1);
     }
-    // CloseFile
-    else if(sysCallNumber == SYSCALL_CLOSEFILE)
+    else
+        result = ReadFile(fileHandle, buffer, length);
+
+    if (copy_to_user((void *)Registers->RDX, buffer, length) != 0)
+        return 0;
+
+    return result;
+}
+
+// Writes a User Mode buffer into a file
+static unsigned long SysCallWriteFile(SysCallRegisters *Registers)
+{
+    unsigned long fileHandle = (unsigned long)Registers->RSI;
+    unsigned long length = (int)Registers->RCX;
+    unsigned char buffer[BYTES_PER_SECTOR];
+
+    // The data can't be longer than a physical disk sector
+    if ((length > BYTES_PER_SECTOR) || IsForeignPipeHandle(fileHandle) || (copy_from_user(buffer, (void *)Registers->RDX, length) != 0))
+        return 0;
+
+    if (IsPipeHandle(fileHandle))
     {
-        unsigned long fileHandle = (unsigned long)Registers->RSI;
+        IoVector vector = { buffer, length };
+
+        return WritePipe(fileHandle, &vector, 1);
+    }
+
+    return WriteFile(fileHandle, buffer, length);
+}
+
+// Creates an anonymous pipe, and returns the handles of its read end and its write end
+static unsigned long SysCallPipe(SysCallRegisters *Registers)
+{
+    Task *task = (Task *)GetTaskState();
+    unsigned long handles[2];
 
-        return CloseFile(fileHandle);
+    if (!CreatePipe(task->ThreadGroup, &handles[0], &handles[1]))
+        return 0;
+
+    if (copy_to_user((void *)Registers->RSI, handles, sizeof(handles)) != 0)
+    {
+        CloseOwnedPipeHandle(task->ThreadGroup, handles[0]);
+        CloseOwnedPipeHandle(task->ThreadGroup, handles[1]);
+        return 0;
     }
-    // ReadFile
-    else if(sysCallNumber == SYSCALL_READFILE)
+
+    return 1;
+}
+
+// Opens (or creates) a named Shared Memory Segment, and returns its handle
+static unsigned long SysCallShmOpen(SysCallRegisters *Registers)
+{
+    Task *task = (Task *)GetTaskState();
+    char name[SHARED_MEMORY_NAME_LENGTH];
+
+    if (!CopyStringFromUser(name, Registers->RSI, sizeof(name)))
+        return 0;
+
+    return OpenSharedMemory(task->ThreadGroup, name, Registers->RDX);
+}
+
+// Maps a Shared Memory Segment into the address space of the current process, and returns its address
+static unsigned long SysCallShmMap(SysCallRegisters *Registers)
+{
+    Task *task = (Task *)GetTaskState();
+
+    return MapSharedMemory(task->ThreadGroup, (int)Registers->RSI);
+}
+
+// Unmaps a Shared Memory Segment from the address space of the current process, and closes its handle
+static unsigned long SysCallShmUnmap(SysCallRegisters *Registers)
+{
+    Task *task = (Task *)GetTaskState();
+
+    return UnmapSharedMemory(task->ThreadGroup, (int)Registers->RSI);
+}
+
+// Reads a file (or the console) into several User Mode buffers
+static unsigned long SysCallReadFileVector(SysCallRegisters *Registers)
+{
+    unsigned long fileHandle = (unsigned long)Registers->RSI;
+    int count = (int)Registers->RCX;
+    IoVector userVectors[IO_VECTOR_MAX];
+    IoVector *vectors;
+    unsigned long result = 0;
+    unsigned long flags;
+    int i;
+
+    // A process can only use its own pipe handles
+    if (IsForeignPipeHandle(fileHandle))
+        return 0;
+
+    vectors = CopyIoVectorsFromUser(userVectors, Registers->RDX, count);
+
+    if (vectors == 0x0)
+        return 0;
+
+    if (fileHandle == FILE_HANDLE_CONSOLE)
     {
-        unsigned long fileHandle = (unsigned long)Registers->RSI;
-        unsigned char *buffer = (unsigned char *)Registers->RDX;
-        int length = (int)Registers->RCX;
+        char *keyboardBuffer = (char *)KEYBOARD_BUFFER;
+
+        // The entered character is returned in the first non-empty buffer, like the SysCall "SYSCALL_GETCHAR"
+        flags = AcquireKernelLock();
+
+        for (i = 0; i < count; i++)
+        {
+            if (vectors[i].Length > 0)
+            {
+                memset(vectors[i].Buffer, 0x0, vectors[i].Length);
 
-        return ReadFile(fileHandle, buffer, length);
+                if (keyboardBuffer[0] != 0)
+                {
+                    vectors[i].Buffer[0] = keyboardBuffer[0];
+                    keyboardBuffer[0] = 0;
+                    result = 1;
+                }
+
+                break;
+            }
+        }
+
+        ReleaseKernelLock(flags);
     }
-    // WriteFile
-    else if (sysCallNumber == SYSCALL_WRITEFILE)
+    else if (IsPipeHandle(fileHandle))
     {
-        unsigned long fileHandle = (unsigned long)Registers->RSI;
-        unsigned char *buffer = (unsigned char *)Registers->RDX;
-        unsigned long length = (int)Registers->RCX;
+        for (i = 0; i < count; i++)
+            memset(vectors[i].Buffer, 0x0, vectors[i].Length);
 
-        return WriteFile(fileHandle, buffer, length);;
+        result = ReadPipe(fileHandle, vectors, count);
     }
-    // EndOfFile
-    else if(sysCallNumber == SYSCALL_ENDOFFILE)
+    else
+        result = ReadFileVector(fileHandle, vectors, count);
+
+    // The whole requested length of every buffer is copied (they are zero-initialized)
+    for (i = 0; i < count; i++)
     {
-        unsigned long fileHandle = (unsigned long)Registers->RSI;
+        if (copy_to_user(userVectors[i].Buffer, vectors[i].Buffer, vectors[i].Length) != 0)
+        {
+            result = 0;
+            break;
+        }
+    }
+
+    free(vectors);
+    return result;
+}
 
-        return EndOfFile(fileHandle);
+// Writes several User Mode buffers into a file (or onto the console)
+static unsigned long SysCallWriteFileVector(SysCallRegisters *Registers)
+{
+    unsigned long fileHandle = (unsigned long)Registers->RSI;
+    int count = (int)Registers->RCX;
+    IoVector userVectors[IO_VECTOR_MAX];
+    IoVector *vectors;
+    unsigned long result = 0;
+    unsigned long flags;
+    int i;
+
+    // A process can only use its own pipe handles
+    if (IsForeignPipeHandle(fileHandle))
+        return 0;
+
+    vectors = CopyIoVectorsFromUser(userVectors, Registers->RDX, count);
+
+    if (vectors == 0x0)
+        return 0;
+
+    for (i = 0; i < count; i++)
+    {
+        if (copy_from_user(vectors[i].Buffer, userVectors[i].Buffer, vectors[i].Length) != 0)
+        {
+            free(vectors);
+            return 0;
+        }
     }
-    // SeekFile
-    else if (sysCallNumber == SYSCALL_SEEKFILE)
+
+    if (fileHandle == FILE_HANDLE_CONSOLE)
     {
-        unsigned long fileHandle = (unsigned long)Registers->RSI;
-        unsigned long fileOffset = (unsigned long)Registers->RDX;
+        // All buffers are printed out under the Kernel Lock, so that the output of other Tasks can't interleave them.
+        // Every buffer has an additional byte for the null terminator, and a buffer is printed up to its first null
+        // character, so only the printed characters are counted.
+        flags = AcquireKernelLock();
 
-        return SeekFile(fileHandle, fileOffset);
+        for (i = 0; i < count; i++)
+        {
+            vectors[i].Buffer[vectors[i].Length] = 0;
+            printf((char *)vectors[i].Buffer);
+            result += strlen((char *)vectors[i].Buffer);
+        }
+
+        ReleaseKernelLock(flags);
     }
+    else if (IsPipeHandle(fileHandle))
+        result = WritePipe(fileHandle, vectors, count);
+    else
+        result = WriteFileVector(fileHandle, vectors, count);
+
+    free(vectors);
+    return result;
+}
+
+// Seeks to a position in a file
+static unsigned long SysCallSeekFile(SysCallRegisters *Registers)
+{
+    unsigned long fileHandle = (unsigned long)Registers->RSI;
+    unsigned long fileOffset = (unsigned long)Registers->RDX;
+
+    return SeekFile(fileHandle, fileOffset);
+}
+
+// Returns if the end of a file was reached
+static unsigned long SysCallEndOfFile(SysCallRegisters *Registers)
+{
+    unsigned long fileHandle = (unsigned long)Registers->RSI;
+
+    return EndOfFile(fileHandle);
+}
+
+// Closes a file
+static unsigned long SysCallCloseFile(SysCallRegisters *Registers)
+{
+    unsigned long fileHandle = (unsigned long)Registers->RSI;
+    Task *task = (Task *)GetTaskState();
+
+    // A process can only close its own pipe handles
+    if (IsPipeHandle(fileHandle))
+        return CloseOwnedPipeHandle(task->ThreadGroup, fileHandle);
+
+    return CloseFile(fileHandle);
+}
+
+// Deletes a file in the FAT12 file system
+static unsigned long SysCallDeleteFile(SysCallRegisters *Registers)
+{
+    char fileName[SYSCALL_FILENAME_LENGTH];
+    char extension[SYSCALL_FILENAME_LENGTH];
+
+    if (!CopyStringFromUser(fileName, Registers->RSI, sizeof(fileName)) ||
+        !CopyStringFromUser(extension, Registers->RDX, sizeof(extension)))
+        return 0;
+
+    return DeleteFile(fileName, extension);
+}
+
+// Blocks the current Task for the given number of milliseconds
+static unsigned long SysCallSleep(SysCallRegisters *Registers)
+{
+    unsigned long milliseconds = (unsigned long)Registers->RSI;
+
+    // The current Task gives up the CPU, and the SysCall returns after the Task was woken up again
+    SleepTask(GetTaskState(), milliseconds * NANOSECONDS_PER_MILLISECOND);
+
+    return 1;
+}
+
+// Blocks the current Task for the given number of nanoseconds
+static unsigned long SysCallNanoSleep(SysCallRegisters *Registers)
+{
+    unsigned long nanoseconds = (unsigned long)Registers->RSI;
+
+    // The current Task gives up the CPU, and the SysCall returns after the Task was woken up again
+    SleepTask(GetTaskState(), nanoseconds);
+
+    return 1;
+}
+
+// Returns a snapshot of the statistics of all Tasks
+static unsigned long SysCallGetTaskStatistics(SysCallRegisters *Registers)
+{
+    int maxEntries = (int)Registers->RDX;
+    TaskStatistics *buffer;
+    int count;
+
+    if (maxEntries > STATISTICS_MAX_ENTRIES)
+        maxEntries = STATISTICS_MAX_ENTRIES;
+
+    if (maxEntries <= 0)
+        return 0;
+
+    // The snapshot is taken into a Kernel Mode buffer, because it's taken with disabled interrupts and held locks
+    buffer = (TaskStatistics *)malloc(maxEntries * sizeof(TaskStatistics));
+
+    if (buffer == 0x0)
+        return 0;
+
+    count = GetTaskStatistics(buffer, maxEntries);
+
+    if (copy_to_user((void *)Registers->RSI, buffer, count * sizeof(TaskStatistics)) != 0)
+        count = 0;
+
+    free(buffer);
+    return count;
+}
+
+// Returns a snapshot of the statistics of all registered locks
+static unsigned long SysCallGetLockStatistics(SysCallRegisters *Registers)
+{
+    int maxEntries = (int)Registers->RDX;
+    LockStatisticsSnapshot *buffer;
+    int count;
+
+    if (maxEntries > STATISTICS_MAX_ENTRIES)
+        maxEntries = STATISTICS_MAX_ENTRIES;
+
+    if (maxEntries <= 0)
+        return 0;
+
+    buffer = (LockStatisticsSnapshot *)malloc(maxEntries * sizeof(LockStatisticsSnapshot));
+
+    if (buffer == 0x0)
+        return 0;
+
+    count = GetLockStatistics(buffer, maxEntries);
+
+    if (copy_to_user((void *)Registers->RSI, buffer, count * sizeof(LockStatisticsSnapshot)) != 0)
+        count = 0;
+
+    free(buffer);
+    return count;
+}
+
+// Gives up the CPU
+static unsigned long SysCallYield(SysCallRegisters *Registers)
+{
+    // The current Task stays runnable, and continues after the other runnable Tasks of its processor
+    YieldTask();
+
+    return 1;
+}
+
+// Changes the scheduling class of the current Task
+static unsigned long SysCallSetRealTime(SysCallRegisters *Registers)
+{
+    // A negative priority moves the current Task back into the normal scheduling class
+    int priority = (int)Registers->RSI;
+    unsigned long runtime = Registers->RDX;
+    unsigned long period = Registers->RCX;
+
+    // The highest priorities are reserved for the input and the deferred interrupt work of the Kernel
+    if (priority > RT_MAX_USER_PRIORITY)
+        return 0;
+
+    return SetRealTimeScheduling(GetTaskState(), priority, runtime, period);
+}
+
+// Returns a scheduling latency histogram
+static unsigned long SysCallGetLatencyHistogram(SysCallRegisters *Registers)
+{
+    unsigned long pid = Registers->RSI;
+    int kind = (int)Registers->RDX;
+    LatencyHistogram histogram;
+
+    if (!GetLatencyHistogram(pid, kind, &histogram))
+        return 0;
+
+    return copy_to_user((void *)Registers->RCX, &histogram, sizeof(LatencyHistogram)) == 0;
+}
+
+// Creates a new thread in the current process
+static unsigned long SysCallThreadCreate(SysCallRegisters *Registers)
+{
+    unsigned long entryPoint = Registers->RSI;
+    unsigned long argument = Registers->RDX;
+    unsigned long threadPointer = Registers->RCX;
+
+    return CreateUserModeThread(GetTaskState(), entryPoint, argument, threadPointer);
+}
+
+// Terminates the current thread with an exit code
+static unsigned long SysCallThreadExit(SysCallRegisters *Registers)
+{
+    Task *task = GetTaskState();
+
+    // The current thread gives up the CPU, and never returns from this SysCall
+    task->ExitCode = (long)Registers->RSI;
+    TerminateTask();
+
+    return 1;
+}
+
+// Waits until a thread has exited, and returns its exit code
+static unsigned long SysCallThreadJoin(SysCallRegisters *Registers)
+{
+    unsigned long tid = Registers->RSI;
+    long exitCode;
+
+    // The current thread blocks until the joined thread has exited
+    if (!JoinThread(GetTaskState(), tid, &exitCode))
+        return 0;
+
+    // The thread slot is already released, so the exit code is lost when the buffer isn't accessible
+    return copy_to_user((void *)Registers->RDX, &exitCode, sizeof(long)) == 0;
+}
+
+// Sets the FS base of the current thread
+static unsigned long SysCallSetThreadPointer(SysCallRegisters *Registers)
+{
+    Task *task = GetTaskState();
+    Cpu *cpu = GetCurrentCpu();
+
+    // A non-canonical FS base would raise a General Protection Fault in Kernel Mode
+    if (Registers->RSI >= USERMODE_ADDRESS_LIMIT)
+        return 0;
+
+    // The new FS base is loaded immediately, and by every following Context Switch to the current Task
+    task->FsBase = Registers->RSI;
+    wrmsr(IA32_FS_BASE, task->FsBase);
+    cpu->FsBase = task->FsBase;
+
+    return 1;
+}
+
+// Blocks the current Task on a futex
+static unsigned long SysCallFutexWait(SysCallRegisters *Registers)
+{
+    unsigned int *address = (unsigned int *)Registers->RSI;
+    unsigned int expectedValue = (unsigned int)Registers->RDX;
+
+    // The current Task blocks until the futex is woken up, when the futex word still has the expected value
+    return FutexWait(address, expectedValue);
+}
+
+// Wakes up the Tasks that are waiting on a futex
+static unsigned long SysCallFutexWake(SysCallRegisters *Registers)
+{
+    unsigned int *address = (unsigned int *)Registers->RSI;
+    int count = (int)Registers->RDX;
+
+    return FutexWake(address, count);
+}
+
+// Returns the User Mode address of the I/O Ring of the current process (it's created with the first call)
+static unsigned long SysCallIoRingSetup(SysCallRegisters *Registers)
+{
+    return SetupIoRing(GetTaskState());
+}
+
+// Submits operations from the I/O Ring of the current process, and waits for their completions
+static unsigned long SysCallIoRingEnter(SysCallRegisters *Registers)
+{
+    int toSubmit = (int)Registers->RSI;
+    int minComplete = (int)Registers->RDX;
+
+    // The current Task blocks until the requested number of completions is available
+    return EnterIoRing(GetTaskState(), toSubmit, minComplete);
+}
+
+// Returns a snapshot of the statistics of a SysCall number
+static unsigned long SysCallGetSysCallStats(SysCallRegisters *Registers)
+{
+    unsigned long number = Registers->RSI;
+    SysCallStatistics statistics;
+
+    if (!GetSysCallStatistics(number, &statistics))
+        return 0;
+
+    return copy_to_user((void *)Registers->RDX, &statistics, sizeof(SysCallStatistics)) == 0;
+}
+
+// Attaches a trace ring to the Task with the given PID
+static unsigned long SysCallTraceAttach(SysCallRegisters *Registers)
+{
+    return AttachSysCallTrace(GetTaskState(), Registers->RSI);
+}
+
+// Detaches the trace ring from the Task with the given PID
+static unsigned long SysCallTraceDetach(SysCallRegisters *Registers)
+{
+    DetachSysCallTrace(Registers->RSI);
+
+    return 1;
+}
+
+// Reads the next entries from the trace ring of the Task with the given PID
+static unsigned long SysCallTraceRead(SysCallRegisters *Registers)
+{
+    unsigned long pid = Registers->RSI;
+    int maxEntries = (int)Registers->RCX;
+    SysCallTraceEntry entries[SYSCALL_TRACE_READ_ENTRIES];
+    int count;
+
+    if (maxEntries > SYSCALL_TRACE_READ_ENTRIES)
+        maxEntries = SYSCALL_TRACE_READ_ENTRIES;
+
+    if (maxEntries <= 0)
+        return 0;
+
+    count = ReadSysCallTrace(pid, entries, maxEntries);
+
+    // The entries are already consumed, so they are lost when the buffer isn't accessible
+    if ((count > 0) && (copy_to_user((void *)Registers->RDX, entries, count * sizeof(SysCallTraceEntry)) != 0))
+        return 0;
 
-    return 0;
-}
\ No newline at end of file
+    return count;
+}
@@ -1,23 +1,36 @@
 #ifndef SYSCALL_H
 #define SYSCALL_H
 
-// Defines the various available SysCalls
-#define SYSCALL_PRINTF              1
-#define SYSCALL_GETPID              2
-#define SYSCALL_TERMINATE_PROCESS   3
-#define SYSCALL_GETCHAR             4
-#define SYSCALL_GETCURSOR           5
-#define SYSCALL_SETCURSOR           6
-#define SYSCALL_EXECUTE             7
-#define SYSCALL_PRINTROOTDIRECTORY  8
-#define SYSCALL_CLEARSCREEN         9
-#define SYSCALL_OPENFILE            10
-#define SYSCALL_READFILE            11
-#define SYSCALL_WRITEFILE           12
-#define SYSCALL_SEEKFILE            13
-#define SYSCALL_ENDOFFILE           14
-#define SYSCALL_CLOSEFILE           15
-#define SYSCALL_DELETEFILE          16
+#include "syscalltable.h"
+#include "../io/fat12.h"
+
+// The size of the chunks, in which the SysCall "SYSCALL_PRINTF" copies a string from User Mode
+#define SYSCALL_PRINTF_CHUNK_SIZE   256
+
+// The size of the Kernel Mode buffers for a file name, its extension, and a file mode
+#define SYSCALL_FILENAME_LENGTH     16
+
+// The file handle of the console in the SysCalls "SYSCALL_READFILEV" and "SYSCALL_WRITEFILEV".
+// The file handles of the FAT12 file system are 32 bit hash values, therefore they never collide with it.
+#define FILE_HANDLE_CONSOLE         0x8000000000000000
+
+// The maximum number of buffers in the SysCalls "SYSCALL_READFILEV" and "SYSCALL_WRITEFILEV"
+#define IO_VECTOR_MAX               16
+
+// The maximum number of entries in the SysCalls "SYSCALL_GETTASKSTATISTICS" and "SYSCALL_GETLOCKSTATISTICS"
+#define STATISTICS_MAX_ENTRIES      64
+
+// The Model Specific Registers of the SYSCALL/SYSRET instructions
+#define IA32_EFER                   0xC0000080
+#define IA32_STAR                   0xC0000081
+#define IA32_LSTAR                  0xC0000082
+#define IA32_FMASK                  0xC0000084
+
+// The "System Call Extensions" bit in the MSR IA32_EFER
+#define EFER_SCE                    0x1
+
+// The RFLAGS bits that are cleared by the SYSCALL instruction: the Interrupt Flag, the Trap Flag, and the Direction Flag
+#define SYSCALL_RFLAGS_MASK         0x700
 
 typedef struct SysCallRegisters
 {
@@ -28,12 +41,56 @@ typedef struct SysCallRegisters
     unsigned long RCX;
     unsigned long R8;
     unsigned long R9;
+
+    // The 6th parameter value (passed in RAX, because R10 already replaces RCX)
+    unsigned long RAX;
 } SysCallRegisters;
 
+// Implements a SysCall
+typedef unsigned long (*SysCallHandler)(SysCallRegisters *Registers);
+
+// Describes a SysCall in the dispatch table
+typedef struct SysCallDescriptor
+{
+    // The function that implements the SysCall
+    SysCallHandler Handler;
+
+    // The name of the SysCall, and the types of its arguments (see "syscalltable.h")
+    char *Name;
+    char *ArgumentTypes;
+    int ArgumentCount;
+
+    // The flags of the SysCall (SYSCALL_FLAG_BLOCKING)
+    int Flags;
+} SysCallDescriptor;
+
+
+// Enables the SYSCALL/SYSRET instructions on the current processor
+void InitFastSysCalls();
+
 // Implements the SysCall Handler
 unsigned long SysCallHandlerC(SysCallRegisters *Registers);
 
+// Executes the handler of the given SysCall (called by the SysCall Handler and by the I/O Ring Worker Task)
+unsigned long DispatchSysCall(SysCallDescriptor *Descriptor, SysCallRegisters *Registers);
+
+// Returns the descriptor of the given SysCall number, or 0x0 for an unknown SysCall
+SysCallDescriptor *GetSysCallDescriptor(unsigned long SysCallNumber);
+
+// Copies a null-terminated string from User Mode into the given Kernel Mode buffer
+static int CopyStringFromUser(char *Destination, unsigned long Source, long Size);
+
+// Copies the buffer descriptions of a vectored SysCall from User Mode, and allocates a Kernel Mode buffer for each of them
+static IoVector *CopyIoVectorsFromUser(IoVector *UserVectors, unsigned long Source, int Count);
+
+// Declares the functions that are implementing the SysCalls
+#define SYSCALL_HANDLER(Number, Name, Handler, ArgumentTypes, Flags) static unsigned long Handler(SysCallRegisters *Registers);
+SYSCALL_TABLE(SYSCALL_HANDLER)
+
 // The SysCall Handler written in Assembler
 extern void SysCallHandlerAsm();
 
+// The SYSCALL entry point written in Assembler
+extern void FastSysCallHandlerAsm();
+
 #endif
\ No newline at end of file
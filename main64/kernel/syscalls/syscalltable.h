@@ -0,0 +1,76 @@
+#ifndef SYSCALLTABLE_H
+#define SYSCALLTABLE_H
+
+// ==========================================================================================================
+// The SysCall table, which is shared by the Kernel and the libc (the file "syscall.h" of the libc includes it).
+// Every entry defines the number, the name, the handler in the Kernel, the argument types, and the flags of
+// a SysCall. The table is expanded with a macro that receives these 5 values, so the SysCall numbers, the
+// dispatch table of the Kernel, and the tracing output are generated from the same list.
+//
+// The argument types are a string with one character per argument:
+// 'i': an integer value
+// 'p': a pointer to User Mode memory
+// 's': a null-terminated string in User Mode memory
+// ==========================================================================================================
+
+// The SysCall can give up the CPU (or it's protected by its own locks), therefore it runs without the Kernel Lock
+#define SYSCALL_FLAG_BLOCKING       0x1
+
+// The SysCall doesn't depend on the calling Task, therefore it can be submitted through an I/O Ring
+#define SYSCALL_FLAG_ASYNC          0x2
+
+// The maximum number of SysCall arguments
+#define SYSCALL_MAX_ARGUMENTS       6
+
+#define SYSCALL_TABLE(SYSCALL) \
+    SYSCALL(1,  PRINTF,              SysCallPrintf,              "s",    SYSCALL_FLAG_BLOCKING | SYSCALL_FLAG_ASYNC) \
+    SYSCALL(2,  GETPID,              SysCallGetPid,              "",     0) \
+    SYSCALL(3,  TERMINATE_PROCESS,   SysCallTerminateProcess,    "",     SYSCALL_FLAG_BLOCKING) \
+    SYSCALL(4,  GETCHAR,             SysCallGetChar,             "",     SYSCALL_FLAG_BLOCKING) \
+    SYSCALL(5,  GETCURSOR,           SysCallGetCursor,           "pp",   0) \
+    SYSCALL(6,  SETCURSOR,           SysCallSetCursor,           "pp",   0) \
+    SYSCALL(7,  EXECUTE,             SysCallExecute,             "sii",  SYSCALL_FLAG_BLOCKING) \
+    SYSCALL(8,  PRINTROOTDIRECTORY,  SysCallPrintRootDirectory,  "",     SYSCALL_FLAG_BLOCKING) \
+    SYSCALL(9,  CLEARSCREEN,         SysCallClearScreen,         "",     0) \
+    SYSCALL(10, OPENFILE,            SysCallOpenFile,            "sss",  SYSCALL_FLAG_BLOCKING) \
+    SYSCALL(11, READFILE,            SysCallReadFile,            "ipi",  SYSCALL_FLAG_BLOCKING | SYSCALL_FLAG_ASYNC) \
+    SYSCALL(12, WRITEFILE,           SysCallWriteFile,           "ipi",  SYSCALL_FLAG_BLOCKING | SYSCALL_FLAG_ASYNC) \
+    SYSCALL(13, SEEKFILE,            SysCallSeekFile,            "ii",   SYSCALL_FLAG_BLOCKING | SYSCALL_FLAG_ASYNC) \
+    SYSCALL(14, ENDOFFILE,           SysCallEndOfFile,           "i",    SYSCALL_FLAG_BLOCKING | SYSCALL_FLAG_ASYNC) \
+    SYSCALL(15, CLOSEFILE,           SysCallCloseFile,           "i",    SYSCALL_FLAG_BLOCKING | SYSCALL_FLAG_ASYNC) \
+    SYSCALL(16, DELETEFILE,          SysCallDeleteFile,          "ss",   SYSCALL_FLAG_BLOCKING) \
+    SYSCALL(17, SLEEP,               SysCallSleep,               "i",    SYSCALL_FLAG_BLOCKING) \
+    SYSCALL(18, NANOSLEEP,           SysCallNanoSleep,           "i",    SYSCALL_FLAG_BLOCKING) \
+    SYSCALL(19, GETTASKSTATISTICS,   SysCallGetTaskStatistics,   "pi",   0) \
+    SYSCALL(20, GETLOCKSTATISTICS,   SysCallGetLockStatistics,   "pi",   0) \
+    SYSCALL(21, YIELD,               SysCallYield,               "",     SYSCALL_FLAG_BLOCKING) \
+    SYSCALL(22, SETREALTIME,         SysCallSetRealTime,         "iii",  0) \
+    SYSCALL(23, GETLATENCYHISTOGRAM, SysCallGetLatencyHistogram, "iip",  0) \
+    SYSCALL(24, THREAD_CREATE,       SysCallThreadCreate,        "ppp",  0) \
+    SYSCALL(25, THREAD_EXIT,         SysCallThreadExit,          "i",    SYSCALL_FLAG_BLOCKING) \
+    SYSCALL(26, THREAD_JOIN,         SysCallThreadJoin,          "ip",   SYSCALL_FLAG_BLOCKING) \
+    SYSCALL(27, SETTHREADPOINTER,    SysCallSetThreadPointer,    "p",    0) \
+    SYSCALL(28, FUTEX_WAIT,          SysCallFutexWait,           "pi",   SYSCALL_FLAG_BLOCKING) \
+    SYSCALL(29, FUTEX_WAKE,          SysCallFutexWake,           "pi",   SYSCALL_FLAG_BLOCKING) \
+    SYSCALL(30, IORING_SETUP,        SysCallIoRingSetup,         "",     0) \
+    SYSCALL(31, IORING_ENTER,        SysCallIoRingEnter,         "ii",   SYSCALL_FLAG_BLOCKING) \
+    SYSCALL(32, GETSYSCALLSTATS,     SysCallGetSysCallStats,     "ip",   0) \
+    SYSCALL(33, TRACE_ATTACH,        SysCallTraceAttach,         "i",    0) \
+    SYSCALL(34, TRACE_DETACH,        SysCallTraceDetach,         "i",    0) \
+    SYSCALL(35, TRACE_READ,          SysCallTraceRead,           "ipi",  0) \
+    SYSCALL(36, READFILEV,           SysCallReadFileVector,      "ipi",  SYSCALL_FLAG_BLOCKING | SYSCALL_FLAG_ASYNC) \
+    SYSCALL(37, WRITEFILEV,          SysCallWriteFileVector,     "ipi",  SYSCALL_FLAG_BLOCKING | SYSCALL_FLAG_ASYNC) \
+    SYSCALL(38, PIPE,                SysCallPipe,                "p",    SYSCALL_FLAG_BLOCKING) \
+    SYSCALL(39, SHM_OPEN,            SysCallShmOpen,             "si",   SYSCALL_FLAG_BLOCKING) \
+    SYSCALL(40, SHM_MAP,             SysCallShmMap,              "i",    SYSCALL_FLAG_BLOCKING) \
+    SYSCALL(41, SHM_UNMAP,           SysCallShmUnmap,            "i",    SYSCALL_FLAG_BLOCKING)
+
+// Defines the various available SysCalls (SYSCALL_PRINTF, SYSCALL_GETPID, ...)
+#define SYSCALL_NUMBER(Number, Name, Handler, ArgumentTypes, Flags) SYSCALL_##Name = Number,
+
+enum
+{
+    SYSCALL_TABLE(SYSCALL_NUMBER)
+};
+
+#endif
@@ -0,0 +1,207 @@
+#include "systrace.h"
+#include "../multitasking/smp.h"
+#include "../multitasking/pid.h"
+#include "../drivers/timer.h"
+#include "../common.h"
+
+// The statistics of the SysCalls on each processor.
+// They are only updated with disabled interrupts by the processor that finishes a SysCall, therefore they don't
+// need any atomic operations.
+LatencyHistogram sysCallLatency[MAX_CPUS][SYSCALL_STATISTICS_ENTRIES];
+
+// The trace rings of the traced Tasks.
+// They are statically allocated, because their locks are registered on their first acquisition.
+SysCallTrace sysCallTraces[MAX_SYSCALL_TRACES] =
+{
+    [0 ... MAX_SYSCALL_TRACES - 1] = { .Lock = SPINLOCK_INITIALIZER("SysCallTrace") }
+};
+
+// Records a finished SysCall of the given Task, which took the given number of TSC ticks.
+// It's called by the SysCall Handler with disabled interrupts.
+void RecordSysCall(Task *Task, SysCallRegisters *Registers, unsigned long Result, unsigned long Ticks)
+{
+    SysCallTrace *trace = Task->SysCallTrace;
+    unsigned long duration = TscToNanoseconds(Ticks);
+    SysCallTraceEntry *entry;
+
+    if (Registers->RDI < SYSCALL_STATISTICS_ENTRIES)
+        RecordLatency(&sysCallLatency[GetCurrentCpu()->Index][Registers->RDI], duration);
+
+    if (trace == 0x0)
+        return;
+
+    AcquireSpinlock(&trace->Lock);
+
+    // The trace ring can be detached (and reused for another Task) in the meantime
+    if (trace->PID == Task->PID)
+    {
+        if (trace->Tail - trace->Head < SYSCALL_TRACE_ENTRIES)
+        {
+            entry = &trace->Entries[trace->Tail % SYSCALL_TRACE_ENTRIES];
+            entry->Number = Registers->RDI;
+            entry->Arguments[0] = Registers->RSI;
+            entry->Arguments[1] = Registers->RDX;
+            entry->Arguments[2] = Registers->RCX;
+            entry->Arguments[3] = Registers->R8;
+            entry->Arguments[4] = Registers->R9;
+            entry->Arguments[5] = Registers->RAX;
+            entry->Result = Result;
+            entry->Duration = duration;
+            trace->Tail++;
+        }
+        else
+            trace->Dropped++;
+    }
+
+    ReleaseSpinlock(&trace->Lock);
+}
+
+// Returns a snapshot of the statistics of the given SysCall number. It returns 0 for an unknown SysCall.
+// The histograms of the processors are read without a lock, so a snapshot can be slightly inconsistent.
+int GetSysCallStatistics(unsigned long Number, SysCallStatistics *Buffer)
+{
+    SysCallDescriptor *descriptor = GetSysCallDescriptor(Number);
+    int i;
+
+    if ((descriptor == 0x0) || (Number >= SYSCALL_STATISTICS_ENTRIES))
+        return 0;
+
+    memset(Buffer, 0, sizeof(SysCallStatistics));
+
+    for (i = 0; (i < SYSCALL_NAME_LENGTH - 1) && (descriptor->Name[i] != 0); i++)
+        Buffer->Name[i] = descriptor->Name[i];
+
+    for (i = 0; i < GetCpuCount(); i++)
+        MergeLatencyHistogram(&Buffer->Latency, &sysCallLatency[i][Number]);
+
+    return 1;
+}
+
+// Attaches a trace ring to the Task with the given PID.
+// It returns 0 if the Task doesn't exist, if it's already traced, or if no trace ring is available.
+// A Task can't trace itself, because every read of its trace would produce a new entry.
+int AttachSysCallTrace(Task *Tracer, unsigned long PID)
+{
+    SysCallTrace *trace = 0x0;
+    unsigned long flags;
+    int i;
+
+    if ((PID == 0) || (PID == Tracer->PID) || (FindSysCallTrace(PID) != 0x0))
+        return 0;
+
+    // Reserve a free trace ring
+    for (i = 0; (i < MAX_SYSCALL_TRACES) && (trace == 0x0); i++)
+    {
+        flags = AcquireSpinlockIrqSave(&sysCallTraces[i].Lock);
+
+        if (sysCallTraces[i].PID == 0)
+        {
+            trace = &sysCallTraces[i];
+            trace->PID = PID;
+            trace->Head = 0;
+            trace->Tail = 0;
+            trace->Dropped = 0;
+        }
+
+        ReleaseSpinlockIrqRestore(&sysCallTraces[i].Lock, flags);
+    }
+
+    if (trace == 0x0)
+        return 0;
+
+    if (!SetSysCallTrace(PID, trace))
+    {
+        flags = AcquireSpinlockIrqSave(&trace->Lock);
+        trace->PID = 0;
+        ReleaseSpinlockIrqRestore(&trace->Lock, flags);
+
+        return 0;
+    }
+
+    return 1;
+}
+
+// Detaches the trace ring from the Task with the given PID.
+// The Task can still finish a SysCall with the old trace ring, therefore the trace ring is only released through its PID.
+void DetachSysCallTrace(unsigned long PID)
+{
+    SysCallTrace *trace = FindSysCallTrace(PID);
+    unsigned long flags;
+
+    if (trace == 0x0)
+        return;
+
+    SetSysCallTrace(PID, 0x0);
+
+    flags = AcquireSpinlockIrqSave(&trace->Lock);
+
+    if (trace->PID == PID)
+        trace->PID = 0;
+
+    ReleaseSpinlockIrqRestore(&trace->Lock, flags);
+}
+
+// Reads the next entries from the trace ring of the Task with the given PID, and returns their number.
+// It returns -1 if the Task isn't traced, or when it has terminated and all of its entries were read.
+// The trace ring of a terminated Task is released with the last read.
+int ReadSysCallTrace(unsigned long PID, SysCallTraceEntry *Buffer, int MaxEntries)
+{
+    SysCallTrace *trace = FindSysCallTrace(PID);
+    unsigned long flags;
+    int count = 0;
+
+    if (trace == 0x0)
+        return -1;
+
+    flags = AcquireSpinlockIrqSave(&trace->Lock);
+
+    if (trace->PID != PID)
+    {
+        ReleaseSpinlockIrqRestore(&trace->Lock, flags);
+        return -1;
+    }
+
+    // The dropped SysCalls are reported before the following entries
+    if ((trace->Dropped > 0) && (count < MaxEntries))
+    {
+        memset(&Buffer[count], 0, sizeof(SysCallTraceEntry));
+        Buffer[count++].Result = trace->Dropped;
+        trace->Dropped = 0;
+    }
+
+    while ((trace->Head != trace->Tail) && (count < MaxEntries))
+    {
+        Buffer[count++] = trace->Entries[trace->Head % SYSCALL_TRACE_ENTRIES];
+        trace->Head++;
+    }
+
+    ReleaseSpinlockIrqRestore(&trace->Lock, flags);
+
+    // A terminated Task doesn't produce any further entries
+    if ((count == 0) && (FindTaskByPid(PID) == 0x0))
+    {
+        DetachSysCallTrace(PID);
+        return -1;
+    }
+
+    return count;
+}
+
+// Returns the trace ring of the Task with the given PID, or 0x0 if the Task isn't traced.
+// The SysCalls of the tracer are serialized through the Kernel Lock, so the trace rings are only reserved and
+// released by one tracer at a time.
+static SysCallTrace *FindSysCallTrace(unsigned long PID)
+{
+    int i;
+
+    if (PID == 0)
+        return 0x0;
+
+    for (i = 0; i < MAX_SYSCALL_TRACES; i++)
+    {
+        if (sysCallTraces[i].PID == PID)
+            return &sysCallTraces[i];
+    }
+
+    return 0x0;
+}
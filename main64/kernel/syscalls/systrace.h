@@ -0,0 +1,87 @@
+#ifndef SYSTRACE_H
+#define SYSTRACE_H
+
+#include "syscall.h"
+#include "../multitasking/multitasking.h"
+#include "../multitasking/spinlock.h"
+#include "../multitasking/latency.h"
+
+// The number of SysCall numbers that have statistics (the SysCall numbers 0 - 63)
+#define SYSCALL_STATISTICS_ENTRIES      64
+
+// The maximum length of a SysCall name in the SysCall "SYSCALL_GETSYSCALLSTATS"
+#define SYSCALL_NAME_LENGTH             24
+
+// The number of entries of the trace ring of a Task
+#define SYSCALL_TRACE_ENTRIES           64
+
+// The maximum number of Tasks that can be traced at the same time
+#define MAX_SYSCALL_TRACES              4
+
+// The maximum number of entries that the SysCall "SYSCALL_TRACE_READ" returns at once
+#define SYSCALL_TRACE_READ_ENTRIES      16
+
+// A snapshot of the statistics of a SysCall, as returned by the SysCall "SYSCALL_GETSYSCALLSTATS".
+// The histogram counts the calls, and their durations (in nanoseconds) in the SysCall Handler.
+// The same structure is defined in the file "libc.h".
+typedef struct SysCallStatistics
+{
+    char Name[SYSCALL_NAME_LENGTH];
+    LatencyHistogram Latency;
+} SysCallStatistics;
+
+// A traced SysCall, as returned by the SysCall "SYSCALL_TRACE_READ".
+// An entry with the SysCall number 0 reports in "Result" the number of SysCalls that were dropped, because the
+// trace ring was full.
+// The same structure is defined in the file "libc.h".
+typedef struct SysCallTraceEntry
+{
+    unsigned long Number;
+    unsigned long Arguments[SYSCALL_MAX_ARGUMENTS];
+    unsigned long Result;
+
+    // The duration of the SysCall (in nanoseconds)
+    unsigned long Duration;
+} SysCallTraceEntry;
+
+// The trace ring of a traced Task.
+// The traced Task produces the entries at the tail, and the tracer consumes them at the head.
+typedef struct SysCallTrace
+{
+    // Protects the trace ring against the tracer, and against a concurrent detach
+    Spinlock Lock;
+
+    // The PID of the traced Task (0 if the trace ring is free)
+    unsigned long PID;
+
+    // The positions are running freely, and they are masked when they index into the ring
+    unsigned int Head;
+    unsigned int Tail;
+
+    // The number of SysCalls that were dropped since the last read, because the trace ring was full
+    unsigned long Dropped;
+
+    SysCallTraceEntry Entries[SYSCALL_TRACE_ENTRIES];
+} SysCallTrace;
+
+// Records a finished SysCall of the given Task, which took the given number of TSC ticks
+void RecordSysCall(Task *Task, SysCallRegisters *Registers, unsigned long Result, unsigned long Ticks);
+
+// Returns a snapshot of the statistics of the given SysCall number. It returns 0 for an unknown SysCall.
+int GetSysCallStatistics(unsigned long Number, SysCallStatistics *Buffer);
+
+// Attaches a trace ring to the Task with the given PID.
+// It returns 0 if the Task doesn't exist, if it's already traced, or if no trace ring is available.
+int AttachSysCallTrace(Task *Tracer, unsigned long PID);
+
+// Detaches the trace ring from the Task with the given PID
+void DetachSysCallTrace(unsigned long PID);
+
+// Reads the next entries from the trace ring of the Task with the given PID, and returns their number.
+// It returns -1 if the Task isn't traced, or when it has terminated and all of its entries were read.
+int ReadSysCallTrace(unsigned long PID, SysCallTraceEntry *Buffer, int MaxEntries);
+
+// Returns the trace ring of the Task with the given PID, or 0x0 if the Task isn't traced
+static SysCallTrace *FindSysCallTrace(unsigned long PID);
+
+#endif
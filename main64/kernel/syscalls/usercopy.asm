@@ -0,0 +1,70 @@
+[BITS 64]
+[GLOBAL CopyUserMemory]
+[GLOBAL CopyUserString]
+[GLOBAL ReadUserWord]
+[GLOBAL ExceptionFixupTable]
+[GLOBAL ExceptionFixupTableEnd]
+
+; Copies memory from or to User Mode, and returns the number of bytes that couldn't be copied.
+; RDI: Destination, RSI: Source, RDX: Length
+; The caller has already checked the User Mode address range.
+CopyUserMemory:
+    MOV     RCX, RDX
+CopyUserMemoryAccess:
+    REP     MOVSB
+    XOR     EAX, EAX
+    RET
+
+; A fault during the copy continues here, and RCX contains the number of remaining bytes
+CopyUserMemoryFixup:
+    MOV     RAX, RCX
+    RET
+
+; Copies a null-terminated string from User Mode, and returns its length (without the null terminator).
+; It returns the buffer size, when no null terminator was found, and -1 when the string isn't accessible.
+; RDI: Destination, RSI: Source, RDX: Size of the destination buffer
+CopyUserString:
+    XOR     EAX, EAX
+
+CopyUserStringLoop:
+    CMP     RAX, RDX
+    JAE     CopyUserStringDone
+CopyUserStringAccess:
+    MOV     CL, [RSI + RAX]
+    MOV     [RDI + RAX], CL
+    TEST    CL, CL
+    JZ      CopyUserStringDone
+    INC     RAX
+    JMP     CopyUserStringLoop
+
+CopyUserStringDone:
+    RET
+
+; A fault during the copy continues here
+CopyUserStringFixup:
+    MOV     RAX, -1
+    RET
+
+; Reads a 32 bit word from User Mode with a single access, and returns 0 (or -1 when the word isn't accessible).
+; RDI: Destination, RSI: Source
+; The caller has already checked the User Mode address range.
+ReadUserWord:
+ReadUserWordAccess:
+    MOV     EAX, [RSI]
+    MOV     [RDI], EAX
+    XOR     EAX, EAX
+    RET
+
+; A fault during the read continues here
+ReadUserWordFixup:
+    MOV     RAX, -1
+    RET
+
+; The Exception Fixup Table (C structure "ExceptionFixup").
+; It contains every instruction that accesses User Mode memory, and where the execution continues when the
+; instruction raises an exception that can't be resolved (searched by the function "SearchExceptionFixup").
+ExceptionFixupTable:
+    DQ      CopyUserMemoryAccess, CopyUserMemoryFixup
+    DQ      CopyUserStringAccess, CopyUserStringFixup
+    DQ      ReadUserWordAccess, ReadUserWordFixup
+ExceptionFixupTableEnd:
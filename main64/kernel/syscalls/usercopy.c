@@ -0,0 +1,77 @@
+#include "usercopy.h"
+
+// Returns 1 if the given address range lies completely in the User Mode part of the virtual address space.
+// Otherwise a User Mode program could read or overwrite Kernel Mode memory through the buffers of a SysCall.
+int IsUserModeAddressRange(unsigned long Address, unsigned long Length)
+{
+    return (Address < USERMODE_ADDRESS_LIMIT) && (Length <= USERMODE_ADDRESS_LIMIT - Address);
+}
+
+// Copies a buffer from User Mode memory into Kernel Mode memory.
+// It returns the number of bytes that couldn't be copied (0 on success).
+// A missing page of the User Mode buffer is resolved by the Page Fault Handler, every other fault ends the copy.
+unsigned long copy_from_user(void *Destination, void *Source, unsigned long Length)
+{
+    if (!IsUserModeAddressRange((unsigned long)Source, Length))
+        return Length;
+
+    return CopyUserMemory(Destination, Source, Length);
+}
+
+// Copies a buffer from Kernel Mode memory into User Mode memory.
+// It returns the number of bytes that couldn't be copied (0 on success).
+unsigned long copy_to_user(void *Destination, void *Source, unsigned long Length)
+{
+    if (!IsUserModeAddressRange((unsigned long)Destination, Length))
+        return Length;
+
+    return CopyUserMemory(Destination, Source, Length);
+}
+
+// Copies a null-terminated string from User Mode memory into a Kernel Mode buffer of the given size.
+// It returns the length of the string, the buffer size when the string doesn't fit (the buffer isn't null-terminated
+// then), or -1 when the string isn't accessible.
+long strncpy_from_user(char *Destination, char *Source, long Size)
+{
+    unsigned long source = (unsigned long)Source;
+    long length;
+
+    if ((Size <= 0) || (source >= USERMODE_ADDRESS_LIMIT))
+        return -1;
+
+    // The string must not continue into Kernel Mode memory
+    if (Size > USERMODE_ADDRESS_LIMIT - source)
+    {
+        length = CopyUserString(Destination, Source, USERMODE_ADDRESS_LIMIT - source);
+
+        return length == USERMODE_ADDRESS_LIMIT - source ? -1 : length;
+    }
+
+    return CopyUserString(Destination, Source, Size);
+}
+
+// Reads an aligned 32 bit word from User Mode memory with a single access.
+// It returns 0 on success, and -1 when the word isn't accessible.
+// It can be called with disabled interrupts, because a fault just returns -1 (or maps a missing page).
+int get_user(unsigned int *Value, unsigned int *Address)
+{
+    if (!IsUserModeAddressRange((unsigned long)Address, sizeof(unsigned int)))
+        return -1;
+
+    return ReadUserWord(Value, Address);
+}
+
+// Returns the fixup address for an exception at the given instruction, or 0 if the instruction has no fixup.
+// Only the instructions of the copy routines are accessing User Mode memory, therefore the table is tiny.
+unsigned long SearchExceptionFixup(unsigned long RIP)
+{
+    ExceptionFixup *fixup;
+
+    for (fixup = ExceptionFixupTable; fixup < ExceptionFixupTableEnd; fixup++)
+    {
+        if (fixup->FaultAddress == RIP)
+            return fixup->FixupAddress;
+    }
+
+    return 0;
+}
@@ -0,0 +1,50 @@
+#ifndef USERCOPY_H
+#define USERCOPY_H
+
+#include "../multitasking/multitasking.h"
+
+// An entry of the Exception Fixup Table.
+// When the instruction at the fault address raises an exception, the execution continues at the fixup address.
+typedef struct ExceptionFixup
+{
+    unsigned long FaultAddress;
+    unsigned long FixupAddress;
+} ExceptionFixup;
+
+// Returns 1 if the given address range lies completely in the User Mode part of the virtual address space
+int IsUserModeAddressRange(unsigned long Address, unsigned long Length);
+
+// Copies a buffer from User Mode memory into Kernel Mode memory.
+// It returns the number of bytes that couldn't be copied (0 on success).
+unsigned long copy_from_user(void *Destination, void *Source, unsigned long Length);
+
+// Copies a buffer from Kernel Mode memory into User Mode memory.
+// It returns the number of bytes that couldn't be copied (0 on success).
+unsigned long copy_to_user(void *Destination, void *Source, unsigned long Length);
+
+// Copies a null-terminated string from User Mode memory into a Kernel Mode buffer of the given size.
+// It returns the length of the string, the buffer size when the string doesn't fit (the buffer isn't null-terminated
+// then), or -1 when the string isn't accessible.
+long strncpy_from_user(char *Destination, char *Source, long Size);
+
+// Reads an aligned 32 bit word from User Mode memory with a single access.
+// It returns 0 on success, and -1 when the word isn't accessible.
+int get_user(unsigned int *Value, unsigned int *Address);
+
+// Returns the fixup address for an exception at the given instruction, or 0 if the instruction has no fixup
+unsigned long SearchExceptionFixup(unsigned long RIP);
+
+// Copies memory, and returns the number of bytes that couldn't be copied (implemented in Assembler)
+extern unsigned long CopyUserMemory(void *Destination, void *Source, unsigned long Length);
+
+// Copies a null-terminated string, and returns its length or -1 (implemented in Assembler)
+extern long CopyUserString(char *Destination, char *Source, long Size);
+
+// Reads a 32 bit word, and returns 0 or -1 (implemented in Assembler)
+extern int ReadUserWord(unsigned int *Destination, unsigned int *Source);
+
+// The Exception Fixup Table (defined in the file "usercopy.asm")
+extern ExceptionFixup ExceptionFixupTable[];
+extern ExceptionFixup ExceptionFixupTableEnd[];
+
+#endif
@@ -0,0 +1,64 @@
+#include "vdso.h"
+#include "../common.h"
+#include "../drivers/timer.h"
+#include "../memory/physical-memory.h"
+#include "../memory/virtual-memory.h"
+
+// The Page Frame of the shared page of the vDSO
+unsigned long vdsoPageFrame = 0;
+
+// Initializes the shared page of the vDSO.
+// The page stays mapped into the Kernel Mode address space, where the Kernel updates it.
+void InitVdso()
+{
+    VdsoData *data = (VdsoData *)VDSO_KERNEL_ADDRESS;
+
+    vdsoPageFrame = AllocatePageFrame();
+    MapVirtualAddressToPhysicalAddress(VDSO_KERNEL_ADDRESS, vdsoPageFrame * SMALL_PAGE_SIZE);
+    memset(data, 0, SMALL_PAGE_SIZE);
+
+    data->TscBoot = GetTscBoot();
+    data->TscFrequency = GetTscFrequency();
+    UpdateVdsoWallClock();
+}
+
+// Publishes the current system date in the shared page of the vDSO.
+// It's only called by the system date timer, so there is only one writer at a time.
+void UpdateVdsoWallClock()
+{
+    VdsoData *data = (VdsoData *)VDSO_KERNEL_ADDRESS;
+    BiosInformationBlock *bib = (BiosInformationBlock *)BIB_OFFSET;
+
+    if (vdsoPageFrame == 0)
+        return;
+
+    // The odd sequence number tells the readers that the wall clock is changing
+    __atomic_store_n(&data->Sequence, data->Sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    data->Year = bib->Year;
+    data->Month = bib->Month;
+    data->Day = bib->Day;
+    data->Hour = bib->Hour;
+    data->Minute = bib->Minute;
+    data->Second = bib->Second;
+
+    __atomic_store_n(&data->Sequence, data->Sequence + 1, __ATOMIC_RELEASE);
+}
+
+// Maps the vDSO read-only into the current User Mode address space of the process with the given PID.
+// Like the other pages of a User Mode address space, the page of the process is not released anymore.
+void MapVdso(unsigned long PID)
+{
+    VdsoProcessData *processData = (VdsoProcessData *)VDSO_PROCESS_USERMODE_ADDRESS;
+
+    MapVirtualAddressToPhysicalAddress(VDSO_USERMODE_ADDRESS, vdsoPageFrame * SMALL_PAGE_SIZE);
+    MapVirtualAddressToPhysicalAddress(VDSO_PROCESS_USERMODE_ADDRESS, AllocatePageFrame() * SMALL_PAGE_SIZE);
+
+    // The page of the process is initialized, before it becomes read-only
+    memset(processData, 0, SMALL_PAGE_SIZE);
+    processData->PID = PID;
+
+    ProtectVirtualAddress(VDSO_USERMODE_ADDRESS);
+    ProtectVirtualAddress(VDSO_PROCESS_USERMODE_ADDRESS);
+}
@@ -0,0 +1,50 @@
+#ifndef VDSO_H
+#define VDSO_H
+
+// The read-only pages of the vDSO are mapped at these addresses into every User Mode process.
+// The 1st page is shared by all processes, and the 2nd page belongs to the process itself.
+#define VDSO_USERMODE_ADDRESS           0x0000500000000000
+#define VDSO_PROCESS_USERMODE_ADDRESS   0x0000500000001000
+
+// The shared page of the vDSO stays mapped at this address into the Kernel Mode address space
+#define VDSO_KERNEL_ADDRESS             0xFFFF800003800000
+
+// The data that the Kernel publishes in the shared page for all User Mode processes.
+// The wall clock is protected by a sequence lock: the sequence number is odd while the Kernel updates the wall clock,
+// and a reader retries when the sequence number has changed during its read.
+// The same structure is defined in the file "libc.h".
+typedef struct VdsoData
+{
+    volatile unsigned int Sequence;
+
+    // The wall clock (the system date)
+    int Year;
+    short Month;
+    short Day;
+    short Hour;
+    short Minute;
+    short Second;
+
+    // The Monotonic Clock is calculated in User Mode from these TSC values
+    unsigned long TscBoot;
+    unsigned long TscFrequency;
+} VdsoData;
+
+// The data that the Kernel publishes in the page of a single User Mode process.
+// The same structure is defined in the file "libc.h".
+typedef struct VdsoProcessData
+{
+    // The PID of the process (the PID of its initial Task)
+    unsigned long PID;
+} VdsoProcessData;
+
+// Initializes the shared page of the vDSO
+void InitVdso();
+
+// Publishes the current system date in the shared page of the vDSO
+void UpdateVdsoWallClock();
+
+// Maps the vDSO read-only into the current User Mode address space of the process with the given PID
+void MapVdso(unsigned long PID);
+
+#endif
@@ -11,10 +11,57 @@ void printf(unsigned char *string)
     SYSCALL1(SYSCALL_PRINTF, string);
 }
 
-// Returns the PID of the current executing process
+// Returns the PID of the current executing process (read from the vDSO without a SysCall).
+// All threads of a process return the same PID - their thread IDs are returned by "thread_create".
 long GetPID()
 {
-    return SYSCALL0(SYSCALL_GETPID);
+    return ((VdsoProcessData *)VDSO_PROCESS_USERMODE_ADDRESS)->PID;
+}
+
+// Returns the number of nanoseconds since the Kernel has started its timer (read from the vDSO without a SysCall)
+unsigned long GetMonotonicTime()
+{
+    VdsoData *data = (VdsoData *)VDSO_USERMODE_ADDRESS;
+    unsigned int low;
+    unsigned int high;
+    unsigned long ticks;
+
+    asm volatile("rdtsc" : "=a" (low), "=d" (high));
+    ticks = (((unsigned long)high << 32) | low) - data->TscBoot;
+
+    // The calculation is split into whole seconds and the remainder, so that the multiplication doesn't overflow
+    return (ticks / data->TscFrequency) * 1000000000 + (ticks % data->TscFrequency) * 1000000000 / data->TscFrequency;
+}
+
+// Returns the current system date and time (read from the vDSO without a SysCall).
+// The read is retried, when the Kernel has updated the wall clock in the meantime.
+void GetDateTime(int *Year, int *Month, int *Day, int *Hour, int *Minute, int *Second)
+{
+    VdsoData *data = (VdsoData *)VDSO_USERMODE_ADDRESS;
+    unsigned int sequence;
+
+    while (1 == 1)
+    {
+        sequence = __atomic_load_n(&data->Sequence, __ATOMIC_ACQUIRE);
+
+        if (sequence & 1)
+        {
+            asm volatile("pause");
+            continue;
+        }
+
+        *Year = data->Year;
+        *Month = data->Month;
+        *Day = data->Day;
+        *Hour = data->Hour;
+        *Minute = data->Minute;
+        *Second = data->Second;
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        if (__atomic_load_n(&data->Sequence, __ATOMIC_RELAXED) == sequence)
+            return;
+    }
 }
 
 // Terminates the current executing process
@@ -59,8 +106,13 @@ void scanf(char *buffer, int buffer_size)
 
         processKey = 1;
         
-        // When we have hit the ENTER key, we have finished entering our input data
-        if (key == KEY_RETURN)
+        // A redirected standard input has no more data
+        if (key == KEY_END_OF_FILE)
+            break;
+
+        // When we have hit the ENTER key (or reached the end of a line in a redirected standard input),
+        // we have finished entering our input data
+        if ((key == KEY_RETURN) || (key == '\n'))
         {
             printf("\n");
             break;
@@ -234,10 +286,49 @@ int StartsWith(char *string, char *prefix)
     return 1;
 }
 
-// Executes the given User Mode program
+// Executes the given User Mode program, and returns its PID (0 if the program wasn't started)
 int ExecuteUserModeProgram(unsigned char *FileName)
 {
-    return SYSCALL1(SYSCALL_EXECUTE, FileName);
+    return ExecuteUserModeProgramRedirected(FileName, 0, 0);
+}
+
+// Executes the given User Mode program with the given pipe handles as its standard input and output (0 is the console).
+// The program gets its own references to the pipe ends, so the caller can close its handles afterwards.
+int ExecuteUserModeProgramRedirected(unsigned char *FileName, unsigned long StandardInput, unsigned long StandardOutput)
+{
+    return SYSCALL3(SYSCALL_EXECUTE, FileName, (void *)StandardInput, (void *)StandardOutput);
+}
+
+// Creates an anonymous pipe, and returns the handles of its read end and its write end
+int CreatePipe(unsigned long *ReadHandle, unsigned long *WriteHandle)
+{
+    unsigned long handles[2];
+
+    if (SYSCALL1(SYSCALL_PIPE, handles) == 0)
+        return 0;
+
+    *ReadHandle = handles[0];
+    *WriteHandle = handles[1];
+
+    return 1;
+}
+
+// Opens the named Shared Memory Segment, and returns its handle
+int shm_open(char *Name, unsigned long Size)
+{
+    return SYSCALL2(SYSCALL_SHM_OPEN, Name, (void *)Size);
+}
+
+// Maps a Shared Memory Segment into the address space of the current process, and returns its address
+void *shm_map(int Handle)
+{
+    return (void *)SYSCALL1(SYSCALL_SHM_MAP, (void *)(long)Handle);
+}
+
+// Unmaps a Shared Memory Segment, and closes its handle
+int shm_unmap(int Handle)
+{
+    return SYSCALL1(SYSCALL_SHM_UNMAP, (void *)(long)Handle);
 }
 
 // Prints out the root directory of the FAT12 partition
@@ -282,6 +373,20 @@ unsigned long WriteFile(unsigned long FileHandle, unsigned char *Buffer, unsigne
     return SYSCALL3(SYSCALL_WRITEFILE, (void *)FileHandle, Buffer, (void *)Length);
 }
 
+// Reads the requested data from a file (or the console) into several buffers through a single SysCall.
+// The buffers are filled one after another, and the return value is the length of the read data.
+unsigned long ReadFileVector(unsigned long FileHandle, IoVector *Vectors, int Count)
+{
+    return SYSCALL3(SYSCALL_READFILEV, (void *)FileHandle, Vectors, (void *)(long)Count);
+}
+
+// Writes the requested data from several buffers into a file (or onto the console) through a single SysCall.
+// The file metadata is only updated once, and the console output of other processes can't interleave the buffers.
+unsigned long WriteFileVector(unsigned long FileHandle, IoVector *Vectors, int Count)
+{
+    return SYSCALL3(SYSCALL_WRITEFILEV, (void *)FileHandle, Vectors, (void *)(long)Count);
+}
+
 // Seeks to the specific position in the file
 int SeekFile(unsigned long FileHandle, unsigned long NewFileOffset)
 {
@@ -292,4 +397,297 @@ int SeekFile(unsigned long FileHandle, unsigned long NewFileOffset)
 int EndOfFile(unsigned long FileHandle)
 {
     return SYSCALL1(SYSCALL_ENDOFFILE, (void *)FileHandle);
+}
+
+// Blocks the current executing process for the given number of milliseconds
+void Sleep(unsigned long Milliseconds)
+{
+    SYSCALL1(SYSCALL_SLEEP, (void *)Milliseconds);
+}
+
+// Blocks the current executing process for the given number of nanoseconds
+void NanoSleep(unsigned long Nanoseconds)
+{
+    SYSCALL1(SYSCALL_NANOSLEEP, (void *)Nanoseconds);
+}
+
+// Gives up the CPU, so that the other runnable processes can execute
+void Yield()
+{
+    SYSCALL0(SYSCALL_YIELD);
+}
+
+// Moves the current Task into the Real-Time scheduling class with the given priority (0 - 31), or back into the normal
+// class with a negative priority. The Task may run for "Runtime" nanoseconds in each period of "Period" nanoseconds.
+// It returns 0 if the CPU bandwidth couldn't be admitted.
+int SetRealTime(int Priority, unsigned long Runtime, unsigned long Period)
+{
+    return SYSCALL3(SYSCALL_SETREALTIME, (void *)(long)Priority, (void *)Runtime, (void *)Period);
+}
+
+// Creates a new thread in the current process, which executes the given function with the given argument.
+// The thread has its own Stack and Thread Local Storage (the given Thread structure). It returns the thread ID,
+// or 0 if the thread couldn't be created.
+unsigned long thread_create(Thread *Thread, long (*StartRoutine)(void *Argument), void *Argument)
+{
+    Thread->Self = Thread;
+    Thread->StartRoutine = StartRoutine;
+    Thread->Argument = Argument;
+    Thread->TID = SYSCALL3(SYSCALL_THREAD_CREATE, ThreadEntry, Thread, Thread);
+
+    return Thread->TID;
+}
+
+// Terminates the current thread with the given exit code
+void thread_exit(long ExitCode)
+{
+    SYSCALL1(SYSCALL_THREAD_EXIT, (void *)ExitCode);
+    while (1 == 1) {}
+}
+
+// Waits until the thread with the given thread ID has exited, and returns its exit code.
+// It returns 0 if the thread doesn't exist in the current process.
+int thread_join(unsigned long TID, long *ExitCode)
+{
+    // Touch the exit code, so that its page is mapped before the Kernel writes into it
+    *ExitCode = 0;
+
+    return SYSCALL2(SYSCALL_THREAD_JOIN, (void *)TID, ExitCode);
+}
+
+// Sets the Thread Pointer (the FS base) of the current thread
+void SetThreadPointer(void *ThreadPointer)
+{
+    SYSCALL1(SYSCALL_SETTHREADPOINTER, ThreadPointer);
+}
+
+// Returns the first 8 bytes of the Thread Local Storage of the current thread (the Thread structure for a thread
+// that was created through "thread_create")
+void *GetThreadPointer()
+{
+    void *threadPointer;
+
+    asm volatile("mov %%fs:0, %0" : "=r" (threadPointer));
+    return threadPointer;
+}
+
+// The entry point of a new thread, which calls its start routine.
+// The thread is terminated with the return value of the start routine.
+static void ThreadEntry(Thread *Thread)
+{
+    thread_exit(Thread->StartRoutine(Thread->Argument));
+}
+
+// Blocks the current thread, as long as the futex word contains the expected value.
+// It returns 1 after the thread was woken up, and 0 when the futex word contains another value.
+// The futex word was accessed by the caller, so its page is already mapped when the Kernel reads it.
+int FutexWait(volatile unsigned int *Address, unsigned int ExpectedValue)
+{
+    return SYSCALL2(SYSCALL_FUTEX_WAIT, (void *)Address, (void *)(unsigned long)ExpectedValue);
+}
+
+// Wakes up the given number of threads that are waiting on the futex word, and returns the number of woken up threads
+int FutexWake(volatile unsigned int *Address, int Count)
+{
+    return SYSCALL2(SYSCALL_FUTEX_WAKE, (void *)Address, (void *)(long)Count);
+}
+
+// Initializes a Mutex
+void InitMutex(Mutex *Mutex)
+{
+    Mutex->State = MUTEX_UNLOCKED;
+}
+
+// Acquires a Mutex. The current thread is blocked while another thread holds the Mutex.
+// An uncontended Mutex is acquired with a single atomic instruction. A contended Mutex is marked with MUTEX_CONTENDED
+// before the thread blocks, so that the releasing thread knows that it has to raise the futex SysCall.
+void AcquireMutex(Mutex *Mutex)
+{
+    unsigned int state = MUTEX_UNLOCKED;
+
+    if (__atomic_compare_exchange_n(&Mutex->State, &state, MUTEX_LOCKED, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        return;
+
+    // The Mutex is acquired in the state MUTEX_CONTENDED, because other threads can still wait for it
+    if (state != MUTEX_CONTENDED)
+        state = __atomic_exchange_n(&Mutex->State, MUTEX_CONTENDED, __ATOMIC_ACQUIRE);
+
+    while (state != MUTEX_UNLOCKED)
+    {
+        FutexWait(&Mutex->State, MUTEX_CONTENDED);
+        state = __atomic_exchange_n(&Mutex->State, MUTEX_CONTENDED, __ATOMIC_ACQUIRE);
+    }
+}
+
+// Tries to acquire a Mutex without blocking. It returns 1 if the Mutex was acquired.
+int TryAcquireMutex(Mutex *Mutex)
+{
+    unsigned int state = MUTEX_UNLOCKED;
+
+    return __atomic_compare_exchange_n(&Mutex->State, &state, MUTEX_LOCKED, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+// Releases a Mutex.
+// The futex SysCall is only raised, when another thread maybe waits for the Mutex.
+void ReleaseMutex(Mutex *Mutex)
+{
+    if (__atomic_exchange_n(&Mutex->State, MUTEX_UNLOCKED, __ATOMIC_RELEASE) == MUTEX_CONTENDED)
+        FutexWake(&Mutex->State, 1);
+}
+
+// Initializes a Condition Variable
+void InitConditionVariable(ConditionVariable *Condition)
+{
+    Condition->Sequence = 0;
+}
+
+// Releases the Mutex, and blocks the current thread until the Condition Variable is signaled.
+// The Mutex is acquired again before the function returns. Like with every Condition Variable, the caller must
+// check its condition again, because the thread can also be woken up by a signal that was meant for another thread.
+void WaitConditionVariable(ConditionVariable *Condition, Mutex *Mutex)
+{
+    unsigned int sequence = __atomic_load_n(&Condition->Sequence, __ATOMIC_ACQUIRE);
+
+    ReleaseMutex(Mutex);
+    FutexWait(&Condition->Sequence, sequence);
+
+    // The Mutex is acquired in the state MUTEX_CONTENDED, because the other woken up threads are maybe waiting for it
+    while (__atomic_exchange_n(&Mutex->State, MUTEX_CONTENDED, __ATOMIC_ACQUIRE) != MUTEX_UNLOCKED)
+        FutexWait(&Mutex->State, MUTEX_CONTENDED);
+}
+
+// Wakes up one thread that waits on the Condition Variable
+void SignalConditionVariable(ConditionVariable *Condition)
+{
+    __atomic_add_fetch(&Condition->Sequence, 1, __ATOMIC_RELEASE);
+    FutexWake(&Condition->Sequence, 1);
+}
+
+// Wakes up all threads that are waiting on the Condition Variable
+void BroadcastConditionVariable(ConditionVariable *Condition)
+{
+    __atomic_add_fetch(&Condition->Sequence, 1, __ATOMIC_RELEASE);
+    FutexWake(&Condition->Sequence, FUTEX_WAKE_ALL);
+}
+
+// Returns a snapshot of the statistics of all Tasks
+int GetTaskStatistics(TaskStatistics *Buffer, int MaxEntries)
+{
+    char *buffer = (char *)Buffer;
+    unsigned long i;
+
+    // Touch the whole buffer, so that its pages are mapped before the Kernel writes into it.
+    // The SysCall is executed with disabled interrupts, where no Page Faults can be handled.
+    for (i = 0; i < MaxEntries * sizeof(TaskStatistics); i++)
+        buffer[i] = 0;
+
+    return SYSCALL2(SYSCALL_GETTASKSTATISTICS, Buffer, (void *)(unsigned long)MaxEntries);
+}
+
+// Returns a snapshot of the contention statistics of all Kernel locks
+int GetLockStatistics(LockStatistics *Buffer, int MaxEntries)
+{
+    char *buffer = (char *)Buffer;
+    unsigned long i;
+
+    // Touch the whole buffer, so that its pages are mapped before the Kernel writes into it.
+    // The SysCall is executed with disabled interrupts, where no Page Faults can be handled.
+    for (i = 0; i < MaxEntries * sizeof(LockStatistics); i++)
+        buffer[i] = 0;
+
+    return SYSCALL2(SYSCALL_GETLOCKSTATISTICS, Buffer, (void *)(unsigned long)MaxEntries);
+}
+
+// Returns a scheduling latency histogram (LATENCY_RUNQUEUE or LATENCY_WAKEUP) of the given process.
+// The PID 0 returns the system-wide histogram. It returns 0 if the process doesn't exist.
+int GetLatencyHistogram(unsigned long PID, int Kind, LatencyHistogram *Buffer)
+{
+    char *buffer = (char *)Buffer;
+    unsigned long i;
+
+    // Touch the whole buffer, so that its pages are mapped before the Kernel writes into it.
+    // The SysCall is executed with disabled interrupts, where no Page Faults can be handled.
+    for (i = 0; i < sizeof(LatencyHistogram); i++)
+        buffer[i] = 0;
+
+    return SYSCALL3(SYSCALL_GETLATENCYHISTOGRAM, (void *)PID, (void *)(long)Kind, Buffer);
+}
+
+// Returns the statistics of the given SysCall number. It returns 0 for an unknown SysCall.
+int GetSysCallStatistics(int Number, SysCallStatistics *Buffer)
+{
+    return SYSCALL2(SYSCALL_GETSYSCALLSTATS, (void *)(long)Number, Buffer);
+}
+
+// Starts to trace the SysCalls of the process with the given PID. It returns 0 if the process can't be traced.
+int SysCallTraceAttach(unsigned long PID)
+{
+    return SYSCALL1(SYSCALL_TRACE_ATTACH, (void *)PID);
+}
+
+// Stops to trace the SysCalls of the process with the given PID
+void SysCallTraceDetach(unsigned long PID)
+{
+    SYSCALL1(SYSCALL_TRACE_DETACH, (void *)PID);
+}
+
+// Reads the next traced SysCalls of the process with the given PID, and returns their number.
+// It returns -1 if the process isn't traced anymore, or when it has terminated and all of its SysCalls were read.
+int SysCallTraceRead(unsigned long PID, SysCallTraceEntry *Buffer, int MaxEntries)
+{
+    return SYSCALL3(SYSCALL_TRACE_READ, (void *)PID, Buffer, (void *)(long)MaxEntries);
+}
+
+// Sets up the I/O Ring of the current process, and returns its shared page (0x0 if it couldn't be set up)
+IoRingShared *IoRingSetup()
+{
+    return (IoRingShared *)SYSCALL0(SYSCALL_IORING_SETUP);
+}
+
+// Submits the given number of queued operations to the Kernel, and waits until at least "MinComplete" completions
+// are available. It returns the number of submitted operations.
+int IoRingEnter(int ToSubmit, int MinComplete)
+{
+    return SYSCALL2(SYSCALL_IORING_ENTER, (void *)(long)ToSubmit, (void *)(long)MinComplete);
+}
+
+// Queues an operation in the Submission Queue. It returns 0 if the Submission Queue is full.
+int IoRingQueueSubmission(IoRingShared *Ring, int Operation, int Flags, unsigned long UserData, unsigned long Argument1, unsigned long Argument2, unsigned long Argument3)
+{
+    unsigned int tail = Ring->SubmissionTail;
+    IoRingSubmission *submission;
+
+    if (tail - __atomic_load_n(&Ring->SubmissionHead, __ATOMIC_ACQUIRE) >= IO_RING_ENTRIES)
+        return 0;
+
+    submission = &Ring->Submissions[tail & IO_RING_MASK];
+    submission->Operation = Operation;
+    submission->Flags = Flags;
+    submission->Arguments[0] = Argument1;
+    submission->Arguments[1] = Argument2;
+    submission->Arguments[2] = Argument3;
+    submission->Arguments[3] = 0;
+    submission->Arguments[4] = 0;
+    submission->UserData = UserData;
+
+    // The Kernel must see the complete entry, before it sees the new tail
+    __atomic_store_n(&Ring->SubmissionTail, tail + 1, __ATOMIC_RELEASE);
+
+    return 1;
+}
+
+// Takes the next completion from the Completion Queue. It returns 0 if no completion is available.
+int IoRingGetCompletion(IoRingShared *Ring, IoRingCompletion *Completion)
+{
+    unsigned int head = Ring->CompletionHead;
+
+    if (head == __atomic_load_n(&Ring->CompletionTail, __ATOMIC_ACQUIRE))
+        return 0;
+
+    *Completion = Ring->Completions[head & IO_RING_COMPLETION_MASK];
+
+    // The Kernel can reuse the entry after it sees the new head
+    __atomic_store_n(&Ring->CompletionHead, head + 1, __ATOMIC_RELEASE);
+
+    return 1;
 }
\ No newline at end of file
@@ -4,16 +4,228 @@
 #define KEY_RETURN      '\r'
 #define KEY_BACKSPACE   '\b'
 
+// Returned by "getchar" at the end of a standard input, which was redirected to a pipe
+#define KEY_END_OF_FILE ((char)-1)
+
+// A snapshot of the statistics of a Task.
+// The same structure is defined in the file "multitasking.h" of the Kernel.
+typedef struct TaskStatistics
+{
+    unsigned long PID;
+    unsigned long Status;
+
+    // The CPU time in User Mode and in Kernel Mode, and the time in the status WAITING (in nanoseconds)
+    unsigned long UserTime;
+    unsigned long KernelTime;
+    unsigned long WaitTime;
+
+    unsigned long ContextSwitches;
+    unsigned long VoluntaryContextSwitches;
+    unsigned long InvoluntaryContextSwitches;
+    unsigned long PageFaults;
+} TaskStatistics;
+
+// A snapshot of the contention statistics of a Kernel lock.
+// The same structure is defined in the file "spinlock.h" of the Kernel.
+typedef struct LockStatistics
+{
+    char Name[16];
+    unsigned long Acquisitions;
+    unsigned long Contentions;
+    unsigned long Spins;
+
+    // The longest time that the lock was held (in TSC ticks)
+    unsigned long MaxHoldTime;
+} LockStatistics;
+
+// The number of buckets of a latency histogram, and the recorded scheduling latencies
+#define LATENCY_BUCKETS     32
+#define LATENCY_RUNQUEUE    0
+#define LATENCY_WAKEUP      1
+
+// A log2 histogram of scheduling latencies (in nanoseconds).
+// The bucket i counts the latencies from 2^i up to 2^(i+1) - 1 nanoseconds.
+// The same structure is defined in the file "latency.h" of the Kernel.
+typedef struct LatencyHistogram
+{
+    unsigned long Buckets[LATENCY_BUCKETS];
+    unsigned long Count;
+    unsigned long Total;
+    unsigned long Max;
+} LatencyHistogram;
+
+// The maximum length of a SysCall name, and the maximum number of trace entries that are read at once
+#define SYSCALL_NAME_LENGTH         24
+#define SYSCALL_TRACE_READ_ENTRIES  16
+
+// The statistics of a SysCall: the histogram counts the calls, and their durations (in nanoseconds) in the Kernel.
+// The same structure is defined in the file "systrace.h" of the Kernel.
+typedef struct SysCallStatistics
+{
+    char Name[SYSCALL_NAME_LENGTH];
+    LatencyHistogram Latency;
+} SysCallStatistics;
+
+// A traced SysCall. An entry with the SysCall number 0 reports in "Result" the number of dropped SysCalls.
+// The same structure is defined in the file "systrace.h" of the Kernel.
+typedef struct SysCallTraceEntry
+{
+    unsigned long Number;
+    unsigned long Arguments[SYSCALL_MAX_ARGUMENTS];
+    unsigned long Result;
+    unsigned long Duration;
+} SysCallTraceEntry;
+
+// Represents a thread, and its Thread Control Block.
+// The FS base of the thread points to the structure, therefore it must stay valid until the thread was joined.
+typedef struct Thread
+{
+    // Points to the structure itself, so that "GetThreadPointer" returns it
+    struct Thread *Self;
+
+    // The function that is executed by the thread, and its argument
+    long (*StartRoutine)(void *Argument);
+    void *Argument;
+
+    // The ID of the thread
+    unsigned long TID;
+} Thread;
+
+// The number of threads that are woken up by "FutexWake" to wake up all waiting threads
+#define FUTEX_WAKE_ALL  0x7FFFFFFF
+
+// The states of a Mutex
+#define MUTEX_UNLOCKED  0
+#define MUTEX_LOCKED    1
+#define MUTEX_CONTENDED 2
+
+// Initializes a statically allocated Mutex or Condition Variable
+#define MUTEX_INITIALIZER               { MUTEX_UNLOCKED }
+#define CONDITION_VARIABLE_INITIALIZER  { 0 }
+
+// Represents a Mutex, which is acquired and released in User Mode as long as it isn't contended.
+// Only a thread that has to wait (or that has to wake up a waiting thread) raises a futex SysCall.
+typedef struct Mutex
+{
+    // MUTEX_UNLOCKED, MUTEX_LOCKED, or MUTEX_CONTENDED when threads are maybe waiting for the Mutex
+    volatile unsigned int State;
+} Mutex;
+
+// Represents a Condition Variable.
+// The sequence number is incremented by every signal, so that a waiting thread doesn't miss a signal that arrives
+// between the release of the Mutex and its futex SysCall.
+typedef struct ConditionVariable
+{
+    volatile unsigned int Sequence;
+} ConditionVariable;
+
+// The number of entries of the Submission Queue, and of the Completion Queue of an I/O Ring
+#define IO_RING_ENTRIES                 32
+#define IO_RING_MASK                    (IO_RING_ENTRIES - 1)
+#define IO_RING_COMPLETION_ENTRIES      64
+#define IO_RING_COMPLETION_MASK         (IO_RING_COMPLETION_ENTRIES - 1)
+
+// The maximum number of arguments of an I/O Ring operation
+#define IO_RING_ARGUMENTS               5
+
+// The operation is linked with the next one: when it fails (result <= 0), the rest of the chain is canceled
+#define IO_RING_LINK                    0x1
+
+// The results of the operations that were not executed (an operation on a pipe handle is invalid, because it can block)
+#define IO_RING_RESULT_INVALID          -1
+#define IO_RING_RESULT_CANCELED         -2
+
+// Represents an operation in the Submission Queue of an I/O Ring (a SysCall number with its arguments).
+// The same structure is defined in the file "ioring.h".
+typedef struct IoRingSubmission
+{
+    int Operation;
+    int Flags;
+    unsigned long Arguments[IO_RING_ARGUMENTS];
+
+    // An opaque value that is returned in the completion of the operation
+    unsigned long UserData;
+} IoRingSubmission;
+
+// Represents a completed operation in the Completion Queue of an I/O Ring.
+// The same structure is defined in the file "ioring.h".
+typedef struct IoRingCompletion
+{
+    unsigned long UserData;
+    long Result;
+} IoRingCompletion;
+
+// The page that is shared between the Kernel and the process.
+// The same structure is defined in the file "ioring.h".
+typedef struct IoRingShared
+{
+    volatile unsigned int SubmissionHead;
+    volatile unsigned int SubmissionTail;
+    volatile unsigned int CompletionHead;
+    volatile unsigned int CompletionTail;
+    IoRingSubmission Submissions[IO_RING_ENTRIES];
+    IoRingCompletion Completions[IO_RING_COMPLETION_ENTRIES];
+} IoRingShared;
+
+// The read-only pages of the vDSO, which the Kernel maps into every process
+#define VDSO_USERMODE_ADDRESS           0x0000500000000000
+#define VDSO_PROCESS_USERMODE_ADDRESS   0x0000500000001000
+
+// The data that the Kernel publishes in the shared page of the vDSO.
+// The wall clock is protected by a sequence lock, which is odd while the Kernel updates the wall clock.
+// The same structure is defined in the file "vdso.h".
+typedef struct VdsoData
+{
+    volatile unsigned int Sequence;
+    int Year;
+    short Month;
+    short Day;
+    short Hour;
+    short Minute;
+    short Second;
+    unsigned long TscBoot;
+    unsigned long TscFrequency;
+} VdsoData;
+
+// The data that the Kernel publishes in the vDSO page of the process.
+// The same structure is defined in the file "vdso.h".
+typedef struct VdsoProcessData
+{
+    unsigned long PID;
+} VdsoProcessData;
+
+// The file handle of the console in the functions "ReadFileVector" and "WriteFileVector"
+#define FILE_HANDLE_CONSOLE             0x8000000000000000
+
+// The maximum number of buffers in the functions "ReadFileVector" and "WriteFileVector".
+// Every buffer can't be longer than a physical disk sector (512 bytes).
+#define IO_VECTOR_MAX                   16
+
+// Describes a buffer of a vectored read or write operation.
+// The same structure is defined in the file "fat12.h" of the Kernel.
+typedef struct IoVector
+{
+    unsigned char *Buffer;
+    unsigned long Length;
+} IoVector;
+
 // Prints out a null-terminated string
 void printf(unsigned char *string);
 
-// Returns the PID of the current executing process
+// Returns the PID of the current executing process (read from the vDSO without a SysCall).
+// All threads of a process return the same PID - their thread IDs are returned by "thread_create".
 long GetPID();
 
+// Returns the number of nanoseconds since the Kernel has started its timer (read from the vDSO without a SysCall)
+unsigned long GetMonotonicTime();
+
+// Returns the current system date and time (read from the vDSO without a SysCall)
+void GetDateTime(int *Year, int *Month, int *Day, int *Hour, int *Minute, int *Second);
+
 // Terminates the current executing process
 void TerminateProcess();
 
-// Returns the entered character
+// Returns the entered character, or the next character of the redirected standard input
 char getchar();
 
 // Reads a string with the given size from the keyboard, and returns it
@@ -25,9 +237,31 @@ void GetCursorPosition(int *Row, int *Col);
 // Sets the current cursor position
 void SetCursorPosition(int *Row, int *Col);
 
-// Executes the given User Mode program
+// Executes the given User Mode program, and returns its PID (0 if the program wasn't started)
 int ExecuteUserModeProgram(unsigned char *FileName);
 
+// Executes the given User Mode program with the given pipe handles as its standard input and output (0 is the console)
+int ExecuteUserModeProgramRedirected(unsigned char *FileName, unsigned long StandardInput, unsigned long StandardOutput);
+
+// Creates an anonymous pipe, and returns the handles of its read end and its write end.
+// The handles are used with "ReadFile", "WriteFile", and "CloseFile", and they are only valid in the current process.
+// The handles that are still open are closed when the process terminates. It returns 0 if no pipe is available anymore.
+int CreatePipe(unsigned long *ReadHandle, unsigned long *WriteHandle);
+
+// Opens the named Shared Memory Segment (up to 15 characters), and returns its handle.
+// The segment is created with the given size (up to 256 KB), if it doesn't exist yet - a size of 0 only opens an
+// existing segment. It returns 0 if the segment couldn't be opened.
+int shm_open(char *Name, unsigned long Size);
+
+// Maps a Shared Memory Segment into the address space of the current process, and returns its address.
+// All processes are accessing the same physical memory, so the data is exchanged without any copies.
+// It returns 0x0 if the handle is invalid.
+void *shm_map(int Handle);
+
+// Unmaps a Shared Memory Segment, and closes its handle. The segment is released by its last process.
+// It returns 0 if the handle is invalid.
+int shm_unmap(int Handle);
+
 // Prints out the root directory of the FAT12 partition
 int PrintRootDirectory();
 
@@ -49,12 +283,122 @@ unsigned long ReadFile(unsigned long FileHandle, unsigned char *Buffer, unsigned
 // Writes the requested data from the provided buffer into a file
 unsigned long WriteFile(unsigned long FileHandle, unsigned char *Buffer, unsigned long Length);
 
+// Reads the requested data from a file (or the console) into several buffers through a single SysCall
+unsigned long ReadFileVector(unsigned long FileHandle, IoVector *Vectors, int Count);
+
+// Writes the requested data from several buffers into a file (or onto the console) through a single SysCall
+unsigned long WriteFileVector(unsigned long FileHandle, IoVector *Vectors, int Count);
+
 // Seeks to the specific position in the file
 int SeekFile(unsigned long FileHandle, unsigned long NewFileOffset);
 
 // Returns a flag if the file offset within the FileDescriptor has reached the end of file
 int EndOfFile(unsigned long FileHandle);
 
+// Blocks the current executing process for the given number of milliseconds
+void Sleep(unsigned long Milliseconds);
+
+// Blocks the current executing process for the given number of nanoseconds
+void NanoSleep(unsigned long Nanoseconds);
+
+// Gives up the CPU, so that the other runnable processes can execute
+void Yield();
+
+// Moves the current Task into the Real-Time scheduling class with the given priority (0 - 15), or back into the normal
+// class with a negative priority. The Task may run for "Runtime" nanoseconds in each period of "Period" nanoseconds
+// (between 100 microseconds and 10 seconds). It returns 0 if the CPU bandwidth couldn't be admitted.
+int SetRealTime(int Priority, unsigned long Runtime, unsigned long Period);
+
+// Creates a new thread in the current process, which executes the given function with the given argument.
+// The thread has its own Stack and Thread Local Storage (the given Thread structure). It returns the thread ID,
+// or 0 if the thread couldn't be created.
+unsigned long thread_create(Thread *Thread, long (*StartRoutine)(void *Argument), void *Argument);
+
+// Terminates the current thread with the given exit code
+void thread_exit(long ExitCode);
+
+// Waits until the thread with the given thread ID has exited, and returns its exit code.
+// It returns 0 if the thread doesn't exist in the current process.
+int thread_join(unsigned long TID, long *ExitCode);
+
+// Sets the Thread Pointer (the FS base) of the current thread
+void SetThreadPointer(void *ThreadPointer);
+
+// Returns the first 8 bytes of the Thread Local Storage of the current thread (the Thread structure for a thread
+// that was created through "thread_create")
+void *GetThreadPointer();
+
+// The entry point of a new thread, which calls its start routine
+static void ThreadEntry(Thread *Thread);
+
+// Blocks the current thread, as long as the futex word contains the expected value.
+// It returns 1 after the thread was woken up, and 0 when the futex word contains another value.
+int FutexWait(volatile unsigned int *Address, unsigned int ExpectedValue);
+
+// Wakes up the given number of threads that are waiting on the futex word, and returns the number of woken up threads
+int FutexWake(volatile unsigned int *Address, int Count);
+
+// Initializes a Mutex
+void InitMutex(Mutex *Mutex);
+
+// Acquires a Mutex. The current thread is blocked while another thread holds the Mutex.
+void AcquireMutex(Mutex *Mutex);
+
+// Tries to acquire a Mutex without blocking. It returns 1 if the Mutex was acquired.
+int TryAcquireMutex(Mutex *Mutex);
+
+// Releases a Mutex
+void ReleaseMutex(Mutex *Mutex);
+
+// Initializes a Condition Variable
+void InitConditionVariable(ConditionVariable *Condition);
+
+// Releases the Mutex, and blocks the current thread until the Condition Variable is signaled.
+// The Mutex is acquired again before the function returns.
+void WaitConditionVariable(ConditionVariable *Condition, Mutex *Mutex);
+
+// Wakes up one thread that waits on the Condition Variable
+void SignalConditionVariable(ConditionVariable *Condition);
+
+// Wakes up all threads that are waiting on the Condition Variable
+void BroadcastConditionVariable(ConditionVariable *Condition);
+
+// Returns a snapshot of the statistics of all Tasks
+int GetTaskStatistics(TaskStatistics *Buffer, int MaxEntries);
+
+// Returns a snapshot of the contention statistics of all Kernel locks
+int GetLockStatistics(LockStatistics *Buffer, int MaxEntries);
+
+// Returns a scheduling latency histogram (LATENCY_RUNQUEUE or LATENCY_WAKEUP) of the given process.
+// The PID 0 returns the system-wide histogram. It returns 0 if the process doesn't exist.
+int GetLatencyHistogram(unsigned long PID, int Kind, LatencyHistogram *Buffer);
+
+// Returns the statistics of the given SysCall number. It returns 0 for an unknown SysCall.
+int GetSysCallStatistics(int Number, SysCallStatistics *Buffer);
+
+// Starts to trace the SysCalls of the process with the given PID. It returns 0 if the process can't be traced.
+int SysCallTraceAttach(unsigned long PID);
+
+// Stops to trace the SysCalls of the process with the given PID
+void SysCallTraceDetach(unsigned long PID);
+
+// Reads the next traced SysCalls of the process with the given PID, and returns their number.
+// It returns -1 if the process isn't traced anymore, or when it has terminated and all of its SysCalls were read.
+int SysCallTraceRead(unsigned long PID, SysCallTraceEntry *Buffer, int MaxEntries);
+
+// Sets up the I/O Ring of the current process, and returns its shared page (0x0 if it couldn't be set up)
+IoRingShared *IoRingSetup();
+
+// Submits the given number of queued operations to the Kernel, and waits until at least "MinComplete" completions
+// are available. It returns the number of submitted operations.
+int IoRingEnter(int ToSubmit, int MinComplete);
+
+// Queues an operation in the Submission Queue. It returns 0 if the Submission Queue is full.
+int IoRingQueueSubmission(IoRingShared *Ring, int Operation, int Flags, unsigned long UserData, unsigned long Argument1, unsigned long Argument2, unsigned long Argument3);
+
+// Takes the next completion from the Completion Queue. It returns 0 if no completion is available.
+int IoRingGetCompletion(IoRingShared *Ring, IoRingCompletion *Completion);
+
 // Prints out an integer value
 void printf_int(int i, int base);
 
@@ -3,23 +3,49 @@
 [GLOBAL SYSCALLASM1]
 [GLOBAL SYSCALLASM2]
 [GLOBAL SYSCALLASM3]
+[GLOBAL SYSCALLASM4]
+[GLOBAL SYSCALLASM5]
+[GLOBAL SYSCALLASM6]
 
-; Raises a SysCall
+; Raises a SysCall.
+; The SysCalls are entered through the SYSCALL instruction, which overwrites the registers RCX and R11.
+; Therefore the 3rd parameter is passed to the Kernel in R10 - the Kernel still accepts the INT 0x80 entry, too.
+; The 6th parameter is passed on the Stack by the C calling convention, and it's passed to the Kernel in RAX.
 SYSCALLASM0:
-    INT     0x80
+    SYSCALL
     RET
 
 ; Raises a SysCall
 SYSCALLASM1:
-    INT     0x80
+    SYSCALL
     RET
 
 ; Raises a SysCall
 SYSCALLASM2:
-    INT     0x80
+    SYSCALL
     RET
 
 ; Raises a SysCall
 SYSCALLASM3:
-    INT     0x80
+    MOV     R10, RCX
+    SYSCALL
+    RET
+
+; Raises a SysCall
+SYSCALLASM4:
+    MOV     R10, RCX
+    SYSCALL
+    RET
+
+; Raises a SysCall
+SYSCALLASM5:
+    MOV     R10, RCX
+    SYSCALL
+    RET
+
+; Raises a SysCall
+SYSCALLASM6:
+    MOV     R10, RCX
+    MOV     RAX, [RSP + 0x8]
+    SYSCALL
     RET
\ No newline at end of file
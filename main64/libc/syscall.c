@@ -22,4 +22,22 @@ long SYSCALL2(int SysCallNumber, void *Parameter1, void *Parameter2)
 long SYSCALL3(int SysCallNumber, void *Parameter1, void *Parameter2, void *Parameter3)
 {
     return SYSCALLASM3(SysCallNumber, Parameter1, Parameter2, Parameter3);
+}
+
+// Raises a Syscall with 4 parameters
+long SYSCALL4(int SysCallNumber, void *Parameter1, void *Parameter2, void *Parameter3, void *Parameter4)
+{
+    return SYSCALLASM4(SysCallNumber, Parameter1, Parameter2, Parameter3, Parameter4);
+}
+
+// Raises a Syscall with 5 parameters
+long SYSCALL5(int SysCallNumber, void *Parameter1, void *Parameter2, void *Parameter3, void *Parameter4, void *Parameter5)
+{
+    return SYSCALLASM5(SysCallNumber, Parameter1, Parameter2, Parameter3, Parameter4, Parameter5);
+}
+
+// Raises a Syscall with 6 parameters
+long SYSCALL6(int SysCallNumber, void *Parameter1, void *Parameter2, void *Parameter3, void *Parameter4, void *Parameter5, void *Parameter6)
+{
+    return SYSCALLASM6(SysCallNumber, Parameter1, Parameter2, Parameter3, Parameter4, Parameter5, Parameter6);
 }
\ No newline at end of file
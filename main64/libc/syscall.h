@@ -1,23 +1,8 @@
 #ifndef SYSCALL_H
 #define SYSCALL_H
 
-// Defines the various available SysCalls
-#define SYSCALL_PRINTF              1
-#define SYSCALL_GETPID              2
-#define SYSCALL_TERMINATE_PROCESS   3
-#define SYSCALL_GETCHAR             4
-#define SYSCALL_GETCURSOR           5
-#define SYSCALL_SETCURSOR           6
-#define SYSCALL_EXECUTE             7
-#define SYSCALL_PRINTROOTDIRECTORY  8
-#define SYSCALL_CLEARSCREEN         9
-#define SYSCALL_OPENFILE            10
-#define SYSCALL_READFILE            11
-#define SYSCALL_WRITEFILE           12
-#define SYSCALL_SEEKFILE            13
-#define SYSCALL_ENDOFFILE           14
-#define SYSCALL_CLOSEFILE           15
-#define SYSCALL_DELETEFILE          16
+// The SysCall numbers are generated from the SysCall table of the Kernel
+#include "../kernel/syscalls/syscalltable.h"
 
 // Raises a SysCall with no parameters
 long SYSCALL0(int SysCallNumber);
@@ -35,4 +20,16 @@ extern long SYSCALLASM2();
 long SYSCALL3(int SysCallNumber, void *Parameter1, void *Parameter2, void *Parameter3);
 extern long SYSCALLASM3();
 
+// Raises a Syscall with 4 parameters
+long SYSCALL4(int SysCallNumber, void *Parameter1, void *Parameter2, void *Parameter3, void *Parameter4);
+extern long SYSCALLASM4();
+
+// Raises a Syscall with 5 parameters
+long SYSCALL5(int SysCallNumber, void *Parameter1, void *Parameter2, void *Parameter3, void *Parameter4, void *Parameter5);
+extern long SYSCALLASM5();
+
+// Raises a Syscall with 6 parameters
+long SYSCALL6(int SysCallNumber, void *Parameter1, void *Parameter2, void *Parameter3, void *Parameter4, void *Parameter5, void *Parameter6);
+extern long SYSCALLASM6();
+
 #endif
\ No newline at end of file
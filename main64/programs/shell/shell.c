@@ -11,7 +11,12 @@ char *commands[] =
     "type",
     "del",
     "open",
-    "copy"
+    "copy",
+    "top",
+    "locks",
+    "latency",
+    "syscalls",
+    "trace"
 };
 
 int (*command_functions[]) (char *param) =
@@ -22,7 +27,20 @@ int (*command_functions[]) (char *param) =
     &shell_type,
     &shell_del,
     &shell_open,
-    &shell_copy
+    &shell_copy,
+    &shell_top,
+    &shell_locks,
+    &shell_latency,
+    &shell_syscalls,
+    &shell_trace
+};
+
+// The names and the argument types of the SysCalls, which are generated from the SysCall table
+#define SYSCALL_INFO(Number, Name, Handler, ArgumentTypes, Flags) [Number] = { #Name, ArgumentTypes },
+
+SysCallInfo sysCallInfos[] =
+{
+    SYSCALL_TABLE(SYSCALL_INFO)
 };
 
 // The main entry point for the User Mode program
@@ -49,8 +67,18 @@ void ShellMain()
 
         if (commandFound == 0)
         {
+            // Find the pipe symbol of a pipeline like "prog2.bin | prog1.bin"
+            for (i = 0; (input[i] != 0) && (input[i] != '|'); i++)
+                ;
+
+            // Execute the requested pipeline of 2 User Mode programs...
+            if (input[i] == '|')
+            {
+                if (ExecutePipeline(input, i) == 0)
+                    printf("The pipeline could not be started.\n\n");
+            }
             // Execute the requested User Mode program...
-            if (ExecuteUserModeProgram(input) == 0)
+            else if (ExecuteUserModeProgram(input) == 0)
             {
                 printf("'");
                 printf(input);
@@ -61,6 +89,50 @@ void ShellMain()
     }
 }
 
+// Executes a pipeline of 2 User Mode programs, like "prog2.bin | prog1.bin".
+// The standard output of the 1st program is written into a pipe, from which the 2nd program reads its standard input.
+// It returns 0 if the pipe couldn't be created, or if one of the programs couldn't be started.
+static int ExecutePipeline(char *Input, int Separator)
+{
+    char *producer = Input;
+    char *consumer = Input + Separator + 1;
+    unsigned long readHandle;
+    unsigned long writeHandle;
+    int result = 1;
+    int i;
+
+    // Split the input into the 2 program names, and remove the spaces around them
+    Input[Separator] = 0;
+
+    for (i = Separator - 1; (i >= 0) && (Input[i] == ' '); i--)
+        Input[i] = 0;
+
+    while (*producer == ' ')
+        producer++;
+
+    while (*consumer == ' ')
+        consumer++;
+
+    for (i = 0; consumer[i] != 0; i++)
+        ;
+
+    for (i = i - 1; (i >= 0) && (consumer[i] == ' '); i--)
+        consumer[i] = 0;
+
+    if (CreatePipe(&readHandle, &writeHandle) == 0)
+        return 0;
+
+    if ((ExecuteUserModeProgramRedirected(producer, 0, writeHandle) == 0) || (ExecuteUserModeProgramRedirected(consumer, readHandle, 0) == 0))
+        result = 0;
+
+    // Both programs are holding their own references to the pipe ends.
+    // The consumer gets the end of the file, as soon as the producer has terminated.
+    CloseFile(readHandle);
+    CloseFile(writeHandle);
+
+    return result;
+}
+
 // Prints out the Root Directory of the FAT12 partition
 int shell_dir(char *param)
 {
@@ -177,11 +249,14 @@ int shell_copy(char *param)
 
     if ((fileHandleSource != 0) && (fileHandleTarget != 0))
     {
-        // Copy the source file to the target file
-        while (!EndOfFile(fileHandleSource))
+        // Copy the source file to the target file - in batches through the I/O Ring, if it's available
+        if (!shell_copy_ioring(fileHandleSource, fileHandleTarget))
         {
-            ReadFile(fileHandleSource, (unsigned char *)&buffer, 512);
-            WriteFile(fileHandleTarget, (unsigned char *)&buffer, 512);
+            while (!EndOfFile(fileHandleSource))
+            {
+                ReadFile(fileHandleSource, (unsigned char *)&buffer, 512);
+                WriteFile(fileHandleTarget, (unsigned char *)&buffer, 512);
+            }
         }
 
         // Close both file handles
@@ -190,4 +265,406 @@ int shell_copy(char *param)
 
         printf("File copied.\n");
     }
+}
+
+// Copies the source file to the target file through the I/O Ring.
+// Every batch is a linked chain of reads and writes, followed by a check for the end of the file. A read at the end of
+// the file cancels the rest of the chain, so that a whole batch needs only 1 SysCall.
+// It returns 0 if the I/O Ring couldn't be set up.
+static int shell_copy_ioring(unsigned long FileHandleSource, unsigned long FileHandleTarget)
+{
+    unsigned char buffers[COPY_BATCH_CHUNKS][512];
+    IoRingShared *ring = IoRingSetup();
+    IoRingCompletion completion;
+    int endOfFile = 0;
+    int count;
+    int i;
+
+    if (ring == 0x0)
+        return 0;
+
+    while (!endOfFile)
+    {
+        count = 0;
+
+        for (i = 0; i < COPY_BATCH_CHUNKS; i++)
+        {
+            count += IoRingQueueSubmission(ring, SYSCALL_READFILE, IO_RING_LINK, i, FileHandleSource, (unsigned long)buffers[i], 512);
+            count += IoRingQueueSubmission(ring, SYSCALL_WRITEFILE, IO_RING_LINK, i, FileHandleTarget, (unsigned long)buffers[i], 512);
+        }
+
+        count += IoRingQueueSubmission(ring, SYSCALL_ENDOFFILE, 0, COPY_BATCH_CHUNKS, FileHandleSource, 0, 0);
+        IoRingEnter(count, count);
+
+        // The batch is finished with the end of the file, or when a part of the chain was canceled
+        for (i = 0; i < count; i++)
+        {
+            while (!IoRingGetCompletion(ring, &completion))
+                ;
+
+            if ((completion.Result == IO_RING_RESULT_CANCELED) || (completion.Result == IO_RING_RESULT_INVALID))
+                endOfFile = 1;
+            else if ((completion.UserData == COPY_BATCH_CHUNKS) && (completion.Result != 0))
+                endOfFile = 1;
+        }
+    }
+
+    return 1;
+}
+
+// Displays the CPU usage and the scheduling statistics of all Tasks
+int shell_top(char *param)
+{
+    TaskStatistics first[MAX_TASK_STATISTICS];
+    TaskStatistics second[MAX_TASK_STATISTICS];
+    unsigned long cpuTime[MAX_TASK_STATISTICS];
+    unsigned long totalCpuTime = 0;
+    char *status[] = { "CREATED", "RUNNABLE", "RUNNING", "WAITING", "TERMINATED" };
+    int firstCount;
+    int secondCount;
+    int i;
+    int j;
+
+    // Take 2 snapshots with 1 second in between, so that we can calculate the CPU usage of each Task
+    firstCount = GetTaskStatistics(first, MAX_TASK_STATISTICS);
+    Sleep(1000);
+    secondCount = GetTaskStatistics(second, MAX_TASK_STATISTICS);
+
+    // Calculate the CPU time that each Task has consumed between both snapshots
+    for (i = 0; i < secondCount; i++)
+    {
+        cpuTime[i] = second[i].UserTime + second[i].KernelTime;
+
+        for (j = 0; j < firstCount; j++)
+        {
+            if (first[j].PID == second[i].PID)
+            {
+                cpuTime[i] -= first[j].UserTime + first[j].KernelTime;
+                break;
+            }
+        }
+
+        totalCpuTime += cpuTime[i];
+    }
+
+    // The Idle Task (PID 0) is also reported, therefore the total CPU time is never 0
+    if (totalCpuTime == 0)
+        totalCpuTime = 1;
+
+    printf("PID  STATUS      CPU%  USER ms  KERN ms  WAIT ms  SWITCHES    VOL  INVOL     PF\n");
+
+    for (i = 0; i < secondCount; i++)
+    {
+        PrintColumn(second[i].PID, 3);
+        printf("  ");
+        PrintTextColumn(second[i].Status <= 4 ? status[second[i].Status] : "UNKNOWN", 10);
+        PrintColumn(cpuTime[i] * 100 / totalCpuTime, 6);
+        PrintColumn(second[i].UserTime / 1000000, 9);
+        PrintColumn(second[i].KernelTime / 1000000, 9);
+        PrintColumn(second[i].WaitTime / 1000000, 9);
+        PrintColumn(second[i].ContextSwitches, 10);
+        PrintColumn(second[i].VoluntaryContextSwitches, 7);
+        PrintColumn(second[i].InvoluntaryContextSwitches, 7);
+        PrintColumn(second[i].PageFaults, 7);
+        printf("\n");
+    }
+
+    printf("\n");
+
+    return 1;
+}
+
+// Displays the contention statistics of the Kernel locks
+int shell_locks(char *param)
+{
+    LockStatistics locks[MAX_LOCK_STATISTICS];
+    int count;
+    int i;
+
+    count = GetLockStatistics(locks, MAX_LOCK_STATISTICS);
+
+    printf("LOCK             ACQUISITIONS  CONTENDED       SPINS  MAX HOLD TSC\n");
+
+    for (i = 0; i < count; i++)
+    {
+        PrintTextColumn(locks[i].Name, 15);
+        PrintColumn(locks[i].Acquisitions, 14);
+        PrintColumn(locks[i].Contentions, 11);
+        PrintColumn(locks[i].Spins, 12);
+        PrintColumn(locks[i].MaxHoldTime, 14);
+        printf("\n");
+    }
+
+    printf("\n");
+
+    return 1;
+}
+
+// Displays the scheduling latency histograms of a Task ("latency <PID>"), or of the whole system ("latency")
+int shell_latency(char *param)
+{
+    LatencyHistogram histogram;
+    unsigned long pid = 0;
+
+    // Skip the command name
+    param += 7;
+
+    while (*param == ' ')
+        param++;
+
+    if (*param != 0)
+        pid = ParseNumber(param);
+
+    if (GetLatencyHistogram(pid, LATENCY_RUNQUEUE, &histogram) == 0)
+    {
+        printf("The Task was not found.\n\n");
+        return 1;
+    }
+
+    PrintLatencyHistogram("Run queue latency (queued until dispatched)", &histogram);
+
+    GetLatencyHistogram(pid, LATENCY_WAKEUP, &histogram);
+    PrintLatencyHistogram("Wakeup latency (woken up until dispatched)", &histogram);
+
+    return 1;
+}
+
+// Displays how often each SysCall was called, and how long it took in the Kernel
+int shell_syscalls(char *param)
+{
+    SysCallStatistics statistics;
+    LatencyHistogram *latency = &statistics.Latency;
+    int i;
+
+    printf("SYSCALL                     CALLS     AVG ns     MAX ns\n");
+
+    // Only the SysCalls that were called at least once are printed out
+    for (i = 1; i < MAX_SYSCALL_STATISTICS; i++)
+    {
+        if ((GetSysCallStatistics(i, &statistics) == 0) || (latency->Count == 0))
+            continue;
+
+        PrintTextColumn(statistics.Name, 21);
+        PrintColumn(latency->Count, 12);
+        PrintColumn(latency->Total / latency->Count, 11);
+        PrintColumn(latency->Max, 11);
+        printf("\n");
+    }
+
+    printf("\n");
+
+    return 1;
+}
+
+// Streams the SysCalls of a process ("trace <PID>"), until the process terminates or TRACE_SECONDS have passed
+int shell_trace(char *param)
+{
+    SysCallTraceEntry entries[SYSCALL_TRACE_READ_ENTRIES];
+    unsigned long pid;
+    unsigned long end;
+    int count;
+    int i;
+
+    // Skip the command name
+    param += 5;
+
+    while (*param == ' ')
+        param++;
+
+    pid = ParseNumber(param);
+
+    if (SysCallTraceAttach(pid) == 0)
+    {
+        printf("The process can't be traced.\n\n");
+        return 1;
+    }
+
+    // The time is read from the vDSO, so the polling loop doesn't need an additional SysCall
+    end = GetMonotonicTime() + (unsigned long)TRACE_SECONDS * 1000000000;
+
+    while (GetMonotonicTime() < end)
+    {
+        count = SysCallTraceRead(pid, entries, SYSCALL_TRACE_READ_ENTRIES);
+
+        // The process has terminated
+        if (count < 0)
+            break;
+
+        for (i = 0; i < count; i++)
+            PrintTraceEntry(&entries[i]);
+
+        if (count == 0)
+            Sleep(TRACE_POLL_MILLISECONDS);
+    }
+
+    SysCallTraceDetach(pid);
+    printf("\n");
+
+    return 1;
+}
+
+// Prints out a traced SysCall, like "READFILE(2, 0x7FFFEFFFFD00, 512) = 512 [1200 ns]".
+// The line is written through a single vectored SysCall, so that the output of the traced process can't interleave it.
+static void PrintTraceEntry(SysCallTraceEntry *Entry)
+{
+    IoVector vectors[IO_VECTOR_MAX];
+    char number[32] = "";
+    char arguments[SYSCALL_MAX_ARGUMENTS * 24] = "";
+    char result[32] = "";
+    char duration[32] = "";
+    char *types = "";
+    int length = 0;
+    int count = 0;
+    int i;
+
+    ltoa(Entry->Result, 10, result);
+
+    // The Kernel reports the SysCalls that were dropped, because the tracer was too slow
+    if (Entry->Number == 0)
+    {
+        count = AddTextVector(vectors, count, "... ");
+        count = AddTextVector(vectors, count, result);
+        count = AddTextVector(vectors, count, " SysCalls dropped\n");
+        WriteFileVector(FILE_HANDLE_CONSOLE, vectors, count);
+        return;
+    }
+
+    if ((Entry->Number < sizeof(sysCallInfos) / sizeof(SysCallInfo)) && (sysCallInfos[Entry->Number].Name != 0x0))
+    {
+        count = AddTextVector(vectors, count, sysCallInfos[Entry->Number].Name);
+        types = sysCallInfos[Entry->Number].ArgumentTypes;
+    }
+    else
+    {
+        ltoa(Entry->Number, 10, number);
+        count = AddTextVector(vectors, count, "SYSCALL_");
+        count = AddTextVector(vectors, count, number);
+    }
+
+    // Pointers and strings are printed out as addresses, because they point into the address space of the traced process
+    for (i = 0; (i < SYSCALL_MAX_ARGUMENTS) && (types[i] != 0); i++)
+    {
+        if (i > 0)
+        {
+            arguments[length++] = ',';
+            arguments[length++] = ' ';
+        }
+
+        if (types[i] == 'i')
+            ltoa(Entry->Arguments[i], 10, arguments + length);
+        else
+        {
+            arguments[length++] = '0';
+            arguments[length++] = 'x';
+            ltoa(Entry->Arguments[i], 16, arguments + length);
+        }
+
+        while (arguments[length] != 0)
+            length++;
+    }
+
+    ltoa(Entry->Duration, 10, duration);
+    count = AddTextVector(vectors, count, "(");
+    count = AddTextVector(vectors, count, arguments);
+    count = AddTextVector(vectors, count, ") = ");
+    count = AddTextVector(vectors, count, result);
+    count = AddTextVector(vectors, count, " [");
+    count = AddTextVector(vectors, count, duration);
+    count = AddTextVector(vectors, count, " ns]\n");
+    WriteFileVector(FILE_HANDLE_CONSOLE, vectors, count);
+}
+
+// Appends a null-terminated text (without its null terminator) to the given buffers, and returns the new number of buffers
+static int AddTextVector(IoVector *Vectors, int Count, char *Text)
+{
+    unsigned long length = 0;
+
+    while (Text[length] != 0)
+        length++;
+
+    Vectors[Count].Buffer = (unsigned char *)Text;
+    Vectors[Count].Length = length;
+
+    return Count + 1;
+}
+
+// Prints out a latency histogram with its title
+static void PrintLatencyHistogram(char *Title, LatencyHistogram *Histogram)
+{
+    int i;
+
+    printf(Title);
+    printf(": ");
+    printf_long(Histogram->Count, 10);
+    printf(" samples, avg ");
+    printf_long(Histogram->Count > 0 ? Histogram->Total / Histogram->Count : 0, 10);
+    printf(" ns, max ");
+    printf_long(Histogram->Max, 10);
+    printf(" ns\n");
+    printf("     FROM ns        TO ns      COUNT\n");
+
+    // Only the buckets with recorded latencies are printed out
+    for (i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        if (Histogram->Buckets[i] == 0)
+            continue;
+
+        PrintColumn(i == 0 ? 0 : 1UL << i, 12);
+        PrintColumn((1UL << (i + 1)) - 1, 13);
+        PrintColumn(Histogram->Buckets[i], 11);
+        printf("\n");
+    }
+
+    printf("\n");
+}
+
+// Converts the decimal number at the beginning of the given text
+static unsigned long ParseNumber(char *Text)
+{
+    unsigned long value = 0;
+
+    while ((*Text >= '0') && (*Text <= '9'))
+    {
+        value = value * 10 + (*Text - '0');
+        Text++;
+    }
+
+    return value;
+}
+
+// Prints out a value right-aligned in a column of the given width
+static void PrintColumn(unsigned long Value, int Width)
+{
+    char str[32] = "";
+    int length = 0;
+
+    ltoa(Value, 10, str);
+
+    while (str[length] != 0)
+        length++;
+
+    while (length < Width)
+    {
+        printf(" ");
+        length++;
+    }
+
+    printf(str);
+}
+
+// Prints out a text left-aligned in a column of the given width
+static void PrintTextColumn(char *Text, int Width)
+{
+    int length = 0;
+
+    printf(Text);
+
+    while (Text[length] != 0)
+        length++;
+
+    while (length < Width)
+    {
+        printf(" ");
+        length++;
+    }
 }
\ No newline at end of file
@@ -2,7 +2,23 @@
 #define PROGRAM_H
 
 // The number of available commands
-#define COMMAND_COUNT 7
+#define COMMAND_COUNT 12
+
+// The maximum number of Tasks displayed by the "top" command
+#define MAX_TASK_STATISTICS 32
+
+// The maximum number of locks displayed by the "locks" command
+#define MAX_LOCK_STATISTICS 32
+
+// The highest SysCall number + 1, for which the "syscalls" command displays the statistics
+#define MAX_SYSCALL_STATISTICS 64
+
+// The "trace" command streams the SysCalls of a process at most for this time, and polls every 100 ms for new ones
+#define TRACE_SECONDS 10
+#define TRACE_POLL_MILLISECONDS 100
+
+// The number of 512 byte chunks that the "copy" command submits in one batch to the I/O Ring
+#define COPY_BATCH_CHUNKS 4
 
 // The main entry point for the User Mode program.
 void ShellMain();
@@ -14,5 +30,41 @@ int shell_type(char *param);
 int shell_del(char *param);
 int shell_open(char *param);
 int shell_copy(char *param);
+int shell_top(char *param);
+int shell_locks(char *param);
+int shell_latency(char *param);
+int shell_syscalls(char *param);
+int shell_trace(char *param);
+
+// The name and the argument types of a SysCall, as they are printed out by the "trace" command
+typedef struct SysCallInfo
+{
+    char *Name;
+    char *ArgumentTypes;
+} SysCallInfo;
+
+// Executes a pipeline of 2 User Mode programs, like "prog2.bin | prog1.bin"
+static int ExecutePipeline(char *Input, int Separator);
+
+// Prints out a traced SysCall
+static void PrintTraceEntry(SysCallTraceEntry *Entry);
+
+// Appends a null-terminated text to the given buffers of a vectored SysCall, and returns the new number of buffers
+static int AddTextVector(IoVector *Vectors, int Count, char *Text);
+
+// Copies the source file to the target file through the I/O Ring. It returns 0 if the I/O Ring couldn't be set up.
+static int shell_copy_ioring(unsigned long FileHandleSource, unsigned long FileHandleTarget);
+
+// Prints out a latency histogram with its title
+static void PrintLatencyHistogram(char *Title, LatencyHistogram *Histogram);
+
+// Converts the decimal number at the beginning of the given text
+static unsigned long ParseNumber(char *Text);
+
+// Prints out a value right-aligned in a column of the given width
+static void PrintColumn(unsigned long Value, int Width);
+
+// Prints out a text left-aligned in a column of the given width
+static void PrintTextColumn(char *Text, int Width);
 
 #endif
\ No newline at end of file